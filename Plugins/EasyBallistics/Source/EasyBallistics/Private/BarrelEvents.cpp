@@ -1,6 +1,7 @@
 // Copyright 2016 Mookie. All Rights Reserved.
 
 #include "EBBarrel.h"
+#include "EBStats.h"
 #include "Net/UnrealNetwork.h"
 
 #define REPOWNERONLY false
@@ -14,9 +15,14 @@ void UEBBarrel::Shoot(bool Trigger) {
 	if (ClientSideAim && GetOwner()->GetRemoteRole() == ROLE_Authority && Trigger) {
 		Aim = GetComponentTransform().GetUnitAxis(EAxis::X);
 		Location = GetComponentTransform().GetLocation();
+		INC_DWORD_STAT(STAT_EBRPCsSent);
 		ShootRepCSA(Trigger, UGameplayStatics::RebaseLocalOriginOntoZero(GetWorld(), Location), Aim);
 	}
 	else {
+		//on the server this is a local call
+		if (GetOwner()->GetRemoteRole() == ROLE_Authority) {
+			INC_DWORD_STAT(STAT_EBRPCsSent);
+		}
 		ShootRep(Trigger);
 	}
 }
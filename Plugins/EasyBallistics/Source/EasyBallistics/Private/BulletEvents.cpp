@@ -8,7 +8,7 @@ void AEBBullet::VelocityChangeBroadcast_Implementation(FVector_NetQuantize NewLo
 	if (!HasAuthority()) {
 		FVector RebasedLocation = UGameplayStatics::RebaseZeroOriginOntoLocal(GetWorld(), NewLocation);
 		OnTrajectoryUpdateReceived(RebasedLocation, Velocity, NewVelocity);
-		SetActorLocation(RebasedLocation);
+		SetSimLocation(RebasedLocation);
 		Velocity = NewVelocity;
 		CanRetrace = false;
 	}
@@ -18,7 +18,7 @@ void AEBBullet::VelocityChangeBroadcastReliable_Implementation(FVector_NetQuanti
 	if (!HasAuthority()) {
 		FVector RebasedLocation = UGameplayStatics::RebaseZeroOriginOntoLocal(GetWorld(), NewLocation);
 		OnTrajectoryUpdateReceived(RebasedLocation, Velocity, NewVelocity);
-		SetActorLocation(RebasedLocation);
+		SetSimLocation(RebasedLocation);
 		Velocity = NewVelocity;
 		CanRetrace = false;
 	}
@@ -1,5 +1,6 @@
 // Copyright 2018 Mookie. All Rights Reserved.
 #include "EBBarrel.h"
+#include "EBStats.h"
 
 UEBBarrel::UEBBarrel() {
 	PrimaryComponentTick.bCanEverTick = true;
@@ -14,6 +15,9 @@ UEBBarrel::UEBBarrel() {
 
 void UEBBarrel::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
+	SCOPE_CYCLE_COUNTER(STAT_EBBarrelTick);
+	TRACE_CPUPROFILER_EVENT_SCOPE(UEBBarrel::TickComponent);
+
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
 	if (ClientSideAim){
@@ -23,6 +27,7 @@ void UEBBarrel::TickComponent(float DeltaTime, ELevelTick TickType, FActorCompon
 			if (TimeSinceAimUpdate >= 1.0f / ClientAimUpdateFrequency) {
 				Aim = GetComponentTransform().GetUnitAxis(EAxis::X);
 				Location = GetComponentTransform().GetLocation();
+				INC_DWORD_STAT(STAT_EBRPCsSent);
 				ClientAim(UGameplayStatics::RebaseLocalOriginOntoZero(GetWorld(),Location), Aim);
 				TimeSinceAimUpdate = FMath::Fmod(TimeSinceAimUpdate, 1.0f / ClientAimUpdateFrequency);
 			};
@@ -218,6 +223,7 @@ void UEBBarrel::SpawnBullet(AActor* Owner, FVector InLocation, FVector InAim) {
 		}
 
 		if (ReplicateShotFiredEvents) {
+			INC_DWORD_STAT(STAT_EBRPCsSent);
 			ShotFiredMulticast();
 		}
 		else {
@@ -1,5 +1,7 @@
 // Copyright 2018 Mookie. All Rights Reserved.
 #include "EBBullet.h"
+#include "EBStats.h"
+#include "EBTracerRenderer.h"
 
 // Sets default values
 AEBBullet::AEBBullet() {
@@ -8,10 +10,26 @@ AEBBullet::AEBBullet() {
 	SetTickGroup(ETickingGroup::TG_PrePhysics);
 }
 
+void AEBBullet::PostInitializeComponents() {
+	Super::PostInitializeComponents();
+
+	//replicated, level placed and plain SpawnActor bullets start where the actor is, pooled bullets set it on reactivation
+	SimLocation = GetActorLocation();
+}
+
 // Called when the game starts or when spawned
 void AEBBullet::BeginPlay() {
 	SetActorEnableCollision(AllowComponentCollisions);
 
+	if (!IsLive) {
+		IsLive = true;
+		INC_DWORD_STAT(STAT_EBLiveBullets);
+
+		if (InstancedTracer) {
+			AEBTracerRenderer::Register(this);
+		}
+	}
+
 	if(!IsRecycled){
 		Super::BeginPlay();
 		IsRecycled = true;
@@ -58,8 +76,20 @@ void AEBBullet::Tick(float DeltaTime) {
 	}
 }
 
+void AEBBullet::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	if (IsLive) {
+		IsLive = false;
+		DEC_DWORD_STAT(STAT_EBLiveBullets);
+		AEBTracerRenderer::Unregister(this);
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
 void AEBBullet::Step(float DeltaTime) {
-	FVector start = GetActorLocation();
+	SCOPE_CYCLE_COUNTER(STAT_EBBulletStep);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AEBBullet::Step);
+
+	FVector start = SimLocation;
 	bool sendUpdate = false;
 
 	if (Retrace && CanRetrace) {
@@ -67,18 +97,18 @@ void AEBBullet::Step(float DeltaTime) {
 		float remainingTime = LastTraceDelta;
 		int remainingSteps = MaxTracesPerStep;
 		FVector PreviousVelocity = LastTracePrevVelocity;
-		SetActorLocation(LastTraceStart);
+		SetSimLocation(LastTraceStart);
 		Velocity = LastTraceVelocity;
 
 		do {
 			if (RetraceOnAnotherChannel) {
-				remainingTime = Trace(GetActorLocation(),
+				remainingTime = Trace(SimLocation,
 					PreviousVelocity,
 					remainingTime,
 					RetraceChannel);
 			}
 			else {
-				remainingTime = Trace(GetActorLocation(),
+				remainingTime = Trace(SimLocation,
 					PreviousVelocity,
 					remainingTime,
 					TraceChannel);
@@ -91,13 +121,17 @@ void AEBBullet::Step(float DeltaTime) {
 	CanRetrace = false;
 
 	FVector PreviousVelocity = Velocity;
-	Velocity = UpdateVelocity(GetWorld(), GetActorLocation(), Velocity, DeltaTime);
+	{
+		SCOPE_CYCLE_COUNTER(STAT_EBBulletUpdateVelocity);
+		TRACE_CPUPROFILER_EVENT_SCOPE(AEBBullet::UpdateVelocity);
+		Velocity = UpdateVelocity(GetWorld(), SimLocation, Velocity, DeltaTime);
+	}
 
 	//trace
 	float remainingTime = DeltaTime;
 	int remainingSteps = MaxTracesPerStep;
 	do {
-		remainingTime = Trace(GetActorLocation(), 
+		remainingTime = Trace(SimLocation, 
 			PreviousVelocity, 
 			remainingTime,
 			TraceChannel
@@ -107,12 +141,13 @@ void AEBBullet::Step(float DeltaTime) {
 		if (remainingTime > 0.0f) { sendUpdate = true; };
 	} while (remainingTime > 0.0f && remainingSteps > 0);
 
-	if (sendUpdate) {
+	if (sendUpdate && GetIsReplicated()) {
+		INC_DWORD_STAT(STAT_EBRPCsSent);
 		if (ReliableReplication) {
-			VelocityChangeBroadcastReliable(UGameplayStatics::RebaseLocalOriginOntoZero(GetWorld(),GetActorLocation()), Velocity);
+			VelocityChangeBroadcastReliable(UGameplayStatics::RebaseLocalOriginOntoZero(GetWorld(),SimLocation), Velocity);
 		}
 		else {
-			VelocityChangeBroadcast(UGameplayStatics::RebaseLocalOriginOntoZero(GetWorld(), GetActorLocation()), Velocity);
+			VelocityChangeBroadcast(UGameplayStatics::RebaseLocalOriginOntoZero(GetWorld(), SimLocation), Velocity);
 		}
 	}
 
@@ -123,7 +158,7 @@ void AEBBullet::Step(float DeltaTime) {
 		SafeDelay -= DeltaTime;
 	}
 
-	if (RotateActor) {
+	if (RotateActor && !InstancedTracer) {
 		FRotator NewRot = UKismetMathLibrary::MakeRotFromX(Velocity);
 		NewRot.Roll = GetActorRotation().Roll;
 		SetActorRotation(NewRot);
@@ -138,4 +173,14 @@ inline float AEBBullet::GetCurveValue(const UCurveFloat* curve, float in, float
 void AEBBullet::ApplyWorldOffset(const FVector& InOffset, bool bWorldShift) {
 	Super::ApplyWorldOffset(InOffset, bWorldShift);
 	LastTraceStart += InOffset;
+	SimLocation += InOffset;
+}
+
+void AEBBullet::SetSimLocation(const FVector& NewLocation) {
+	SimLocation = NewLocation;
+
+	//instanced tracers are drawn from SimLocation, moving the actor would only cost component updates
+	if (!InstancedTracer) {
+		SetActorLocation(NewLocation);
+	}
 }
\ No newline at end of file
@@ -0,0 +1,183 @@
+// Copyright 2020 Mookie. All Rights Reserved.
+
+#include "EBReplayCommandlet.h"
+#include "EBBullet.h"
+#include "EBShotRecorder.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Misc/Parse.h"
+#include "UObject/Package.h"
+
+UEBReplayCommandlet::UEBReplayCommandlet() {
+	IsClient = false;
+	IsServer = true;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UEBReplayCommandlet::Main(const FString& Params) {
+	FString LogFile;
+	FString MapName;
+	float Step = 1.0f / 60.0f;
+	float Tail = 10.0f;
+	float Tolerance = 1.0f;
+
+	if (!FParse::Value(*Params, TEXT("Log="), LogFile) || !FParse::Value(*Params, TEXT("Map="), MapName)) {
+		UE_LOG(LogTemp, Error, TEXT("Usage: -run=EBReplay -Log=<file> -Map=<map> [-Step=0.0166] [-Tail=10] [-Tolerance=1]"));
+		return 1;
+	}
+	FParse::Value(*Params, TEXT("Step="), Step);
+	FParse::Value(*Params, TEXT("Tail="), Tail);
+	FParse::Value(*Params, TEXT("Tolerance="), Tolerance);
+	Step = FMath::Max(Step, 0.001f);
+
+	FEBShotLog Log;
+	if (!Log.Load(LogFile)) {
+		return 1;
+	}
+	if (Log.Shots.Num() == 0) {
+		UE_LOG(LogTemp, Display, TEXT("Shot log is empty, nothing to replay"));
+		return 0;
+	}
+
+	TArray<UClass*> Classes;
+	TArray<bool> FrameDependent;
+	for (const FString& ClassPath : Log.Classes) {
+		UClass* BulletClass = LoadObject<UClass>(nullptr, *ClassPath);
+		if (BulletClass == nullptr || !BulletClass->IsChildOf(AEBBullet::StaticClass())) {
+			UE_LOG(LogTemp, Warning, TEXT("Cannot load bullet class %s, its shots will be skipped"), *ClassPath);
+			BulletClass = nullptr;
+		}
+
+		//frame deltas are not recorded, without FixedStep the trajectory depends on them and can't be reproduced
+		bool bFrameDependent = BulletClass && !BulletClass->GetDefaultObject<AEBBullet>()->FixedStep;
+		if (bFrameDependent) {
+			UE_LOG(LogTemp, Warning, TEXT("Bullet class %s does not use FixedStep, its shots are simulated with -Step instead of the recorded frame times and their divergence does not fail the replay"), *ClassPath);
+		}
+		Classes.Add(BulletClass);
+		FrameDependent.Add(bFrameDependent);
+	}
+
+	//load map
+	UPackage* Package = LoadPackage(nullptr, *MapName, LOAD_None);
+	UWorld* World = Package ? UWorld::FindWorldInPackage(Package) : nullptr;
+	if (World == nullptr) {
+		UE_LOG(LogTemp, Error, TEXT("Cannot load map %s"), *MapName);
+		return 1;
+	}
+
+	World->AddToRoot();
+	World->WorldType = EWorldType::Game;
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	if (!World->bIsWorldInitialized) {
+		World->InitWorld(UWorld::InitializationValues().AllowAudioPlayback(false).CreatePhysicsScene(true).ShouldSimulatePhysics(true));
+	}
+	World->UpdateWorldComponents(true, false);
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+
+	TArray<FEBImpactRecord> Replayed;
+	FEBShotRecorder::Get().SetImpactCapture(&Replayed);
+
+	Log.Shots.StableSort([](const FEBShotRecord& A, const FEBShotRecord& B) { return A.Timestamp < B.Timestamp; });
+	const double StartTime = Log.Shots[0].Timestamp;
+	const double EndTime = Log.Shots.Last().Timestamp - StartTime + Tail;
+
+	int32 EnvironmentMismatches = 0;
+	int32 NextShot = 0;
+	double Time = 0.0;
+
+	while (Time <= EndTime) {
+		//fire everything due this frame
+		while (NextShot < Log.Shots.Num() && Log.Shots[NextShot].Timestamp - StartTime <= Time) {
+			const FEBShotRecord& Shot = Log.Shots[NextShot++];
+			UClass* BulletClass = Classes.IsValidIndex(Shot.ClassIndex) ? Classes[Shot.ClassIndex] : nullptr;
+			if (BulletClass == nullptr) continue;
+
+			AEBBullet* Default = Cast<AEBBullet>(BulletClass->GetDefaultObject());
+			FVector Location = UGameplayStatics::RebaseZeroOriginOntoLocal(World, Shot.Location);
+
+			//environment should match, otherwise trajectories diverge regardless of simulation
+			FVector Wind = Default->GetWind(World, Location);
+			float AirDensity = Default->GetAirDensity(World, Location);
+			if (!Wind.Equals(Shot.Wind, 0.01f) || !FMath::IsNearlyEqual(AirDensity, Shot.AirDensity, 0.0001f)) {
+				EnvironmentMismatches++;
+				UE_LOG(LogTemp, Display, TEXT("Shot %u environment differs - wind %s vs %s, air density %f vs %f"),
+					Shot.ShotId, *Wind.ToString(), *Shot.Wind.ToString(), AirDensity, Shot.AirDensity);
+			}
+
+			FTransform Transform(Shot.Rotation, Location, Default->GetActorScale());
+			AEBBullet* Bullet = World->SpawnActorDeferred<AEBBullet>(BulletClass, Transform);
+			if (Bullet == nullptr) continue;
+			Bullet->RandomStream.Initialize(Shot.Seed);
+			Bullet->Velocity = Shot.Velocity;
+			Bullet->Mass = Shot.Mass;
+			Bullet->SimLocation = Location;
+			Bullet->RecordedShotId = Shot.ShotId;
+			Bullet->EnablePooling = false;
+			UGameplayStatics::FinishSpawningActor(Bullet, Transform);
+		}
+
+		World->Tick(LEVELTICK_All, Step);
+		Time += Step;
+	}
+
+	FEBShotRecorder::Get().SetImpactCapture(nullptr);
+
+	//diff per shot, impacts of a shot are in chronological order in both
+	TMap<uint32, TArray<const FEBImpactRecord*>> Expected;
+	TMap<uint32, TArray<const FEBImpactRecord*>> Actual;
+	for (const FEBImpactRecord& Impact : Log.Impacts) {
+		Expected.FindOrAdd(Impact.ShotId).Add(&Impact);
+	}
+	for (const FEBImpactRecord& Impact : Replayed) {
+		Actual.FindOrAdd(Impact.ShotId).Add(&Impact);
+	}
+
+	int32 Diverged = 0;
+	int32 FrameDependentDiverged = 0;
+	for (const FEBShotRecord& Shot : Log.Shots) {
+		const TArray<const FEBImpactRecord*>* ExpectedImpacts = Expected.Find(Shot.ShotId);
+		const TArray<const FEBImpactRecord*>* ActualImpacts = Actual.Find(Shot.ShotId);
+		int32 ExpectedNum = ExpectedImpacts ? ExpectedImpacts->Num() : 0;
+		int32 ActualNum = ActualImpacts ? ActualImpacts->Num() : 0;
+		bool bShotDiverged = false;
+
+		if (ExpectedNum != ActualNum) {
+			bShotDiverged = true;
+			UE_LOG(LogTemp, Display, TEXT("Shot %u: %d impacts recorded, %d replayed"), Shot.ShotId, ExpectedNum, ActualNum);
+		}
+		else {
+			for (int32 i = 0; i < ExpectedNum; i++) {
+				const FEBImpactRecord* A = (*ExpectedImpacts)[i];
+				const FEBImpactRecord* B = (*ActualImpacts)[i];
+				float Distance = FVector::Dist(A->Location, B->Location);
+				if (Distance > Tolerance || A->Flags != B->Flags) {
+					bShotDiverged = true;
+					UE_LOG(LogTemp, Display, TEXT("Shot %u impact %d: recorded %s flags %d, replayed %s flags %d, off by %f"),
+						Shot.ShotId, i, *A->Location.ToString(), A->Flags, *B->Location.ToString(), B->Flags, Distance);
+					break;
+				}
+			}
+		}
+
+		if (bShotDiverged) {
+			if (FrameDependent.IsValidIndex(Shot.ClassIndex) && FrameDependent[Shot.ClassIndex]) {
+				FrameDependentDiverged++;
+			}
+			else {
+				Diverged++;
+			}
+		}
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Replayed %d shots, %d recorded impacts, %d replayed impacts, %d shots diverged, %d shots without FixedStep diverged, %d environment mismatches"),
+		Log.Shots.Num(), Log.Impacts.Num(), Replayed.Num(), Diverged, FrameDependentDiverged, EnvironmentMismatches);
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	World->RemoveFromRoot();
+
+	return Diverged > 0 ? 1 : 0;
+}
@@ -0,0 +1,268 @@
+// Copyright 2020 Mookie. All Rights Reserved.
+
+#include "EBShotRecorder.h"
+#include "EBBullet.h"
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+
+//entries queued before a background flush is kicked
+#define EB_RECORDER_FLUSH_THRESHOLD 256
+
+FArchive& operator<<(FArchive& Ar, FEBShotRecord& Record) {
+	Ar << Record.ShotId;
+	Ar << Record.ClassIndex;
+	Ar << Record.Timestamp;
+	Ar << Record.Location;
+	Ar << Record.Rotation;
+	Ar << Record.Velocity;
+	Ar << Record.Seed;
+	Ar << Record.Mass;
+	Ar << Record.Wind;
+	Ar << Record.AirDensity;
+	Ar << Record.SpeedOfSound;
+	return Ar;
+}
+
+FArchive& operator<<(FArchive& Ar, FEBImpactRecord& Record) {
+	Ar << Record.ShotId;
+	Ar << Record.Flags;
+	Ar << Record.Timestamp;
+	Ar << Record.Location;
+	Ar << Record.IncomingVelocity;
+	Ar << Record.ExitVelocity;
+	return Ar;
+}
+
+bool FEBShotLog::Load(const FString& FileName) {
+	TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*FileName));
+	if (!Reader) {
+		UE_LOG(LogTemp, Warning, TEXT("Cannot open shot log %s"), *FileName);
+		return false;
+	}
+
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	*Reader << Magic;
+	*Reader << Version;
+	if (Magic != FEBShotRecorder::FileMagic || Version != FEBShotRecorder::FileVersion) {
+		UE_LOG(LogTemp, Warning, TEXT("%s is not a shot log or has wrong version"), *FileName);
+		return false;
+	}
+
+	while (!Reader->AtEnd() && !Reader->IsError()) {
+		uint8 Type;
+		*Reader << Type;
+
+		switch ((FEBShotRecorder::EEntryType)Type) {
+		case FEBShotRecorder::EEntryType::Class: {
+			FString ClassPath;
+			*Reader << ClassPath;
+			Classes.Add(ClassPath);
+			break;
+		}
+		case FEBShotRecorder::EEntryType::Shot: {
+			*Reader << Shots.AddDefaulted_GetRef();
+			break;
+		}
+		case FEBShotRecorder::EEntryType::Impact: {
+			*Reader << Impacts.AddDefaulted_GetRef();
+			break;
+		}
+		default:
+			UE_LOG(LogTemp, Warning, TEXT("Corrupt shot log %s"), *FileName);
+			return false;
+		}
+	}
+
+	return !Reader->IsError();
+}
+
+FEBShotRecorder& FEBShotRecorder::Get() {
+	static FEBShotRecorder Recorder;
+	return Recorder;
+}
+
+bool FEBShotRecorder::Start(const FString& FileName) {
+	check(IsInGameThread());
+	if (IsRecording()) {
+		return true;
+	}
+
+	FString Path = FileName;
+	if (Path.IsEmpty()) {
+		Path = FPaths::ProjectSavedDir() / TEXT("Ballistics") / FString::Printf(TEXT("Shots_%s.ebrec"), *FDateTime::Now().ToString());
+	}
+
+	Writer.Reset(IFileManager::Get().CreateFileWriter(*Path));
+	if (!Writer) {
+		UE_LOG(LogTemp, Warning, TEXT("Cannot start shot recording, failed to open %s"), *Path);
+		return false;
+	}
+
+	uint32 Magic = FileMagic;
+	uint32 Version = FileVersion;
+	*Writer << Magic;
+	*Writer << Version;
+
+	ClassIndices.Reset();
+	TickHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FEBShotRecorder::Tick), 1.0f);
+	Recording.store(true);
+
+	UE_LOG(LogTemp, Display, TEXT("Recording shots to %s"), *Path);
+	return true;
+}
+
+void FEBShotRecorder::Stop() {
+	check(IsInGameThread());
+	if (!IsRecording()) {
+		return;
+	}
+	Recording.store(false);
+	FTSTicker::GetCoreTicker().RemoveTicker(TickHandle);
+
+	//let the last background flush finish, then drain the rest here
+	if (FlushTask.IsValid()) {
+		FlushTask.Wait();
+	}
+	FlushInFlight.store(true);
+	Flush();
+	FlushInFlight.store(false);
+
+	Writer->Close();
+	Writer.Reset();
+}
+
+uint32 FEBShotRecorder::RecordShot(const AEBBullet* Bullet, const FTransform& Muzzle, const FVector& Velocity) {
+	if (!IsRecording() || Bullet == nullptr) {
+		return 0;
+	}
+
+	const UClass* BulletClass = Bullet->GetClass();
+	uint16* Found = ClassIndices.Find(BulletClass);
+	uint16 ClassIndex;
+	if (Found) {
+		ClassIndex = *Found;
+	}
+	else {
+		ClassIndex = ClassIndices.Add(BulletClass, ClassIndices.Num());
+
+		FEntry ClassEntry;
+		ClassEntry.Type = EEntryType::Class;
+		ClassEntry.ClassPath = BulletClass->GetPathName();
+		Enqueue(MoveTemp(ClassEntry));
+	}
+
+	UWorld* World = Bullet->GetWorld();
+	FVector Location = UGameplayStatics::RebaseLocalOriginOntoZero(World, Muzzle.GetLocation());
+
+	FEntry Entry;
+	Entry.Type = EEntryType::Shot;
+	FEBShotRecord& Shot = Entry.Shot;
+	Shot.ShotId = NextShotId.fetch_add(1);
+	Shot.ClassIndex = ClassIndex;
+	Shot.Timestamp = World->GetTimeSeconds();
+	Shot.Location = Location;
+	Shot.Rotation = Muzzle.GetRotation();
+	Shot.Velocity = Velocity;
+	Shot.Seed = Bullet->RandomStream.GetCurrentSeed();
+	Shot.Mass = Bullet->Mass;
+	Shot.Wind = Bullet->GetWind(World, Muzzle.GetLocation());
+	Shot.AirDensity = Bullet->GetAirDensity(World, Muzzle.GetLocation());
+	Shot.SpeedOfSound = Bullet->GetSpeedOfSound(World, Muzzle.GetLocation());
+
+	uint32 ShotId = Shot.ShotId;
+	Enqueue(MoveTemp(Entry));
+	return ShotId;
+}
+
+void FEBShotRecorder::RecordImpact(uint32 ShotId, double Timestamp, const FVector& Location, const FVector& IncomingVelocity, const FVector& ExitVelocity, bool Ricochet, bool Penetration) {
+	FEBImpactRecord Impact;
+	Impact.ShotId = ShotId;
+	Impact.Timestamp = Timestamp;
+	Impact.Location = Location;
+	Impact.IncomingVelocity = IncomingVelocity;
+	Impact.ExitVelocity = ExitVelocity;
+	Impact.Flags = (Ricochet ? FEBImpactRecord::Ricochet : 0) | (Penetration ? FEBImpactRecord::Penetration : 0);
+
+	if (ImpactCapture) {
+		ImpactCapture->Add(Impact);
+		return;
+	}
+
+	if (!IsRecording()) {
+		return;
+	}
+
+	FEntry Entry;
+	Entry.Type = EEntryType::Impact;
+	Entry.Impact = Impact;
+	Enqueue(MoveTemp(Entry));
+}
+
+void FEBShotRecorder::Enqueue(FEntry&& Entry) {
+	Queue.Enqueue(MoveTemp(Entry));
+	if (Pending.fetch_add(1) + 1 >= EB_RECORDER_FLUSH_THRESHOLD) {
+		KickFlush();
+	}
+}
+
+void FEBShotRecorder::KickFlush() {
+	bool Expected = false;
+	if (!FlushInFlight.compare_exchange_strong(Expected, true)) {
+		return; //already flushing, it will pick up our entries
+	}
+
+	FlushTask = Async(EAsyncExecution::ThreadPool, [this]() {
+		Flush();
+		FlushInFlight.store(false);
+	});
+}
+
+void FEBShotRecorder::Flush() {
+	//single consumer, guarded by FlushInFlight
+	FEntry Entry;
+	while (Queue.Dequeue(Entry)) {
+		Pending.fetch_sub(1);
+
+		uint8 Type = (uint8)Entry.Type;
+		*Writer << Type;
+
+		switch (Entry.Type) {
+		case EEntryType::Class:
+			*Writer << Entry.ClassPath;
+			break;
+		case EEntryType::Shot:
+			*Writer << Entry.Shot;
+			break;
+		case EEntryType::Impact:
+			*Writer << Entry.Impact;
+			break;
+		}
+	}
+	Writer->Flush();
+}
+
+bool FEBShotRecorder::Tick(float DeltaTime) {
+	if (Pending.load(std::memory_order_relaxed) > 0) {
+		KickFlush();
+	}
+	return true;
+}
+
+static FAutoConsoleCommand CmdEBRecordStart(
+	TEXT("eb.Record.Start"),
+	TEXT("Start recording fired bullets and impacts to a shot log. Optional argument is the file name."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args) {
+		FEBShotRecorder::Get().Start(Args.Num() > 0 ? Args[0] : FString());
+	})
+);
+
+static FAutoConsoleCommand CmdEBRecordStop(
+	TEXT("eb.Record.Stop"),
+	TEXT("Stop recording shots and close the shot log."),
+	FConsoleCommandDelegate::CreateLambda([]() {
+		FEBShotRecorder::Get().Stop();
+	})
+);
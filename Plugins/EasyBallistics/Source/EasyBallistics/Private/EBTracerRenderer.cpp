@@ -0,0 +1,137 @@
+// Copyright 2020 Mookie. All Rights Reserved.
+
+#include "EBTracerRenderer.h"
+#include "EBBullet.h"
+#include "EBStats.h"
+
+AEBTracerRenderer::AEBTracerRenderer() {
+	PrimaryActorTick.bCanEverTick = true;
+	//after bullets have moved
+	PrimaryActorTick.TickGroup = ETickingGroup::TG_PostUpdateWork;
+
+	Instances = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("Instances"));
+	Instances->SetMobility(EComponentMobility::Movable);
+	Instances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Instances->SetGenerateOverlapEvents(false);
+	Instances->SetCastShadow(false);
+	Instances->bSelectable = false;
+	RootComponent = Instances;
+}
+
+AEBTracerRenderer* AEBTracerRenderer::FindOrSpawn(UWorld* World, UStaticMesh* InMesh, UMaterialInterface* InMaterial) {
+	TArray<TWeakObjectPtr<AEBTracerRenderer>>& Renderers = GetMutableDefault<AEBTracerRenderer>()->Renderers;
+
+	for (int32 i = Renderers.Num() - 1; i >= 0; i--) {
+		AEBTracerRenderer* Renderer = Renderers[i].Get();
+		if (Renderer == nullptr) {
+			Renderers.RemoveAtSwap(i);
+		}
+		else if (Renderer->GetWorld() == World && Renderer->Mesh == InMesh && Renderer->Material == InMaterial) {
+			return Renderer;
+		}
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.ObjectFlags |= RF_Transient;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	AEBTracerRenderer* Renderer = World->SpawnActor<AEBTracerRenderer>(AEBTracerRenderer::StaticClass(), FTransform::Identity, SpawnParams);
+	if (Renderer) {
+		Renderer->Mesh = InMesh;
+		Renderer->Material = InMaterial;
+		Renderer->Instances->SetStaticMesh(InMesh);
+		if (InMaterial) { Renderer->Instances->SetMaterial(0, InMaterial); }
+		Renderers.Add(Renderer);
+	}
+	return Renderer;
+}
+
+void AEBTracerRenderer::Register(AEBBullet* Bullet) {
+	UWorld* World = Bullet->GetWorld();
+	if (World == nullptr || World->GetNetMode() == NM_DedicatedServer || Bullet->TracerMesh == nullptr || Bullet->TracerIndex != INDEX_NONE) {
+		return;
+	}
+
+	AEBTracerRenderer* Renderer = FindOrSpawn(World, Bullet->TracerMesh, Bullet->TracerMaterial);
+	if (Renderer) {
+		Bullet->TracerRenderer = Renderer;
+		Bullet->TracerIndex = Renderer->Bullets.Add(Bullet);
+	}
+}
+
+void AEBTracerRenderer::Unregister(AEBBullet* Bullet) {
+	AEBTracerRenderer* Renderer = Bullet->TracerRenderer.Get();
+	int32 Index = Bullet->TracerIndex;
+	Bullet->TracerRenderer = nullptr;
+	Bullet->TracerIndex = INDEX_NONE;
+
+	if (Renderer == nullptr || !Renderer->Bullets.IsValidIndex(Index)) {
+		return;
+	}
+
+	//swap last one into the hole
+	Renderer->Bullets.RemoveAtSwap(Index, 1, false);
+	if (Renderer->Bullets.IsValidIndex(Index)) {
+		Renderer->Bullets[Index]->TracerIndex = Index;
+	}
+}
+
+void AEBTracerRenderer::Tick(float DeltaSeconds) {
+	SCOPE_CYCLE_COUNTER(STAT_EBTracerUpdate);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AEBTracerRenderer::Tick);
+
+	Super::Tick(DeltaSeconds);
+
+	const int32 NumBullets = Bullets.Num();
+	if (NumBullets == 0) {
+		if (InstanceCount > 0) {
+			Instances->ClearInstances();
+			InstanceCount = 0;
+		}
+		return;
+	}
+
+	//instances are only added, surplus is collapsed to zero scale
+	const int32 NumInstances = FMath::Max(NumBullets, InstanceCount);
+	Transforms.SetNumUninitialized(NumInstances, false);
+
+	for (int32 i = 0; i < NumBullets; i++) {
+		const AEBBullet* Bullet = Bullets[i];
+		const FVector Velocity = Bullet->Velocity;
+		const float Speed = Velocity.Size();
+
+		if (Bullet->IsHidden() || Speed < KINDA_SMALL_NUMBER) {
+			Transforms[i] = FTransform(FQuat::Identity, Bullet->SimLocation, FVector::ZeroVector);
+			continue;
+		}
+
+		//mesh is one unit along X, stretched to end at the bullet
+		FQuat Rotation = FRotationMatrix::MakeFromX(Velocity).ToQuat();
+		FVector Scale(Speed * Bullet->TracerLength, Bullet->TracerWidth, Bullet->TracerWidth);
+		Transforms[i] = FTransform(Rotation, Bullet->SimLocation - Velocity * Bullet->TracerLength, Scale);
+	}
+	for (int32 i = NumBullets; i < NumInstances; i++) {
+		Transforms[i] = FTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector);
+	}
+
+	if (NumInstances > InstanceCount) {
+		TArray<FTransform> NewTransforms(Transforms.GetData() + InstanceCount, NumInstances - InstanceCount);
+		Instances->AddInstances(NewTransforms, false, true);
+		if (InstanceCount > 0) {
+			Instances->BatchUpdateInstancesTransforms(0, TArray<FTransform>(Transforms.GetData(), InstanceCount), true, true, true);
+		}
+		InstanceCount = NumInstances;
+	}
+	else {
+		//one upload per frame
+		Instances->BatchUpdateInstancesTransforms(0, Transforms, true, true, true);
+	}
+}
+
+void AEBTracerRenderer::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	for (AEBBullet* Bullet : Bullets) {
+		Bullet->TracerRenderer = nullptr;
+		Bullet->TracerIndex = INDEX_NONE;
+	}
+	Bullets.Reset();
+	Super::EndPlay(EndPlayReason);
+}
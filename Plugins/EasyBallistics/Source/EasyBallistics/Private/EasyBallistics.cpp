@@ -2,18 +2,51 @@
 // Copyright 2016 Mookie. All Rights Reserved.
 
 #include "EasyBallistics.h"
+#include "EBStats.h"
+#include "EBShotRecorder.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+
+DEFINE_STAT(STAT_EBBulletStep);
+DEFINE_STAT(STAT_EBBulletTrace);
+DEFINE_STAT(STAT_EBBulletSweptTargetTrace);
+DEFINE_STAT(STAT_EBBulletPenetrationTrace);
+DEFINE_STAT(STAT_EBBulletUpdateVelocity);
+DEFINE_STAT(STAT_EBBulletGetFromPool);
+DEFINE_STAT(STAT_EBFragmentBatch);
+DEFINE_STAT(STAT_EBTracerUpdate);
+DEFINE_STAT(STAT_EBBarrelTick);
+
+DEFINE_STAT(STAT_EBLiveBullets);
+DEFINE_STAT(STAT_EBTraces);
+DEFINE_STAT(STAT_EBPenetrationTraces);
+DEFINE_STAT(STAT_EBRicochets);
+DEFINE_STAT(STAT_EBPoolHits);
+DEFINE_STAT(STAT_EBPoolMisses);
+DEFINE_STAT(STAT_EBFragments);
+DEFINE_STAT(STAT_EBRPCsSent);
 
 #define LOCTEXT_NAMESPACE "FEasyBallisticsModule"
 
 void FEasyBallisticsModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
+
+	FString RecordFile;
+	if (FParse::Value(FCommandLine::Get(), TEXT("EBRecordShots="), RecordFile)) {
+		FEBShotRecorder::Get().Start(RecordFile);
+	}
+	else if (FParse::Param(FCommandLine::Get(), TEXT("EBRecordShots"))) {
+		FEBShotRecorder::Get().Start();
+	}
 }
 
 void FEasyBallisticsModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+
+	FEBShotRecorder::Get().Stop();
 }
 
 #undef LOCTEXT_NAMESPACE
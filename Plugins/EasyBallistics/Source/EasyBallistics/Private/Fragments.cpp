@@ -0,0 +1,194 @@
+// Copyright 2020 Mookie. All Rights Reserved.
+
+#include "EBBullet.h"
+#include "EBStats.h"
+#include "EBShotRecorder.h"
+#include "HAL/IConsoleManager.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+
+void AEBBullet::Fragment(UEBFragmentPattern* Pattern, FVector FragmentLocation, FVector Direction) {
+	//server only
+	if (!HasAuthority() || Pattern == nullptr) { return; }
+
+	int32 Seed = RandomStream.RandHelper(MAX_int32);
+
+	if (!GetIsReplicated()) {
+		SpawnFragmentBatch(GetWorld(), Pattern, Pattern->Count, FragmentLocation, Direction, Seed, GetOwner(), GetInstigator(), Cosmetic);
+		return;
+	}
+
+	//clients rebuild the same fragments from seed, nothing is replicated per fragment
+	//server spawns from the values clients will receive, so both run the pattern from identical inputs
+	FVector_NetQuantize NetLocation = UGameplayStatics::RebaseLocalOriginOntoZero(GetWorld(), FragmentLocation);
+	FVector_NetQuantizeNormal NetDirection = Direction.GetSafeNormal();
+	QuantizeFragmentOrigin(NetLocation, NetDirection);
+
+	//owner and instigator go with the rpc, this bullet may be deactivated or reused by the time clients get it
+	AActor* BulletOwner = GetOwner();
+	APawn* BulletInstigator = GetInstigator();
+	SpawnFragmentBatch(GetWorld(), Pattern, Pattern->Count, UGameplayStatics::RebaseZeroOriginOntoLocal(GetWorld(), NetLocation), NetDirection, Seed, BulletOwner, BulletInstigator, Cosmetic);
+
+	INC_DWORD_STAT(STAT_EBRPCsSent);
+	FragmentBroadcast(Pattern, NetLocation, NetDirection, Seed, BulletOwner, BulletInstigator);
+	FragmentBroadcastFrame = GFrameCounter;
+}
+
+void AEBBullet::QuantizeFragmentOrigin(FVector_NetQuantize& FragmentLocation, FVector_NetQuantizeNormal& Direction) {
+	//round trip through the same serializers the rpc uses
+	bool Success = true;
+	FBitWriter Writer(0, true);
+	FragmentLocation.NetSerialize(Writer, nullptr, Success);
+	Direction.NetSerialize(Writer, nullptr, Success);
+
+	FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+	FragmentLocation.NetSerialize(Reader, nullptr, Success);
+	Direction.NetSerialize(Reader, nullptr, Success);
+}
+
+void AEBBullet::FragmentBroadcast_Implementation(UEBFragmentPattern* Pattern, FVector_NetQuantize FragmentLocation, FVector_NetQuantizeNormal Direction, int32 Seed, AActor* BulletOwner, APawn* BulletInstigator) {
+	if (!HasAuthority() && Pattern != nullptr) {
+		SpawnFragmentBatch(GetWorld(), Pattern, Pattern->Count, UGameplayStatics::RebaseZeroOriginOntoLocal(GetWorld(), FragmentLocation), Direction, Seed, BulletOwner, BulletInstigator, true);
+	}
+}
+
+void AEBBullet::GetManyFromPool(UWorld* World, UClass* BulletClass, int32 Count, TArray<AEBBullet*>& OutBullets) {
+	SCOPE_CYCLE_COUNTER(STAT_EBBulletGetFromPool);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AEBBullet::GetManyFromPool);
+
+	AEBBullet* Pool = Cast<AEBBullet>(BulletClass->GetDefaultObject());
+	if (Pool == nullptr) { return; }
+
+	//single pass from the back, drops stale entries on the way
+	TArray<TWeakObjectPtr<AEBBullet>>& PoolArray = Pool->PooledLocal;
+	for (int32 i = PoolArray.Num() - 1; i >= 0 && OutBullets.Num() < Count; i--) {
+		AEBBullet* Bullet = PoolArray[i].Get();
+		if (Bullet == nullptr) {
+			PoolArray.RemoveAtSwap(i, 1, false);
+		}
+		else if (Bullet->GetWorld() == World) {
+			OutBullets.Add(Bullet);
+			PoolArray.RemoveAtSwap(i, 1, false);
+		}
+	}
+}
+
+void AEBBullet::SpawnFragmentBatch(UWorld* World, UEBFragmentPattern* Pattern, int32 Count, FVector FragmentLocation, FVector Direction, int32 Seed, AActor* BulletOwner, APawn* BulletInstigator, bool IsCosmetic, TArray<AEBBullet*>* OutFragments) {
+	SCOPE_CYCLE_COUNTER(STAT_EBFragmentBatch);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AEBBullet::SpawnFragmentBatch);
+
+	if (World == nullptr || Pattern == nullptr || Pattern->FragmentClass == nullptr || Count <= 0) {
+		UE_LOG(LogTemp, Warning, TEXT("Cannot spawn fragments - invalid world, pattern or fragment class"));
+		return;
+	}
+
+	UClass* FragmentClass = Pattern->FragmentClass;
+	AEBBullet* Default = Cast<AEBBullet>(FragmentClass->GetDefaultObject());
+	Direction = Direction.GetSafeNormal(SMALL_NUMBER, FVector::UpVector);
+
+	TArray<AEBBullet*> Fragments;
+	Fragments.Reserve(Count);
+	if (Default->EnablePooling) {
+		GetManyFromPool(World, FragmentClass, Count, Fragments);
+	}
+	const int32 RecycledCount = Fragments.Num();
+	INC_DWORD_STAT_BY(STAT_EBPoolHits, RecycledCount);
+	INC_DWORD_STAT_BY(STAT_EBPoolMisses, Count - RecycledCount);
+	INC_DWORD_STAT_BY(STAT_EBFragments, Count);
+
+	FTransform SpawnTransform(FQuat::Identity, FragmentLocation, Default->GetActorScale());
+	for (int32 i = RecycledCount; i < Count; i++) {
+		AEBBullet* Bullet = World->SpawnActorDeferred<AEBBullet>(FragmentClass, SpawnTransform, BulletOwner, BulletInstigator);
+		if (Bullet == nullptr) { break; }
+		Bullet->SetReplicates(false);
+		Fragments.Add(Bullet);
+	}
+
+	//pattern stream draws in fixed order per fragment, independent of which fragments came from the pool
+	FRandomStream PatternStream(Seed);
+	const float MassMin = FMath::Max(Pattern->MassMin, KINDA_SMALL_NUMBER);
+
+	for (int32 i = 0; i < Fragments.Num(); i++) {
+		AEBBullet* Bullet = Fragments[i];
+
+		FVector FragmentDirection = (Pattern->Shape == EEBFragmentShape::FS_Cone) ? PatternStream.VRandCone(Direction, Pattern->ConeAngle) : PatternStream.VRand();
+		float Speed = FMath::Lerp(Pattern->VelocityMin, Pattern->VelocityMax, FMath::Pow(PatternStream.FRand(), Pattern->VelocityBias));
+		float FragmentMass = FMath::Lerp(MassMin, FMath::Max(Pattern->MassMax, MassMin), FMath::Pow(PatternStream.FRand(), Pattern->MassBias));
+		int32 FragmentSeed = PatternStream.RandHelper(MAX_int32);
+		float Roll = PatternStream.FRandRange(-180.0f, 180.0f);
+
+		Speed = FMath::Lerp(Speed, Speed * FMath::Sqrt(MassMin / FragmentMass), Pattern->VelocityMassInfluence);
+		FVector FragmentVelocity = FragmentDirection * Speed;
+
+		FTransform Transform = SpawnTransform;
+		if (Default->RotateActor) {
+			FRotator Rotation = UKismetMathLibrary::MakeRotFromX(FragmentVelocity);
+			if (Default->RotateRandomRoll) Rotation.Roll = Roll;
+			Transform.SetRotation(Rotation.Quaternion());
+		}
+
+		Bullet->Mass = FragmentMass;
+		Bullet->Cosmetic = IsCosmetic;
+		Bullet->RandomStream.Initialize(FragmentSeed);
+
+		if (i < RecycledCount) {
+			Bullet->PrepareReactivation(Default, Transform, FragmentVelocity, BulletOwner, BulletInstigator);
+			if (!IsCosmetic) {
+				Bullet->RecordedShotId = FEBShotRecorder::Get().RecordShot(Bullet, Transform, FragmentVelocity);
+			}
+			if (!Bullet->HasActorBegunPlay()) { Bullet->BeginPlay(); }
+		}
+		else {
+			Bullet->Velocity = FragmentVelocity;
+			Bullet->SimLocation = Transform.GetLocation();
+			Bullet->RecordedShotId = IsCosmetic ? 0 : FEBShotRecorder::Get().RecordShot(Bullet, Transform, FragmentVelocity);
+			UGameplayStatics::FinishSpawningActor(Bullet, Transform);
+		}
+	}
+
+#ifdef WITH_EDITOR
+	if (Default->DebugPooling) {
+		GEngine->AddOnScreenDebugMessage(0, 2, FColor::Green, FString::Printf(TEXT("Fragments: %d recycled, %d spawned"), RecycledCount, Fragments.Num() - RecycledCount));
+	}
+#endif
+
+	if (OutFragments) {
+		OutFragments->Append(Fragments);
+	}
+}
+
+//eb.Bench.Fragments <PatternPath> [Detonations] [Count]
+static FAutoConsoleCommandWithWorldAndArgs CmdEBBenchFragments(
+	TEXT("eb.Bench.Fragments"),
+	TEXT("Detonates a fragment pattern repeatedly in front of the world origin and logs batch spawn timings. Args: <PatternPath> [Detonations=10] [Count=500]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World) {
+		UEBFragmentPattern* Pattern = Args.Num() > 0 ? LoadObject<UEBFragmentPattern>(nullptr, *Args[0]) : nullptr;
+		if (Pattern == nullptr || World == nullptr) {
+			UE_LOG(LogTemp, Warning, TEXT("eb.Bench.Fragments - cannot load fragment pattern"));
+			return;
+		}
+
+		int32 Detonations = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 10;
+		int32 Count = Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 500;
+
+		double Total = 0.0;
+		double Worst = 0.0;
+		TArray<AEBBullet*> Fragments;
+		for (int32 i = 0; i < Detonations; i++) {
+			Fragments.Reset();
+			double Start = FPlatformTime::Seconds();
+			AEBBullet::SpawnFragmentBatch(World, Pattern, Count, FVector(0, 0, 1000.0f), FVector::UpVector, i, nullptr, nullptr, false, &Fragments);
+			double Elapsed = FPlatformTime::Seconds() - Start;
+			Total += Elapsed;
+			Worst = FMath::Max(Worst, Elapsed);
+
+			//back to the pool outside the timed part, so every detonation starts from the same state
+			for (AEBBullet* Fragment : Fragments) {
+				Fragment->Deactivate();
+			}
+		}
+
+		UE_LOG(LogTemp, Display, TEXT("eb.Bench.Fragments - %d detonations of %d fragments, average %.3f ms, worst %.3f ms"),
+			Detonations, Count, Total / FMath::Max(Detonations, 1) * 1000.0, Worst * 1000.0);
+	})
+);
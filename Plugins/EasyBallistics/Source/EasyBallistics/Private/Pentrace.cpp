@@ -1,8 +1,13 @@
 // Copyright 2020 Mookie. All Rights Reserved.
 
 #include "EBBullet.h"
+#include "EBStats.h"
 
 float AEBBullet::PenetrationTrace(FVector StartLocation, FVector EndLocation, TWeakObjectPtr<UPrimitiveComponent, FWeakObjectPtr> Component, EPenTraceType PenTraceType, TEnumAsByte<ECollisionChannel> CollisionChannel, FVector &ExitLocation, FVector &ExitNormal) {
+	SCOPE_CYCLE_COUNTER(STAT_EBBulletPenetrationTrace);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AEBBullet::PenetrationTrace);
+	INC_DWORD_STAT(STAT_EBPenetrationTraces);
+
 	FCollisionQueryParams QueryParams;
 	QueryParams.bTraceComplex = TraceComplex;
 	QueryParams.bFindInitialOverlaps = true;
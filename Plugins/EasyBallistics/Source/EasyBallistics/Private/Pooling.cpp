@@ -1,21 +1,32 @@
 #include "EBBullet.h"
+#include "EBStats.h"
+#include "EBShotRecorder.h"
 
 void AEBBullet::Deactivate() {
 	//server only
 	if (!HasAuthority()) { return; }
 	OnDeactivated();
 	this->DeactivateToPool();
-	DeactivationBroadcast();
+	if (GetIsReplicated()) {
+		INC_DWORD_STAT(STAT_EBRPCsSent);
+		DeactivationBroadcast();
+	}
 }
 
 AEBBullet* AEBBullet::GetFromPool(UWorld* World, UClass* BulletClass) {
+	SCOPE_CYCLE_COUNTER(STAT_EBBulletGetFromPool);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AEBBullet::GetFromPool);
+
 	AEBBullet* Pool = Cast<AEBBullet>(BulletClass->GetDefaultObject());
 
 	if (Pool) {
+		//same array DeactivateToPool put bullets of this class in
+		TArray<TWeakObjectPtr<AEBBullet>>& PoolArray = Pool->GetIsReplicated() ? Pool->Pooled : Pool->PooledLocal;
+
 		//find first of correct class;
 		bool CleanupRequired=false;
 
-		int32 FoundIndex = Pool->Pooled.IndexOfByPredicate(
+		int32 FoundIndex = PoolArray.IndexOfByPredicate(
 			[&](auto InItem) {
 			if (InItem.IsValid() && InItem->GetWorld() == World) {
 				return true;
@@ -28,8 +39,8 @@ AEBBullet* AEBBullet::GetFromPool(UWorld* World, UClass* BulletClass) {
 
 		TWeakObjectPtr<AEBBullet> Found = nullptr;
 		if (FoundIndex != INDEX_NONE) {
-			Found = Pool->Pooled[FoundIndex];
-			Pool->Pooled.RemoveAtSwap(FoundIndex);
+			Found = PoolArray[FoundIndex];
+			PoolArray.RemoveAtSwap(FoundIndex);
 		}
 
 		if (CleanupRequired) {
@@ -38,7 +49,7 @@ AEBBullet* AEBBullet::GetFromPool(UWorld* World, UClass* BulletClass) {
 			GEngine->AddOnScreenDebugMessage(2, 2, FColor::White, TEXT("Invalid reference in pool, cleaning up"));
 		}
 #endif
-			Pool->Pooled.RemoveAll([&](auto InItem) {
+			PoolArray.RemoveAll([&](auto InItem) {
 				if (InItem.IsValid() && InItem->GetWorld() == World) {
 					return false;
 				}
@@ -61,22 +72,16 @@ AEBBullet* AEBBullet::SpawnOrReactivate(UWorld* World, TSubclassOf<class AEBBull
 	AEBBullet* Recycled = GetFromPool(World, BulletClass); 
 
 	if (Recycled) {
+		INC_DWORD_STAT(STAT_EBPoolHits);
 		AEBBullet* Default = Cast<AEBBullet>(BulletClass->GetDefaultObject());
 
-		Recycled->Reset();
-
-		Recycled->SetOwner(BulletOwner);
-		Recycled->SetInstigator(BulletInstigator);
-		Recycled->SetActorTransform(Transform,false,nullptr,ETeleportType::TeleportPhysics);
-		Recycled->Velocity = BulletVelocity;
-		Recycled->SetActorHiddenInGame(Default->IsHidden());
-		Recycled->SetActorTickEnabled(true);
-		Recycled->CanRetrace = false;
-		Recycled->IgnoredActors = Default->IgnoredActors;
-		Recycled->SafeDelay = Default->SafeDelay;
-		Recycled->SetLifeSpan(Default->InitialLifeSpan);
+		Recycled->PrepareReactivation(Default, Transform, BulletVelocity, BulletOwner, BulletInstigator);
+		Recycled->RecordedShotId = FEBShotRecorder::Get().RecordShot(Recycled, Transform, BulletVelocity);
 		if (!Recycled->HasActorBegunPlay()){ Recycled->BeginPlay(); }
-		Recycled->ReactivationBroadcast(UGameplayStatics::RebaseLocalOriginOntoZero(Recycled->GetWorld(), Transform.GetLocation()), BulletVelocity, BulletOwner, BulletInstigator);
+		if (Recycled->GetIsReplicated()) {
+			INC_DWORD_STAT(STAT_EBRPCsSent);
+			Recycled->ReactivationBroadcast(UGameplayStatics::RebaseLocalOriginOntoZero(Recycled->GetWorld(), Transform.GetLocation()), BulletVelocity, BulletOwner, BulletInstigator);
+		}
 #ifdef WITH_EDITOR
 		if (Recycled->DebugPooling) {
 			GEngine->AddOnScreenDebugMessage(0, 2, FColor::Green, TEXT("Recycling pooled bullet"));
@@ -85,9 +90,12 @@ AEBBullet* AEBBullet::SpawnOrReactivate(UWorld* World, TSubclassOf<class AEBBull
 		return Recycled;
 	}
 	else {
+		INC_DWORD_STAT(STAT_EBPoolMisses);
 		bullet = Cast<AEBBullet>(World->SpawnActorDeferred<AEBBullet>(BulletClass, Transform, BulletOwner, BulletInstigator));
 		bullet->RandomStream.GenerateNewSeed();
 		bullet->Velocity = BulletVelocity;
+		bullet->SimLocation = Transform.GetLocation();
+		bullet->RecordedShotId = FEBShotRecorder::Get().RecordShot(bullet, Transform, BulletVelocity);
 		UGameplayStatics::FinishSpawningActor(bullet, Transform);
 #ifdef WITH_EDITOR
 		if (bullet->DebugPooling) {
@@ -98,6 +106,22 @@ AEBBullet* AEBBullet::SpawnOrReactivate(UWorld* World, TSubclassOf<class AEBBull
 	}
 }
 
+void AEBBullet::PrepareReactivation(const AEBBullet* Default, const FTransform& Transform, FVector BulletVelocity, AActor* BulletOwner, APawn* BulletInstigator) {
+	Reset();
+
+	SetOwner(BulletOwner);
+	SetInstigator(BulletInstigator);
+	SetActorTransform(Transform, false, nullptr, ETeleportType::TeleportPhysics);
+	SimLocation = Transform.GetLocation();
+	Velocity = BulletVelocity;
+	SetActorHiddenInGame(Default->IsHidden());
+	SetActorTickEnabled(true);
+	CanRetrace = false;
+	IgnoredActors = Default->IgnoredActors;
+	SafeDelay = Default->SafeDelay;
+	SetLifeSpan(Default->InitialLifeSpan);
+}
+
 void AEBBullet::ReactivationBroadcast_Implementation(FVector_NetQuantize NewLocation, FVector NewVelocity, AActor* BulletOwner, APawn* BulletInstigator) {
 	if (!HasAuthority()) {
 		AEBBullet* Default = Cast<AEBBullet>(this->StaticClass()->GetDefaultObject());
@@ -105,7 +129,7 @@ void AEBBullet::ReactivationBroadcast_Implementation(FVector_NetQuantize NewLoca
 		SetOwner(BulletOwner);
 		SetInstigator(BulletInstigator);
 
-		SetActorLocation(UGameplayStatics::RebaseZeroOriginOntoLocal(GetWorld(), NewLocation));
+		SetSimLocation(UGameplayStatics::RebaseZeroOriginOntoLocal(GetWorld(), NewLocation));
 		Velocity = NewVelocity;
 		CanRetrace = false;
 
@@ -134,21 +158,30 @@ void AEBBullet::DeactivateToPool() {
 	if (Pool && EnablePooling) {
 		SetActorHiddenInGame(true);
 		SetActorTickEnabled(false);
-		Pool->Pooled.Add(this);
+		TArray<TWeakObjectPtr<AEBBullet>>& PoolArray = GetIsReplicated() ? Pool->Pooled : Pool->PooledLocal;
+		PoolArray.Add(this);
 		EndPlay(EEndPlayReason::RemovedFromWorld);
 
-		if (Pool->Pooled.Num() > MaxPoolSize) {
-			AEBBullet* Oldest = (Pool->Pooled[0].Get());
-			Pool->Pooled.RemoveAtSwap(0);
+		if (PoolArray.Num() > MaxPoolSize) {
+			AEBBullet* Oldest = (PoolArray[0].Get());
+			PoolArray.RemoveAtSwap(0);
 			if (Oldest) { Oldest->Destroy(); }
 		}
 
 #ifdef WITH_EDITOR
 		if (DebugPooling) {
-			GEngine->AddOnScreenDebugMessage(2, 2, FColor::White, FString("Bullet pooled: ") + FString::FromInt(Pool->Pooled.Num()));
+			GEngine->AddOnScreenDebugMessage(2, 2, FColor::White, FString("Bullet pooled: ") + FString::FromInt(PoolArray.Num()));
 		}
 #endif
 	}
+	else if (FragmentBroadcastFrame == GFrameCounter) {
+		//fragment broadcast from this frame has not gone out yet, closing the channel now would drop it
+		SetActorHiddenInGame(true);
+		SetActorTickEnabled(false);
+		GetWorldTimerManager().SetTimerForNextTick([WeakThis = TWeakObjectPtr<AEBBullet>(this)]() {
+			if (WeakThis.IsValid()) { WeakThis->Destroy(); }
+		});
+	}
 	else {
 		Destroy();
 	}
@@ -0,0 +1,81 @@
+// Copyright 2020 Mookie. All Rights Reserved.
+
+#include "EBBullet.h"
+#include "EBStats.h"
+
+void AEBBullet::RegisterSweptTarget(UPrimitiveComponent* Component) {
+	if (Component == nullptr) { return; }
+
+	TArray<TWeakObjectPtr<UPrimitiveComponent>>& Targets = GetMutableDefault<AEBBullet>()->SweptTargets;
+	Targets.RemoveAll([](const TWeakObjectPtr<UPrimitiveComponent>& Target) { return !Target.IsValid(); });
+	Targets.AddUnique(Component);
+}
+
+void AEBBullet::UnregisterSweptTarget(UPrimitiveComponent* Component) {
+	GetMutableDefault<AEBBullet>()->SweptTargets.Remove(Component);
+}
+
+void AEBBullet::RegisterSweptTargetsByTag(AActor* Actor, FName Tag) {
+	if (Actor == nullptr) { return; }
+
+	TInlineComponentArray<UPrimitiveComponent*> Components(Actor);
+	for (UPrimitiveComponent* Component : Components) {
+		if (Component->ComponentHasTag(Tag)) {
+			RegisterSweptTarget(Component);
+		}
+	}
+}
+
+void AEBBullet::IgnoreSweptTargets(FCollisionQueryParams& QueryParams) const {
+	//world trace would see targets frozen at their current pose and stop at them, hiding geometry behind
+	for (const TWeakObjectPtr<UPrimitiveComponent>& Target : GetDefault<AEBBullet>()->SweptTargets) {
+		UPrimitiveComponent* Component = Target.Get();
+		if (Component != nullptr && Component->GetWorld() == GetWorld()) {
+			QueryParams.AddIgnoredComponent(Component);
+		}
+	}
+}
+
+void AEBBullet::SweptTargetTrace(FVector Start, FVector End, float Delta, TEnumAsByte<ECollisionChannel> CollisionChannel, const FCollisionQueryParams& QueryParams, TArray<FHitResult>& Results, TMap<const UPrimitiveComponent*, FVector>& Offsets) const {
+	const TArray<TWeakObjectPtr<UPrimitiveComponent>>& Targets = GetDefault<AEBBullet>()->SweptTargets;
+	if (Targets.Num() == 0) { return; }
+
+	SCOPE_CYCLE_COUNTER(STAT_EBBulletSweptTargetTrace);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AEBBullet::SweptTargetTrace);
+
+	bool Added = false;
+	for (const TWeakObjectPtr<UPrimitiveComponent>& Target : Targets) {
+		UPrimitiveComponent* Component = Target.Get();
+		if (Component == nullptr || Component->GetWorld() != GetWorld() || !Component->IsQueryCollisionEnabled()) { continue; }
+
+		ECollisionResponse Response = Component->GetCollisionResponseToChannel(CollisionChannel);
+		if (Response == ECR_Ignore) { continue; }
+
+		AActor* TargetActor = Component->GetOwner();
+		if (TargetActor && QueryParams.GetIgnoredActors().Contains(TargetActor->GetUniqueID())) { continue; }
+
+		//trace in target frame, target moves by Motion over the step
+		FVector Motion = Component->GetComponentVelocity() * Delta;
+		FVector RelativeEnd = End - Motion;
+
+		if (!FMath::LineBoxIntersection(Component->Bounds.GetBox(), Start, RelativeEnd, RelativeEnd - Start)) { continue; }
+
+		FHitResult Hit;
+		if (Component->LineTraceComponent(Hit, Start, RelativeEnd, QueryParams)) {
+			//back to world, target has moved by the time bullet reaches it
+			FVector Offset = Motion * Hit.Time;
+			Hit.Location += Offset;
+			Hit.ImpactPoint += Offset;
+			Hit.TraceStart = Start;
+			Hit.TraceEnd = End;
+			Hit.bBlockingHit = (Response == ECR_Block);
+			Results.Add(Hit);
+			Offsets.Add(Component, Offset);
+			Added = true;
+		}
+	}
+
+	if (Added) {
+		Results.StableSort([](const FHitResult& A, const FHitResult& B) { return A.Time < B.Time; });
+	}
+}
@@ -1,8 +1,13 @@
 // Copyright 2016 Mookie. All Rights Reserved.
 
 #include "EBBullet.h"
+#include "EBStats.h"
+#include "EBShotRecorder.h"
 
 float AEBBullet::Trace(FVector start, FVector PreviousVelocity, float delta, TEnumAsByte<ECollisionChannel> CollisionChannel) {
+	SCOPE_CYCLE_COUNTER(STAT_EBBulletTrace);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AEBBullet::Trace);
+	INC_DWORD_STAT(STAT_EBTraces);
 
 	bool Hit;
 	FHitResult HitResult;
@@ -23,7 +28,13 @@ float AEBBullet::Trace(FVector start, FVector PreviousVelocity, float delta, TEn
 
 	FVector TraceDistance = (PreviousVelocity + Velocity)*0.5*delta;
 
-	GetWorld()->LineTraceMultiByChannel(Results, start, start + TraceDistance, CollisionChannel, CollisionParameters, ResponseParameters);
+	//swept targets are traced separately, at their pose when the bullet reaches them
+	FCollisionQueryParams WorldParameters = CollisionParameters;
+	IgnoreSweptTargets(WorldParameters);
+
+	GetWorld()->LineTraceMultiByChannel(Results, start, start + TraceDistance, CollisionChannel, WorldParameters, ResponseParameters);
+	TMap<const UPrimitiveComponent*, FVector> SweptOffsets;
+	SweptTargetTrace(start, start + TraceDistance, delta, CollisionChannel, CollisionParameters, Results, SweptOffsets);
 	if (Results.Num() > 0) {
 		HitResult = FilterHits(Results, Hit);
 	}
@@ -108,16 +119,21 @@ float AEBBullet::Trace(FVector start, FVector PreviousVelocity, float delta, TEn
 
 		float BlockTIme = 1.0f;
 
+		//swept target is still at its current pose, penetrate and push it in its own frame
+		const FVector* SweptOffset = SweptOffsets.Find(HitResult.Component.Get());
+		FVector TargetOffset = SweptOffset ? *SweptOffset : FVector::ZeroVector;
+		FVector TargetHitLocation = HitResult.Location - TargetOffset;
+
 		if (PenetrationDistance > 0.0f) {
 			if (!neverPenetrate) {
-					BlockTIme = PenetrationTrace(HitResult.Location - (HitResult.Normal * CollisionMargin), HitResult.Location + PenetrationVector * PenetrationDistance, HitResult.Component, PenTraceType, CollisionChannel, exitLoc, exitNormal);
+					BlockTIme = PenetrationTrace(TargetHitLocation - (HitResult.Normal * CollisionMargin), TargetHitLocation + PenetrationVector * PenetrationDistance, HitResult.Component, PenTraceType, CollisionChannel, exitLoc, exitNormal);
 				}
 			}
 
 		if (BlockTIme >= 0.999999f) {
 
 			//no pen
-			SetActorLocation(HitResult.Location + HitResult.Normal * CollisionMargin);
+			SetSimLocation(HitResult.Location + HitResult.Normal * CollisionMargin);
 
 			float ricThreshold = 1.0f;
 			if (SpeedControlsRicochetProbability) { ricThreshold *= Velocity.Size() / MuzzleVelocityMax; };
@@ -131,6 +147,7 @@ float AEBBullet::Trace(FVector start, FVector PreviousVelocity, float delta, TEn
 				NewVelocity = bounceAngle * Velocity.Size();
 				Ricochet = true;
 				OwnerSafe = false;
+				INC_DWORD_STAT(STAT_EBRicochets);
 			}
 			else {
 				//stopped
@@ -140,7 +157,7 @@ float AEBBullet::Trace(FVector start, FVector PreviousVelocity, float delta, TEn
 		else {
 			//penetration
 			float RemainingEnergy = FMath::Pow(1.0f - BlockTIme, 2.0f);
-			SetActorLocation(exitLoc + exitNormal * CollisionMargin);
+			SetSimLocation(exitLoc + TargetOffset + exitNormal * CollisionMargin);
 			NewVelocity = RandomStream.VRandCone(PenetrationVector, penExitSpread * (1.0f - RemainingEnergy));
 			NewVelocity = FMath::Lerp(NewVelocity, Velocity.GetSafeNormal(), RemainingEnergy);
 			NewVelocity *= RemainingEnergy * Velocity.Size();
@@ -153,15 +170,18 @@ float AEBBullet::Trace(FVector start, FVector PreviousVelocity, float delta, TEn
 		FVector Impulse = (Velocity - NewVelocity) * Mass * ImpulseMultiplier;
 
 		if (AddImpulse && HitResult.Component->IsSimulatingPhysics()) {
-			HitResult.Component->AddImpulseAtLocation(Impulse, HitResult.Location, HitResult.BoneName);
+			HitResult.Component->AddImpulseAtLocation(Impulse, TargetHitLocation, HitResult.BoneName);
 		}
 
 		//impact actual
-		if (HasAuthority()) {
-			OnImpact(Ricochet, Penetration, HitResult.Location, Velocity, HitResult.Normal, GetActorLocation(), NewVelocity, Impulse, PenetrationDepth, HitResult.GetActor(), HitResult.Component.Get(), HitResult.BoneName, PhysMaterial, HitResult);
+		if (HasAuthority() && !Cosmetic) {
+			if (RecordedShotId != 0) {
+				FEBShotRecorder::Get().RecordImpact(RecordedShotId, GetWorld()->GetTimeSeconds(), UGameplayStatics::RebaseLocalOriginOntoZero(GetWorld(), HitResult.Location), Velocity, NewVelocity, Ricochet, Penetration);
+			}
+			OnImpact(Ricochet, Penetration, HitResult.Location, Velocity, HitResult.Normal, SimLocation, NewVelocity, Impulse, PenetrationDepth, HitResult.GetActor(), HitResult.Component.Get(), HitResult.BoneName, PhysMaterial, HitResult);
 		}
 		else {
-			OnNetPredictedImpact(Ricochet, Penetration, HitResult.Location, Velocity, HitResult.Normal, GetActorLocation(), NewVelocity, Impulse, PenetrationDepth, HitResult.GetActor(), HitResult.Component.Get(), HitResult.BoneName, PhysMaterial, HitResult);
+			OnNetPredictedImpact(Ricochet, Penetration, HitResult.Location, Velocity, HitResult.Normal, SimLocation, NewVelocity, Impulse, PenetrationDepth, HitResult.GetActor(), HitResult.Component.Get(), HitResult.BoneName, PhysMaterial, HitResult);
 		}
 
 		Velocity = NewVelocity;
@@ -181,10 +201,10 @@ float AEBBullet::Trace(FVector start, FVector PreviousVelocity, float delta, TEn
 			LastTraceVelocity = Velocity;
 		}
 
-		SetActorLocation(start + TraceDistance);
+		SetSimLocation(start + TraceDistance);
 		HitResult.Time = 1.0f;
 
-		OnTrace(start, GetActorLocation());
+		OnTrace(start, SimLocation);
 
 #ifdef WITH_EDITOR
 		if (DebugEnabled) {
@@ -12,6 +12,7 @@
 #include "DrawDebugHelpers.h"
 
 #include "EBMaterialResponseMap.h"
+#include "EBFragmentPattern.h"
 
 #include "EBBullet.generated.h"
 
@@ -128,15 +129,25 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Rotation") bool RotateActor = true;
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Rotation") bool RotateRandomRoll = true;
 
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Tracer", meta = (ToolTip = "Draw bullet with a shared instanced mesh instead of own components, actor transform is not updated in flight - use GetBulletLocation")) bool InstancedTracer = false;
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Tracer", meta = (EditCondition = "InstancedTracer", ToolTip = "Mesh pointing along X, one unit long")) UStaticMesh* TracerMesh;
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Tracer", meta = (EditCondition = "InstancedTracer")) UMaterialInterface* TracerMaterial;
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Tracer", meta = (EditCondition = "InstancedTracer", ToolTip = "Tracer length, in seconds of flight", ClampMin = "0")) float TracerLength = 0.02f;
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Tracer", meta = (EditCondition = "InstancedTracer", ClampMin = "0")) float TracerWidth = 1.0f;
+
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Pooling") bool EnablePooling = true;
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Pooling") int MaxPoolSize = 50;
 
 	//rebase
 	virtual void ApplyWorldOffset(const FVector& InOffset, bool bWorldShift) override;
 
+	virtual void PostInitializeComponents() override;
+
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 	
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	// Called every frame
 	virtual void Tick(float DeltaSeconds) override;
 
@@ -148,6 +159,26 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "EBBullet|Spawn")
 		static void Spawn(TSubclassOf<class AEBBullet> BulletClass, AActor* BulletOwner, APawn* BulletInstigator, FVector BulletLocation, FVector BulletVelocity);
 
+	UFUNCTION(BlueprintPure, Category = "EBBullet|Flight", meta = (ToolTip = "Simulated location, same as actor location unless instanced tracer is used"))
+		FVector GetBulletLocation() const { return SimLocation; }
+
+	//swept collision, registered components are traced in their own frame using their linear velocity over the step
+	UFUNCTION(BlueprintCallable, Category = "EBBullet|Collision", meta = (ToolTip = "Fast moving component is traced using its velocity, so bullets cannot tunnel through it"))
+		static void RegisterSweptTarget(UPrimitiveComponent* Component);
+	UFUNCTION(BlueprintCallable, Category = "EBBullet|Collision")
+		static void UnregisterSweptTarget(UPrimitiveComponent* Component);
+	UFUNCTION(BlueprintCallable, Category = "EBBullet|Collision", meta = (ToolTip = "Registers all primitive components of actor that have the tag"))
+		static void RegisterSweptTargetsByTag(AActor* Actor, FName Tag = "EBSweptTarget");
+
+	UFUNCTION(BlueprintAuthorityOnly, BlueprintCallable, Category = "EBBullet|Spawn", meta = (ToolTip = "Spawns a fragment pattern in one batch, clients reproduce fragments from a shared seed instead of replicating each one"))
+		void Fragment(UEBFragmentPattern* Pattern, FVector FragmentLocation, FVector Direction);
+
+	UFUNCTION(NetMulticast, Reliable)
+		void FragmentBroadcast(UEBFragmentPattern* Pattern, FVector_NetQuantize FragmentLocation, FVector_NetQuantizeNormal Direction, int32 Seed, AActor* BulletOwner, APawn* BulletInstigator);
+
+	//spawns or reactivates Count non-replicated fragments, deterministic for given seed
+	static void SpawnFragmentBatch(UWorld* World, UEBFragmentPattern* Pattern, int32 Count, FVector FragmentLocation, FVector Direction, int32 Seed, AActor* BulletOwner, APawn* BulletInstigator, bool IsCosmetic, TArray<AEBBullet*>* OutFragments = nullptr);
+
 	UFUNCTION(NetMulticast, Unreliable)
 		void VelocityChangeBroadcast(FVector_NetQuantize NewLocation, FVector NewVelocity);
 	UFUNCTION(NetMulticast, Reliable)
@@ -182,15 +213,36 @@ public:
 	UFUNCTION(NetMulticast, Reliable)
 		void DeactivationBroadcast();
 private:
+	friend class UEBReplayCommandlet;
+
 	UPROPERTY() TArray<TWeakObjectPtr<AEBBullet>> Pooled;
+	UPROPERTY() TArray<TWeakObjectPtr<AEBBullet>> PooledLocal; //non-replicated bullets and fragments
+	UPROPERTY() TArray<TWeakObjectPtr<UPrimitiveComponent>> SweptTargets; //only used on AEBBullet default object
 	static AEBBullet* GetFromPool(UWorld* World, UClass* BulletClass);
+	static void GetManyFromPool(UWorld* World, UClass* BulletClass, int32 Count, TArray<AEBBullet*>& OutBullets);
+	void PrepareReactivation(const AEBBullet* Default, const FTransform& Transform, FVector BulletVelocity, AActor* BulletOwner, APawn* BulletInstigator);
 	static AEBBullet* SpawnOrReactivate(UWorld* World, TSubclassOf<class AEBBullet> BulletClass, const FTransform& Transform, FVector BulletVelocity, AActor* BulletOwner, APawn* BulletInstigator);
 	void DeactivateToPool();
 
 	void Step(float DeltaTime);
 
+	FVector SimLocation = FVector::ZeroVector;
+	void SetSimLocation(const FVector& NewLocation);
+
+	//index in tracer renderer, INDEX_NONE when not drawn
+	TWeakObjectPtr<class AEBTracerRenderer> TracerRenderer;
+	int32 TracerIndex = INDEX_NONE;
+	friend class AEBTracerRenderer;
+
 	float Trace(FVector start, FVector PreviousVelocity, float delta, TEnumAsByte<ECollisionChannel> channel);
 
+	//rounds fragment origin to exactly what FragmentBroadcast delivers
+	static void QuantizeFragmentOrigin(FVector_NetQuantize& FragmentLocation, FVector_NetQuantizeNormal& Direction);
+
+	void IgnoreSweptTargets(FCollisionQueryParams& QueryParams) const;
+	//Offsets: per hit target, how far it moves between its current pose and the hit
+	void SweptTargetTrace(FVector Start, FVector End, float Delta, TEnumAsByte<ECollisionChannel> CollisionChannel, const FCollisionQueryParams& QueryParams, TArray<FHitResult>& Results, TMap<const UPrimitiveComponent*, FVector>& Offsets) const;
+
 	TArray<AActor*> GetAttachedActorsRecursive(AActor* Actor,uint16 Depth=0) const;
 
 	float PenetrationTrace(FVector start, FVector end, TWeakObjectPtr<UPrimitiveComponent,FWeakObjectPtr> comp, EPenTraceType penType, TEnumAsByte<ECollisionChannel> channel, FVector &exitLoc, FVector &exitNormal);
@@ -206,6 +258,16 @@ private:
 	FVector LastTracePrevVelocity;
 
 	bool IsRecycled;
+	bool IsLive = false;
+
+	//frame a FragmentBroadcast was sent on, destroying the bullet in the same frame would drop it
+	uint64 FragmentBroadcastFrame = 0;
+
+	//locally simulated fragment on a client, reports predicted impacts only
+	bool Cosmetic = false;
+
+	//shot recorder id, 0 when not recorded
+	uint32 RecordedShotId = 0;
 
 	FHitResult FilterHits(TArray<FHitResult> Results, bool &hit) const;
 	TArray<AActor*>GetSafeLaunchIgnoredActors(AActor* Owner) const;
@@ -0,0 +1,35 @@
+// Copyright 2020 Mookie. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "EBFragmentPattern.generated.h"
+
+UENUM(BlueprintType)
+enum class EEBFragmentShape : uint8
+{
+	FS_Cone UMETA(DisplayName = "Cone"),
+	FS_Sphere UMETA(DisplayName = "Sphere"),
+};
+
+UCLASS(BlueprintType)
+class EASYBALLISTICS_API UEBFragmentPattern : public UDataAsset {
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Fragments", meta = (ToolTip = "Bullet class used for fragments, pooled separately from replicated bullets of the same class")) TSubclassOf<class AEBBullet> FragmentClass;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Fragments", meta = (ClampMin = "0")) int32 Count = 100;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Shape") EEBFragmentShape Shape = EEBFragmentShape::FS_Sphere;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Shape", meta = (ToolTip = "Cone half angle, in radians", EditCondition = "Shape == EEBFragmentShape::FS_Cone", ClampMin = "0")) float ConeAngle = 0.5f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Mass", meta = (ToolTip = "in kg", ClampMin = "0")) float MassMin = 0.001f;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Mass", meta = (ToolTip = "in kg", ClampMin = "0")) float MassMax = 0.01f;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Mass", meta = (ToolTip = "Distribution bias, higher produces more light fragments", ClampMin = "0")) float MassBias = 1.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Velocity", meta = (ToolTip = "in cm/s", ClampMin = "0")) float VelocityMin = 50000.0f;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Velocity", meta = (ToolTip = "in cm/s", ClampMin = "0")) float VelocityMax = 150000.0f;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Velocity", meta = (ToolTip = "Distribution bias, higher produces more slow fragments", ClampMin = "0")) float VelocityBias = 1.0f;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Velocity", meta = (ToolTip = "Heavier fragments are slower, blends between random velocity and velocity scaled by mass", ClampMin = "0", ClampMax = "1")) float VelocityMassInfluence = 0.0f;
+};
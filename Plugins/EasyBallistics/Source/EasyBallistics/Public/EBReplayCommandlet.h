@@ -0,0 +1,25 @@
+// Copyright 2020 Mookie. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "EBReplayCommandlet.generated.h"
+
+/*
+Replays a shot log written by FEBShotRecorder against a map and diffs the impacts.
+Usage: -run=EBReplay -Log=<file> -Map=</Game/Maps/Map> [-Step=0.0166] [-Tail=10] [-Tolerance=1]
+Returns non zero when any shot diverged.
+Frame deltas are not recorded and shots are fired on the nearest -Step, so only bullet classes with FixedStep replay
+deterministically. Shots of other classes are still replayed and diffed, but their divergence does not fail the replay.
+*/
+UCLASS()
+class EASYBALLISTICS_API UEBReplayCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UEBReplayCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
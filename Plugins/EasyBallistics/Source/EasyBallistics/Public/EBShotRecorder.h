@@ -0,0 +1,114 @@
+// Copyright 2020 Mookie. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "Containers/Ticker.h"
+#include "Async/Future.h"
+#include <atomic>
+
+class AEBBullet;
+
+//one fired bullet, everything needed to fire it again
+struct EASYBALLISTICS_API FEBShotRecord {
+	uint32 ShotId = 0;
+	uint16 ClassIndex = 0;
+	double Timestamp = 0.0;
+	FVector Location = FVector::ZeroVector;
+	FQuat Rotation = FQuat::Identity;
+	FVector Velocity = FVector::ZeroVector;
+	int32 Seed = 0;
+	float Mass = 0.0f; //fragments get their own
+
+	//environment as seen by GetWind/GetAirDensity/GetSpeedOfSound at the muzzle
+	FVector Wind = FVector::ZeroVector;
+	float AirDensity = 0.0f;
+	float SpeedOfSound = 0.0f;
+
+	friend FArchive& operator<<(FArchive& Ar, FEBShotRecord& Record);
+};
+
+struct EASYBALLISTICS_API FEBImpactRecord {
+	enum EFlags : uint8 {
+		Ricochet = 1,
+		Penetration = 2,
+	};
+
+	uint32 ShotId = 0;
+	uint8 Flags = 0;
+	double Timestamp = 0.0;
+	FVector Location = FVector::ZeroVector;
+	FVector IncomingVelocity = FVector::ZeroVector;
+	FVector ExitVelocity = FVector::ZeroVector;
+
+	friend FArchive& operator<<(FArchive& Ar, FEBImpactRecord& Record);
+};
+
+//contents of a recorded session, loaded in one go
+struct EASYBALLISTICS_API FEBShotLog {
+	TArray<FString> Classes;
+	TArray<FEBShotRecord> Shots;
+	TArray<FEBImpactRecord> Impacts;
+
+	bool Load(const FString& FileName);
+};
+
+/*
+Records every bullet fired into a compact binary log, for replay with the EBReplay commandlet.
+Start with "eb.Record.Start [FileName]" or the -EBRecordShots command line switch, stop with "eb.Record.Stop".
+
+Game thread only pushes into a lock-free queue, file writes happen on a pooled thread.
+*/
+class EASYBALLISTICS_API FEBShotRecorder {
+public:
+	static FEBShotRecorder& Get();
+
+	bool Start(const FString& FileName = FString());
+	void Stop();
+
+	inline bool IsRecording() const { return Recording.load(std::memory_order_relaxed); }
+
+	//returns id the bullet should tag its impacts with, or 0 when not recording
+	uint32 RecordShot(const AEBBullet* Bullet, const FTransform& Muzzle, const FVector& Velocity);
+	void RecordImpact(uint32 ShotId, double Timestamp, const FVector& Location, const FVector& IncomingVelocity, const FVector& ExitVelocity, bool Ricochet, bool Penetration);
+
+	//redirect impacts into an array instead of the log, used by replay
+	void SetImpactCapture(TArray<FEBImpactRecord>* InCapture) { ImpactCapture = InCapture; }
+
+	static const uint32 FileMagic = 0x43524245; //EBRC
+	static const uint32 FileVersion = 2;
+
+	enum class EEntryType : uint8 {
+		Class = 0,
+		Shot = 1,
+		Impact = 2,
+	};
+
+private:
+	struct FEntry {
+		EEntryType Type;
+		FString ClassPath;
+		FEBShotRecord Shot;
+		FEBImpactRecord Impact;
+	};
+
+	void Enqueue(FEntry&& Entry);
+	void KickFlush();
+	void Flush();
+	bool Tick(float DeltaTime);
+
+	std::atomic<bool> Recording{ false };
+	std::atomic<bool> FlushInFlight{ false };
+	std::atomic<int32> Pending{ 0 };
+	std::atomic<uint32> NextShotId{ 1 };
+
+	TQueue<FEntry, EQueueMode::Mpsc> Queue;
+	TUniquePtr<FArchive> Writer;
+	TFuture<void> FlushTask;
+	FTSTicker::FDelegateHandle TickHandle;
+
+	//game thread only
+	TMap<const UClass*, uint16> ClassIndices;
+	TArray<FEBImpactRecord>* ImpactCapture = nullptr;
+};
@@ -0,0 +1,31 @@
+// Copyright 2016 Mookie. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+//use "stat EasyBallistics" in console, stages also show up in Insights as cpu scopes
+DECLARE_STATS_GROUP(TEXT("EasyBallistics"), STATGROUP_EasyBallistics, STATCAT_Advanced);
+
+//timings
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Bullet Step"), STAT_EBBulletStep, STATGROUP_EasyBallistics, EASYBALLISTICS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Bullet Trace"), STAT_EBBulletTrace, STATGROUP_EasyBallistics, EASYBALLISTICS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Bullet Swept Target Trace"), STAT_EBBulletSweptTargetTrace, STATGROUP_EasyBallistics, EASYBALLISTICS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Bullet Penetration Trace"), STAT_EBBulletPenetrationTrace, STATGROUP_EasyBallistics, EASYBALLISTICS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Bullet Update Velocity"), STAT_EBBulletUpdateVelocity, STATGROUP_EasyBallistics, EASYBALLISTICS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Bullet Get From Pool"), STAT_EBBulletGetFromPool, STATGROUP_EasyBallistics, EASYBALLISTICS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Fragment Batch"), STAT_EBFragmentBatch, STATGROUP_EasyBallistics, EASYBALLISTICS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Tracer Update"), STAT_EBTracerUpdate, STATGROUP_EasyBallistics, EASYBALLISTICS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Barrel Tick"), STAT_EBBarrelTick, STATGROUP_EasyBallistics, EASYBALLISTICS_API);
+
+//live bullets persists between frames, everything else is reset every frame
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Live Bullets"), STAT_EBLiveBullets, STATGROUP_EasyBallistics, EASYBALLISTICS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Traces"), STAT_EBTraces, STATGROUP_EasyBallistics, EASYBALLISTICS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Penetration Traces"), STAT_EBPenetrationTraces, STATGROUP_EasyBallistics, EASYBALLISTICS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Ricochets"), STAT_EBRicochets, STATGROUP_EasyBallistics, EASYBALLISTICS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Pool Hits"), STAT_EBPoolHits, STATGROUP_EasyBallistics, EASYBALLISTICS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Pool Misses"), STAT_EBPoolMisses, STATGROUP_EasyBallistics, EASYBALLISTICS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Fragments"), STAT_EBFragments, STATGROUP_EasyBallistics, EASYBALLISTICS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("RPCs Sent"), STAT_EBRPCsSent, STATGROUP_EasyBallistics, EASYBALLISTICS_API);
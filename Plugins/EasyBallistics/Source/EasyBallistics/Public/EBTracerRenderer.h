@@ -0,0 +1,42 @@
+// Copyright 2020 Mookie. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "EBTracerRenderer.generated.h"
+
+class AEBBullet;
+
+/*
+Draws all live bullets sharing tracer mesh and material with one instanced mesh component.
+Spawned on demand per world, bullets with InstancedTracer register themselves while active.
+*/
+UCLASS(NotBlueprintable, NotPlaceable, Transient)
+class EASYBALLISTICS_API AEBTracerRenderer : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AEBTracerRenderer();
+
+	virtual void Tick(float DeltaSeconds) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	static void Register(AEBBullet* Bullet);
+	static void Unregister(AEBBullet* Bullet);
+
+	UPROPERTY(VisibleAnywhere, Category = "Tracer") UInstancedStaticMeshComponent* Instances;
+
+private:
+	static AEBTracerRenderer* FindOrSpawn(UWorld* World, UStaticMesh* Mesh, UMaterialInterface* Material);
+
+	UPROPERTY() TArray<TWeakObjectPtr<AEBTracerRenderer>> Renderers; //only used on default object
+	UPROPERTY() UStaticMesh* Mesh;
+	UPROPERTY() UMaterialInterface* Material;
+
+	TArray<AEBBullet*> Bullets;
+	TArray<FTransform> Transforms;
+	int32 InstanceCount = 0;
+};
@@ -3,6 +3,8 @@
 #include "DynamicMeshSculptTool.h"
 #include "Containers/Map.h"
 #include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
 #include "InteractiveToolManager.h"
 #include "InteractiveGizmoManager.h"
 #include "ToolBuilderUtil.h"
@@ -29,6 +31,7 @@
 #include "Generators/SphereGenerator.h"
 
 #include "Sculpting/KelvinletBrushOp.h"
+#include "Sculpting/MeshSculptUtil.h"
 
 #include "InteractiveGizmoManager.h"
 #include "BaseGizmos/GizmoComponents.h"
@@ -51,6 +54,14 @@ namespace
 #else
 	static EAsyncExecution DynamicSculptToolAsyncExecTarget = EAsyncExecution::ThreadPool;
 #endif
+
+	static TAutoConsoleVariable<float> CVarDynamicSculptStampFrameBudgetMs(
+		TEXT("modeling.Sculpting.StampFrameBudgetMs"),
+		8.0f,
+		TEXT("Game thread time per frame (in milliseconds) that the dynamic mesh sculpt tool may spend applying brush stamps. Stamps that cost more than this are spread over multiple ticks."));
+
+	// upper bound on ticks skipped between stamps, so very large meshes still receive a stamp regularly
+	static constexpr int32 MaxStampTicksToSkip = 4;
 }
 
 
@@ -141,8 +152,9 @@ void UDynamicMeshSculptTool::Setup()
 
 	// initialize target mesh
 	UpdateTarget();
-	bTargetDirty = false;
 	PendingTargetUpdate.Wait();
+	SwapTargetIfReady();
+	bTargetDirty = false;
 
 	// initialize brush radius range interval, brush properties
 	FAxisAlignedBox3d Bounds = DynamicMeshComponent->GetMesh()->GetBounds(true);
@@ -285,6 +297,8 @@ void UDynamicMeshSculptTool::Setup()
 	}
 
 	UpdateBrushType(SculptProperties->PrimaryBrushType);
+
+	StrokeRecorder.BeginRecording(this, CurTargetTransform, DynamicMeshComponent->GetMesh()->GetBounds(true));
 }
 
 void UDynamicMeshSculptTool::Shutdown(EToolShutdownType ShutdownType)
@@ -295,6 +309,11 @@ void UDynamicMeshSculptTool::Shutdown(EToolShutdownType ShutdownType)
 		ShutdownType = EToolShutdownType::Cancel;
 	}
 
+	WaitForStampWork();
+	PendingTargetUpdate.Wait();
+
+	StrokeRecorder.EndRecording();
+
 	BrushIndicatorMesh->Disconnect();
 	BrushIndicatorMesh = nullptr;
 
@@ -340,6 +359,10 @@ void UDynamicMeshSculptTool::OnDynamicMeshComponentChanged()
 {
 	bNormalUpdatePending = true;
 	bTargetDirty = true;
+
+	// we don't know which vertices were changed (eg by undo/redo)
+	BrushTargets[0].bNeedsFullUpdate = true;
+	BrushTargets[1].bNeedsFullUpdate = true;
 }
 
 void UDynamicMeshSculptTool::OnPropertyModified(UObject* PropertySet, FProperty* Property)
@@ -388,10 +411,13 @@ void UDynamicMeshSculptTool::OnBeginDrag(const FRay& Ray)
 {
 	bSmoothing = GetShiftToggle();
 	bInvert = GetCtrlToggle();
+	StrokeRecorder.GetReplayCameraState(CameraState);
 
 	FHitResult OutHit;
 	if (HitTest(Ray, OutHit))
 	{
+		StrokeRecorder.RecordBeginDrag(Ray, this, CameraState, bSmoothing, bInvert);
+
 		BrushStartCenterWorld = (FVector3d)Ray.PointAt(OutHit.Distance) + (double)BrushProperties->Depth*CurrentBrushRadius*(FVector3d)Ray.Direction;
 
 		bInDrag = true;
@@ -421,69 +447,51 @@ void UDynamicMeshSculptTool::OnBeginDrag(const FRay& Ray)
 		// apply initial stamp
 		PendingStampRay = Ray;
 		bStampPending = true;
+		PendingStrokeSampleRays.Reset();
+		LastStrokeInputRay = Ray;
 	}
 }
 
 
 void UDynamicMeshSculptTool::UpdateROI(const FVector3d& BrushPos)
 {
-	TRACE_CPUPROFILER_EVENT_SCOPE(DynamicMeshSculptTool_UpdateROI);
-
-	float RadiusSqr = CurrentBrushRadius * CurrentBrushRadius;
+	UpdateROI(MakeArrayView(&BrushPos, 1));
+}
 
-	FAxisAlignedBox3d BrushBox(
-		BrushPos - CurrentBrushRadius * FVector3d::One(),
-		BrushPos + CurrentBrushRadius * FVector3d::One());
+void UDynamicMeshSculptTool::UpdateROI(TArrayView<const FVector3d> BrushPositions)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(DynamicMeshSculptTool_UpdateROI);
+	UE::SculptUtil::FScopedSculptStampTimer StageTimer(UE::SculptUtil::ESculptStampStage::UpdateROI);
 
 	FDynamicMesh3* Mesh = DynamicMeshComponent->GetMesh();
 	FDynamicMeshOctree3* Octree = DynamicMeshComponent->GetOctree();
 
-	// find set of triangles in brush bounding box
+	// find set of triangles in the bounding box of each brush stamp (may contain duplicates)
 	UpdateROITriBuffer.Reset();
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE(DynamicMeshSculptTool_UpdateROI_1RangeQuery);
-		Octree->ParallelRangeQuery(BrushBox, UpdateROITriBuffer);
+		for (const FVector3d& BrushPos : BrushPositions)
+		{
+			FAxisAlignedBox3d BrushBox(
+				BrushPos - CurrentBrushRadius * FVector3d::One(),
+				BrushPos + CurrentBrushRadius * FVector3d::One());
+			UpdateROIStampTriBuffer.Reset();
+			Octree->ParallelRangeQuery(BrushBox, UpdateROIStampTriBuffer);
+			UpdateROITriBuffer.Append(UpdateROIStampTriBuffer);
+		}
 	}
 
-	// collect set of vertices inside brush sphere, from that box
-	VertexROIBuilder.Initialize(Mesh->MaxVertexID());
+	// collect set of vertices inside the brush spheres from those boxes, and the full one-rings of those vertices as the triangle ROI
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE(DynamicMeshSculptTool_UpdateROI_2Collect);
-		for (int32 TriIdx : UpdateROITriBuffer)
-		{
-			FIndex3i TriV = Mesh->GetTriangle(TriIdx);
-			for (int j = 0; j < 3; ++j)
-			{
-				if (VertexROIBuilder.Contains(TriV[j]) == false)
-				{
-					//const FVector3d& Position = Mesh->GetVertexRef(TriV[j]);
-					FVector3d Position = Mesh->GetVertex(TriV[j]);
-					if (DistanceSquared(BrushPos, Position) < RadiusSqr)
-					{
-						VertexROIBuilder.Add(TriV[j]);
-					}
-				}
-			}
-		}
-		VertexROI.Reset();
-		VertexROIBuilder.SwapValuesWith(VertexROI);
+		UE::SculptUtil::CollectBrushROIParallel(Mesh, UpdateROITriBuffer, BrushPositions, CurrentBrushRadius,
+			VertexROIFlags, TriangleROIFlags, VertexROI, TriangleROIArray);
 	}
 
-	// find triangle ROI as full one-rings of all vertices (this is surprisingly expensive...)
 	{
-		TRACE_CPUPROFILER_EVENT_SCOPE(DynamicMeshSculptTool_UpdateROI_3TriangleROI);
-		TriangleROIBuilder.Initialize(Mesh->MaxTriangleID());
-		for (int32 vid : VertexROI)
-		{
-			Mesh->EnumerateVertexEdges(vid, [&](int32 eid)
-			{
-				FDynamicMesh3::FEdge Edge = Mesh->GetEdge(eid);
-				TriangleROIBuilder.Add(Edge.Tri.A);
-				if (Edge.Tri.B != IndexConstants::InvalidID) TriangleROIBuilder.Add(Edge.Tri.B);
-			});
-		}
+		TRACE_CPUPROFILER_EVENT_SCOPE(DynamicMeshSculptTool_UpdateROI_3TriangleSet);
 		TriangleROI.Reset();
-		TriangleROIBuilder.Collect(TriangleROI);
+		TriangleROI.Append(TriangleROIArray);
 	}
 }
 
@@ -491,19 +499,84 @@ void UDynamicMeshSculptTool::OnUpdateDrag(const FRay& WorldRay)
 {
 	if (bInDrag)
 	{
+		StrokeRecorder.RecordUpdateDrag(WorldRay);
+
 		PendingStampRay = WorldRay;
 		bStampPending = true;
+		AddStrokeInputRay(WorldRay);
 	}
 }
 
+
+void UDynamicMeshSculptTool::AddStrokeInputRay(const FRay& WorldRay)
+{
+	// a single input segment is not subdivided further than this...
+	constexpr int32 MaxSamplesPerInputRay = 16;
+	// ...and if stamps fall behind (eg while skipping ticks to stay in the frame budget), the oldest samples are dropped
+	constexpr int32 MaxPendingSamples = 64;
+
+	// measure spacing at the depth of the current brush position
+	double BrushDepth = (LastBrushPosWorld - (FVector3d)LastStrokeInputRay.Origin).Dot((FVector3d)LastStrokeInputRay.Direction);
+	UE::SculptUtil::ResampleStrokeRays(LastStrokeInputRay, WorldRay, FMathd::Max(BrushDepth, 0.0),
+		UE::SculptUtil::GetContinuousStrokeSampleSpacing(CurrentBrushRadius), MaxSamplesPerInputRay, PendingStrokeSampleRays);
+	LastStrokeInputRay = WorldRay;
+
+	if (PendingStrokeSampleRays.Num() > MaxPendingSamples)
+	{
+		PendingStrokeSampleRays.RemoveAt(0, PendingStrokeSampleRays.Num() - MaxPendingSamples, false);
+	}
+}
+
+
+void UDynamicMeshSculptTool::CollectStampBatch()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(DynamicMeshSculptTool_CollectStampBatch);
+
+	StampRayBatch.Reset();
+	StampBatchPositions.Reset();
+
+	// without new stroke input we keep stamping at the last position
+	if (PendingStrokeSampleRays.Num() == 0)
+	{
+		UpdateBrushPosition(PendingStampRay);
+		StampRayBatch.Add(PendingStampRay);
+		StampBatchPositions.Add(CurTargetTransform.InverseTransformPosition(LastBrushPosWorld));
+		return;
+	}
+
+	// Consume resampled stroke rays in order. The ROI of the batch is found from these positions before any stamp of
+	// the batch is applied, so later stamps in a batch only move the vertices that were inside the brush before the
+	// earlier stamps changed the mesh. To keep that approximation small, a batch only holds stamps within one brush
+	// radius of its first stamp, ie stamps that mostly cover the same vertices, and at most MaxDynamicStampsPerBatch
+	// of them. A ray whose stamp is further away is left for the next batch.
+	constexpr int32 MaxDynamicStampsPerBatch = 4;
+	const int32 MaxStamps = FMath::Min(UE::SculptUtil::GetMaxStampsPerBatch(), MaxDynamicStampsPerBatch);
+	int32 NumConsumed = 0;
+	while (NumConsumed < PendingStrokeSampleRays.Num() && StampRayBatch.Num() < MaxStamps)
+	{
+		const FRay& SampleRay = PendingStrokeSampleRays[NumConsumed];
+		UpdateBrushPosition(SampleRay);
+		FVector3d BrushPos = CurTargetTransform.InverseTransformPosition(LastBrushPosWorld);
+		if (StampBatchPositions.Num() > 0 && Distance(BrushPos, StampBatchPositions[0]) > CurrentBrushRadius)
+		{
+			break;
+		}
+		StampRayBatch.Add(SampleRay);
+		StampBatchPositions.Add(BrushPos);
+		NumConsumed++;
+	}
+	PendingStrokeSampleRays.RemoveAt(0, NumConsumed, false);
+}
+
 void UDynamicMeshSculptTool::CalculateBrushRadius()
 {
 	CurrentBrushRadius = BrushProperties->BrushSize.GetWorldRadius();
 }
 
-void UDynamicMeshSculptTool::ApplyStamp(const FRay& WorldRay)
+bool UDynamicMeshSculptTool::ApplyStamp(TArrayView<const FRay> WorldRays)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(DynamicMeshSculptTool_ApplyStamp);
+	UE::SculptUtil::FScopedSculptStampTimer StageTimer(UE::SculptUtil::ESculptStampStage::ApplyStamp);
 
 	FDynamicMesh3* Mesh = DynamicMeshComponent->GetMesh();
 	FDynamicMeshOctree3* Octree = DynamicMeshComponent->GetOctree();
@@ -550,80 +623,99 @@ void UDynamicMeshSculptTool::ApplyStamp(const FRay& WorldRay)
 	EDynamicMeshSculptBrushType ApplyBrushType = (bSmoothing) ?
 		EDynamicMeshSculptBrushType::Smooth : SculptProperties->PrimaryBrushType;
 
+	// Apply the stamps in sequence, over the combined ROI of the batch. Each brush function computes
+	// new positions for the ROI from the current mesh, so later stamps build on the earlier ones. The ROI itself is
+	// not recomputed between stamps, see CollectStampBatch() for how batches are kept small enough for that.
 	bool bBrushApplied = false;
-	switch (ApplyBrushType)
+	TFuture<void> OctreeRemoveFuture;
+	for (int32 StampIndex = 0; StampIndex < WorldRays.Num(); ++StampIndex)
 	{
-		case EDynamicMeshSculptBrushType::Offset:
-			bBrushApplied = ApplyOffsetBrush(WorldRay, false);
-			break;
-		case EDynamicMeshSculptBrushType::SculptView:
-			bBrushApplied = ApplyOffsetBrush(WorldRay, true);
-			break;
-		case EDynamicMeshSculptBrushType::SculptMax:
-			bBrushApplied = ApplySculptMaxBrush(WorldRay);
-			break;
-		case EDynamicMeshSculptBrushType::Move:
-			bBrushApplied = ApplyMoveBrush(WorldRay);
-			break;
-		case EDynamicMeshSculptBrushType::PullKelvin:
-			bBrushApplied = ApplyPullKelvinBrush(WorldRay);
-			break;
-		case EDynamicMeshSculptBrushType::PullSharpKelvin:
-			bBrushApplied = ApplyPullSharpKelvinBrush(WorldRay);
-			break;
-		case EDynamicMeshSculptBrushType::Smooth:
-			bBrushApplied = ApplySmoothBrush(WorldRay);
-			break;
-		case EDynamicMeshSculptBrushType::Pinch:
-			bBrushApplied = ApplyPinchBrush(WorldRay);
-			break;
-		case EDynamicMeshSculptBrushType::TwistKelvin:
-			bBrushApplied = ApplyTwistKelvinBrush(WorldRay);
-			break;
-		case EDynamicMeshSculptBrushType::Inflate:
-			bBrushApplied = ApplyInflateBrush(WorldRay);
-			break;
-		case EDynamicMeshSculptBrushType::ScaleKelvin:
-			bBrushApplied = ApplyScaleKelvinBrush(WorldRay);
-			break;
-		case EDynamicMeshSculptBrushType::Flatten:
-			bBrushApplied = ApplyFlattenBrush(WorldRay);
-			break;
-		case EDynamicMeshSculptBrushType::Plane:
-			bBrushApplied = ApplyPlaneBrush(WorldRay);
-			break;
-		case EDynamicMeshSculptBrushType::PlaneViewAligned:
-			bBrushApplied = ApplyPlaneBrush(WorldRay);
-			break;
-		case EDynamicMeshSculptBrushType::FixedPlane:
-			bBrushApplied = ApplyFixedPlaneBrush(WorldRay);
-			break;
-		case EDynamicMeshSculptBrushType::Resample:
-			bBrushApplied = ApplyResampleBrush(WorldRay);
-			break;
-		case EDynamicMeshSculptBrushType::LastValue:
-			break;
-	}
+		const FRay& WorldRay = WorldRays[StampIndex];
+
+		bool bStampApplied = false;
+		switch (ApplyBrushType)
+		{
+			case EDynamicMeshSculptBrushType::Offset:
+				bStampApplied = ApplyOffsetBrush(WorldRay, false);
+				break;
+			case EDynamicMeshSculptBrushType::SculptView:
+				bStampApplied = ApplyOffsetBrush(WorldRay, true);
+				break;
+			case EDynamicMeshSculptBrushType::SculptMax:
+				bStampApplied = ApplySculptMaxBrush(WorldRay);
+				break;
+			case EDynamicMeshSculptBrushType::Move:
+				bStampApplied = ApplyMoveBrush(WorldRay);
+				break;
+			case EDynamicMeshSculptBrushType::PullKelvin:
+				bStampApplied = ApplyPullKelvinBrush(WorldRay);
+				break;
+			case EDynamicMeshSculptBrushType::PullSharpKelvin:
+				bStampApplied = ApplyPullSharpKelvinBrush(WorldRay);
+				break;
+			case EDynamicMeshSculptBrushType::Smooth:
+				bStampApplied = ApplySmoothBrush(WorldRay);
+				break;
+			case EDynamicMeshSculptBrushType::Pinch:
+				bStampApplied = ApplyPinchBrush(WorldRay);
+				break;
+			case EDynamicMeshSculptBrushType::TwistKelvin:
+				bStampApplied = ApplyTwistKelvinBrush(WorldRay);
+				break;
+			case EDynamicMeshSculptBrushType::Inflate:
+				bStampApplied = ApplyInflateBrush(WorldRay);
+				break;
+			case EDynamicMeshSculptBrushType::ScaleKelvin:
+				bStampApplied = ApplyScaleKelvinBrush(WorldRay);
+				break;
+			case EDynamicMeshSculptBrushType::Flatten:
+				bStampApplied = ApplyFlattenBrush(WorldRay);
+				break;
+			case EDynamicMeshSculptBrushType::Plane:
+				bStampApplied = ApplyPlaneBrush(WorldRay);
+				break;
+			case EDynamicMeshSculptBrushType::PlaneViewAligned:
+				bStampApplied = ApplyPlaneBrush(WorldRay);
+				break;
+			case EDynamicMeshSculptBrushType::FixedPlane:
+				bStampApplied = ApplyFixedPlaneBrush(WorldRay);
+				break;
+			case EDynamicMeshSculptBrushType::Resample:
+				bStampApplied = ApplyResampleBrush(WorldRay);
+				break;
+			case EDynamicMeshSculptBrushType::LastValue:
+				break;
+		}
 
-	// wait for ROI to finish saving before we update positions
-	SaveROIFuture.Wait();
-	DirtyOctreeFuture.Wait();
+		// wait for ROI to finish saving before we update positions
+		if (StampIndex == 0)
+		{
+			SaveROIFuture.Wait();
+			DirtyOctreeFuture.Wait();
+		}
 
-	// we are going to reinsert these later
-	TFuture<void> OctreeRemoveFuture = Async(DynamicSculptToolAsyncExecTarget, [&]()
-	{
-		TRACE_CPUPROFILER_EVENT_SCOPE(DynamicMeshSculptTool_ApplyStamp_OctreeRemove);
-		Octree->RemoveTriangles(TriangleROI, false);	// already marked dirty above
-	});
+		// we are going to reinsert these later. Brush functions may hit-test the ROI, so only remove them once the last stamp has its position
+		if (StampIndex == WorldRays.Num() - 1)
+		{
+			OctreeRemoveFuture = Async(DynamicSculptToolAsyncExecTarget, [&]()
+			{
+				TRACE_CPUPROFILER_EVENT_SCOPE(DynamicMeshSculptTool_ApplyStamp_OctreeRemove);
+				Octree->RemoveTriangles(TriangleROI, false);	// already marked dirty above
+			});
+		}
 
-	// Update the mesh positions to match those in the position buffer
-	if (bBrushApplied)
-	{
-		SyncMeshWithPositionBuffer(Mesh);
+		// Update the mesh positions to match those in the position buffer
+		if (bStampApplied)
+		{
+			SyncMeshWithPositionBuffer(Mesh);
+			bBrushApplied = true;
+		}
 	}
 
 	// we don't stricty have to wait here, we could return this future
 	OctreeRemoveFuture.Wait();
+
+	return bBrushApplied;
 }
 
 double UDynamicMeshSculptTool::CalculateBrushFalloff(double Distance)
@@ -1254,6 +1346,9 @@ bool UDynamicMeshSculptTool::IsHitTriangleBackFacing(int32 TriangleID, const FDy
 
 int UDynamicMeshSculptTool::FindHitSculptMeshTriangle(const FRay3d& LocalRay)
 {
+	// octree may still be updating from the last stamp
+	WaitForStampWork();
+
 	int32 HitTID = DynamicMeshComponent->GetOctree()->FindNearestHitObject(LocalRay);
 	if (BrushProperties->bHitBackFaces == false && IsHitTriangleBackFacing(HitTID, DynamicMeshComponent->GetMesh()) )
 	{
@@ -1264,10 +1359,9 @@ int UDynamicMeshSculptTool::FindHitSculptMeshTriangle(const FRay3d& LocalRay)
 
 int UDynamicMeshSculptTool::FindHitTargetMeshTriangle(const FRay3d& LocalRay)
 {
-	PendingTargetUpdate.Wait();
-
-	int32 HitTID = BrushTargetMeshSpatial.FindNearestHitTriangle(LocalRay);
-	if (BrushProperties->bHitBackFaces == false && IsHitTriangleBackFacing(HitTID, &BrushTargetMesh))
+	const FBrushTarget& Target = GetBrushTarget();
+	int32 HitTID = Target.Spatial.FindNearestHitTriangle(LocalRay);
+	if (BrushProperties->bHitBackFaces == false && IsHitTriangleBackFacing(HitTID, &Target.Mesh))
 	{
 		HitTID = IndexConstants::InvalidID;
 	}
@@ -1285,13 +1379,11 @@ bool UDynamicMeshSculptTool::UpdateBrushPositionOnActivePlane(const FRay& WorldR
 
 bool UDynamicMeshSculptTool::UpdateBrushPositionOnTargetMesh(const FRay& WorldRay, bool bFallbackToViewPlane)
 {
-	PendingTargetUpdate.Wait();
-
 	FRay3d LocalRay(CurTargetTransform.InverseTransformPosition((FVector3d)WorldRay.Origin),
 		CurTargetTransform.InverseTransformVector((FVector3d)WorldRay.Direction));
 	UE::Geometry::Normalize(LocalRay.Direction);
 
-	const FDynamicMesh3* TargetMesh = BrushTargetMeshSpatial.GetMesh();
+	const FDynamicMesh3* TargetMesh = &GetBrushTarget().Mesh;
 
 	int HitTID = FindHitTargetMeshTriangle(LocalRay);
 	if (HitTID != IndexConstants::InvalidID)
@@ -1412,8 +1504,21 @@ bool UDynamicMeshSculptTool::UpdateBrushPosition(const FRay& WorldRay)
 
 void UDynamicMeshSculptTool::OnEndDrag(const FRay& Ray)
 {
+	StrokeRecorder.RecordEndDrag(Ray);
+
+	// stamp the stroke samples that have not been consumed yet, otherwise the end of a fast stroke is lost.
+	// This has to happen while still in the drag, remeshing is only allowed inside the change record
+	while (PendingStrokeSampleRays.Num() > 0)
+	{
+		WaitForStampWork();
+		ApplyStampBatch();
+	}
+
 	bInDrag = false;
 
+	// stamp work reads the ROI and writes normals, it must be done before the change record is closed
+	WaitForStampWork();
+
 	// cancel these! otherwise change record could become invalid
 	bStampPending = false;
 	bRemeshPending = false;
@@ -1497,16 +1602,9 @@ void UDynamicMeshSculptTool::OnTick(float DeltaTime)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(DynamicMeshSculptTool_OnTick);
 
-	ActivePressure = GetCurrentDevicePressure();
-
-	// Allow a tick to pass between application of brush stamps. If we do not do this then on large stamps
-	// that take a significant fraction of a second to compute, frames will be skipped and the editor will appear
-	// frozen, but when the user releases the mouse, sculpting has clearly happened
-	static int TICK_SKIP_HACK = 0;
-	if (TICK_SKIP_HACK++ % 2 == 0)
-	{
-		return;
-	}
+	StrokeRecorder.GetReplayCameraState(CameraState);
+	ActivePressure = StrokeRecorder.GetPressure(GetCurrentDevicePressure());
+	StrokeRecorder.RecordTick(DeltaTime, (float)ActivePressure);
 
 	ShowWireframeWatcher.CheckAndUpdate();
 	MaterialModeWatcher.CheckAndUpdate();
@@ -1549,159 +1647,277 @@ void UDynamicMeshSculptTool::OnTick(float DeltaTime)
 		PendingWorkPlaneUpdate = EPendingWorkPlaneUpdate::NoUpdatePending;
 	}
 
+	// pick up finished target update
+	SwapTargetIfReady();
+
 	// if user changed to not-frozen, we need to update the target
 	if (bCachedFreezeTarget != SculptProperties->bFreezeTarget)
 	{
-		UpdateTarget();
-		PendingTargetUpdate.Wait();
+		bTargetDirty = true;
 	}
 
 	bool bMeshModified = false;
-	bool bMeshShapeModified = false;
 
 	FDynamicMesh3* Mesh = DynamicMeshComponent->GetMesh();
-	FDynamicMeshOctree3* Octree = DynamicMeshComponent->GetOctree();
 
-	//Octree->CheckValidity(EValidityCheckFailMode::Check, false, true);
+	// finish the previous stamp. Its octree reinsert and normals have been running while the last frame was drawn,
+	// and the render data has to be updated before the next stamp modifies the mesh again
+	WaitForStampWork();
+	if (bStampRenderUpdatePending)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(DynamicMeshSculptTool_UpdateRenderMesh);
+		UE::SculptUtil::FScopedSculptStampTimer StageTimer(UE::SculptUtil::ESculptStampStage::RenderUpdate);
+		DynamicMeshComponent->NotifyMeshUpdated();
+		GetToolManager()->PostInvalidation();
+		bStampRenderUpdatePending = false;
+	}
+	if (UE::SculptUtil::FSculptStampTimings* StampTimings = UE::SculptUtil::FSculptStampTimings::GetActive())
+	{
+		StampTimings->EndStamp();
+	}
 
 	//
 	// Apply stamp
 	//
 
+	// On large meshes a stamp can take a significant fraction of a frame (or more). Skip stamps on enough ticks that the
+	// measured stamp cost stays within the frame budget, otherwise the editor appears frozen while sculpting. Small
+	// meshes stay under the budget and get a stamp every tick. A replay must not depend on timing, so it never skips.
+	bool bApplyStampThisTick = bStampPending;
+	if (bStampPending && StampTicksToSkip > 0 && StrokeRecorder.IsReplaying() == false)
+	{
+		StampTicksToSkip--;
+		bApplyStampThisTick = false;
+	}
+
+	if (bApplyStampThisTick)
+	{
+		ApplyStampBatch();
+	}
+	check(bRemeshPending == false);		// should never happen...
+
+	if (bNormalUpdatePending)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(DynamicMeshSculptTool_UpdateNormals);
+		UE::SculptUtil::FScopedSculptStampTimer StageTimer(UE::SculptUtil::ESculptStampStage::Normals);
+
+		if (Mesh->HasAttributes() && Mesh->Attributes()->PrimaryNormals() != nullptr)
+		{
+			RecalculateNormals_Overlay(TriangleROI);
+		}
+		else
+		{
+			RecalculateNormals_PerVertex(TriangleROI);
+		}
+		bNormalUpdatePending = false;
+		bMeshModified = true;
+	}
+
+	// launch async target update task
+	if (bTargetDirty)
+	{
+		bTargetDirty = (UpdateTarget() == false);
+	}
+
+	// a replay must not depend on when the target update happens to finish
+	if (StrokeRecorder.IsReplaying())
+	{
+		PendingTargetUpdate.Wait();
+		SwapTargetIfReady();
+	}
+
+	// update render data
+	if (bMeshModified)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(DynamicMeshSculptTool_UpdateRenderMesh);
+		UE::SculptUtil::FScopedSculptStampTimer StageTimer(UE::SculptUtil::ESculptStampStage::RenderUpdate);
+		DynamicMeshComponent->NotifyMeshUpdated();
+		GetToolManager()->PostInvalidation();
+
+		bMeshModified = false;
+	}
+}
+
+
+void UDynamicMeshSculptTool::ApplyStampBatch()
+{
 	bool bROIUpdatePending = false;
 	bool bOctreeUpdatePending = false;
 
 	TFuture<void> InitializeRemesher;
 	TFuture<void> PrecomputeRemeshROI;
 
-	if (bStampPending)
+	const double StampStartTime = FPlatformTime::Seconds();
+
+	// if we don't have an active remesher for this brush stroke, create one
+	if (ActiveRemesher == nullptr)
 	{
-		// if we don't have an active remesher for this brush stroke, create one
-		if (ActiveRemesher == nullptr)
+		InitializeRemesher = Async(DynamicSculptToolAsyncExecTarget, [&]()
 		{
-			InitializeRemesher = Async(DynamicSculptToolAsyncExecTarget, [&]()
-			{
-				InitializeActiveRemesher();
-			});
-		}
+			InitializeActiveRemesher();
+		});
+	}
 
-		// initialize ROI for current brush position
-		// TODO: does this break move brush??
-		UpdateBrushPosition(PendingStampRay);
-		FVector3d BrushPos = CurTargetTransform.InverseTransformPosition(LastBrushPosWorld);
-		UpdateROI(BrushPos);
+	// initialize ROI for the brush positions of this tick's stamps
+	// TODO: does this break move brush??
+	CollectStampBatch();
+	UpdateROI(StampBatchPositions);
 
 
-		// once we know ROI we can speculatively start initializing remesh ROI
-		PrecomputeRemeshROI = Async(DynamicSculptToolAsyncExecTarget, [&]()
-		{
-			// make sure our remesher is initialized
-			InitializeRemesher.Wait();
-			// initialize the ROI
-			PrecomputeRemesherROI();
-		});
+	// once we know ROI we can speculatively start initializing remesh ROI
+	PrecomputeRemeshROI = Async(DynamicSculptToolAsyncExecTarget, [&]()
+	{
+		// make sure our remesher is initialized
+		InitializeRemesher.Wait();
+		// initialize the ROI
+		PrecomputeRemesherROI();
+	});
 
-		// apply brush stamp to ROI
-		ApplyStamp(PendingStampRay);
-		bStampPending = (bInDrag) ? true : false;
+	// target update may still be reading the sculpt mesh
+	WaitForTargetCopy();
 
-		bNormalUpdatePending = true;
-		bROIUpdatePending = true;
-		bMeshModified = true;
-		bMeshShapeModified = true;
-		bOctreeUpdatePending = true;
+	// apply brush stamp to ROI. ROI triangles are removed from the octree either way and must be reinserted,
+	// but if no vertex moved there is nothing to re-render
+	bool bBrushApplied = ApplyStamp(StampRayBatch);
+	bStampPending = (bInDrag) ? true : false;
+	if (bBrushApplied)
+	{
+		NotifyTargetVerticesModified(VertexROI);
+	}
 
-		if (bRemeshPending)
-		{
-			check(bInDrag == true);    // this would break undo otherwise!
+	bNormalUpdatePending = bBrushApplied;
+	bROIUpdatePending = true;
+	bOctreeUpdatePending = true;
 
-			// make sure our remesher is initialized
-			InitializeRemesher.Wait();
-			// make sure our ROI is computed
-			PrecomputeRemeshROI.Wait();
+	if (bRemeshPending)
+	{
+		check(bInDrag == true);    // this would break undo otherwise!
 
-			// remesh the ROI (this removes all ROI triangles from octree)
-			if (ActiveRemesher)
-			{
-				RemeshROIPass_ActiveRemesher(true);
-			}
-			else
+		// make sure our remesher is initialized
+		InitializeRemesher.Wait();
+		// make sure our ROI is computed
+		PrecomputeRemeshROI.Wait();
+
+		UE::SculptUtil::FScopedSculptStampTimer StageTimer(UE::SculptUtil::ESculptStampStage::Remesh);
+
+		// remesh the ROI (this removes all ROI triangles from octree)
+		if (ActiveRemesher)
+		{
+			RemeshROIPass_ActiveRemesher(true);
+		}
+		else
+		{
+			check(false);		// broken now
+			RemeshROIPass();
+		}
+
+		// accumulate new triangles into TriangleROI, and the vertices the remesher may have moved. Remeshing
+		// can move vertices without changing the topology stamp, in which case the brush targets only copy
+		// the dirty vertices
+		const FDynamicMesh3* Mesh = DynamicMeshComponent->GetMesh();
+		RemeshVertexBuffer.Reset();
+		for (int32 tid : RemeshFinalTriangleROI)
+		{
+			bool bAlreadyInROI = false;
+			TriangleROI.Add(tid, &bAlreadyInROI);
+			if (bAlreadyInROI == false)
 			{
-				check(false);		// broken now
-				RemeshROIPass();
+				TriangleROIArray.Add(tid);
 			}
-
-			// accumulate new triangles into TriangleROI
-			for (int32 tid : RemeshFinalTriangleROI)
+			if (Mesh->IsTriangle(tid))
 			{
-				TriangleROI.Add(tid);
+				const FIndex3i Tri = Mesh->GetTriangle(tid);
+				RemeshVertexBuffer.Append({ Tri.A, Tri.B, Tri.C });
 			}
-
-			bMeshModified = true;
-			bMeshShapeModified = true;
-			bRemeshPending = false;
-			bNormalUpdatePending = true;
-			bROIUpdatePending = true;
-			bOctreeUpdatePending = true;
-			bHaveRemeshed = true;
 		}
+		NotifyTargetVerticesModified(RemeshVertexBuffer);
+
+		bRemeshPending = false;
+		bNormalUpdatePending = true;
+		bROIUpdatePending = true;
+		bOctreeUpdatePending = true;
+		bHaveRemeshed = true;
 	}
-	check(bRemeshPending == false);		// should never happen...
 
-	// launch octree update that inserts/reinserts all triangles in TriangleROI
-	TFuture<void> UpdateOctreeFuture;
+	// Allow futures to finish in case bRemeshPending == false
+	InitializeRemesher.Wait();
+	PrecomputeRemeshROI.Wait();
+
+	// reinsert the new ROI into the octree and recompute normals in the background. The render update for
+	// this stamp happens at the start of the next tick, after the work has finished
 	if (bOctreeUpdatePending)
 	{
-		// reinsert new ROI into octree
-		UpdateOctreeFuture = Async(DynamicSculptToolAsyncExecTarget, [&]() {
-			TRACE_CPUPROFILER_EVENT_SCOPE(DynamicMeshSculptTool_OctreeReinsert);
-			Octree->ReinsertTriangles(TriangleROI);
-			//Octree->CheckValidity(EValidityCheckFailMode::Check, false, true);
-		});
+		LaunchStampWork(FPlatformTime::Seconds() - StampStartTime, bNormalUpdatePending);
 		bOctreeUpdatePending = false;
+		bNormalUpdatePending = false;
 	}
+}
 
-	//Octree->CheckValidity(EValidityCheckFailMode::Check, false, true);
 
-	if (bNormalUpdatePending)
+void UDynamicMeshSculptTool::LaunchStampWork(double GameThreadSeconds, bool bMeshShapeModified)
+{
+	check(PendingStampWork.IsValid() == false);
+
+	StampLaunchGameThreadSeconds = GameThreadSeconds;
+
+	// The octree component splits its render buffers by octree cells and only re-uploads the cells touched since the
+	// last update, which is also how triangles added or removed by the remesher get to the right chunk. So once
+	// TriangleROI is reinserted, the render update for this stamp costs the same regardless of total mesh size.
+	bStampRenderUpdatePending = bMeshShapeModified;
+
+	PendingStampWork = Async(DynamicSculptToolAsyncExecTarget, [this, bMeshShapeModified]()
 	{
-		TRACE_CPUPROFILER_EVENT_SCOPE(DynamicMeshSculptTool_UpdateNormals);
+		FDynamicMesh3* Mesh = DynamicMeshComponent->GetMesh();
+		FDynamicMeshOctree3* Octree = DynamicMeshComponent->GetOctree();
 
-		if (Mesh->HasAttributes() && Mesh->Attributes()->PrimaryNormals() != nullptr)
+		TFuture<void> UpdateOctreeFuture = Async(DynamicSculptToolAsyncExecTarget, [this, Octree]()
 		{
-			RecalculateNormals_Overlay(TriangleROI);
-		}
-		else
+			TRACE_CPUPROFILER_EVENT_SCOPE(DynamicMeshSculptTool_OctreeReinsert);
+			UE::SculptUtil::FScopedSculptStampTimer StageTimer(UE::SculptUtil::ESculptStampStage::OctreeReinsert);
+			// remeshing may have deleted some of the original ROI triangles, those are already gone from the octree
+			const FDynamicMesh3* ConstMesh = DynamicMeshComponent->GetMesh();
+			TriangleROIArray.RemoveAllSwap([ConstMesh](int32 tid) { return ConstMesh->IsTriangle(tid) == false; }, false);
+			Octree->ReinsertTrianglesParallel(TriangleROIArray, OctreeUpdateTempBuffer, OctreeUpdateTempFlagBuffer);
+		});
+
+		if (bMeshShapeModified)
 		{
-			RecalculateNormals_PerVertex(TriangleROI);
+			TRACE_CPUPROFILER_EVENT_SCOPE(DynamicMeshSculptTool_UpdateNormals);
+			UE::SculptUtil::FScopedSculptStampTimer StageTimer(UE::SculptUtil::ESculptStampStage::Normals);
+			if (Mesh->HasAttributes() && Mesh->Attributes()->PrimaryNormals() != nullptr)
+			{
+				RecalculateNormals_Overlay(TriangleROI);
+			}
+			else
+			{
+				RecalculateNormals_PerVertex(TriangleROI);
+			}
 		}
-		bNormalUpdatePending = false;
-		bMeshModified = true;
-	}
 
-	// next steps need to wait for octree update to finish
-	UpdateOctreeFuture.Wait();
+		UpdateOctreeFuture.Wait();
+	});
+}
 
-	// launch async target update task
-	if (bTargetDirty)
+
+void UDynamicMeshSculptTool::WaitForStampWork()
+{
+	if (PendingStampWork.IsValid() == false)
 	{
-		UpdateTarget();
-		bTargetDirty = false;
+		return;
 	}
 
-	// update render data
-	if (bMeshModified)
-	{
-		TRACE_CPUPROFILER_EVENT_SCOPE(DynamicMeshSculptTool_UpdateRenderMesh);
-		DynamicMeshComponent->NotifyMeshUpdated();
-		GetToolManager()->PostInvalidation();
+	TRACE_CPUPROFILER_EVENT_SCOPE(DynamicMeshSculptTool_WaitForStampWork);
 
-		bMeshModified = false;
-	}
+	const double WaitStartTime = FPlatformTime::Seconds();
+	PendingStampWork.Wait();
+	PendingStampWork.Reset();
 
-	// Allow futures to finish in case bRemeshPending == false
-	InitializeRemesher.Wait();
-	PrecomputeRemeshROI.Wait();
+	// game thread cost of a stamp is the synchronous part plus however long we blocked on the background part
+	const double StampCost = StampLaunchGameThreadSeconds + (FPlatformTime::Seconds() - WaitStartTime);
+	StampCostEstimate = (StampCostEstimate > 0) ? FMath::Lerp(StampCostEstimate, StampCost, 0.25) : StampCost;
+
+	const double FrameBudget = FMath::Max((double)CVarDynamicSculptStampFrameBudgetMs.GetValueOnGameThread(), 0.1) / 1000.0;
+	StampTicksToSkip = FMath::Clamp((int32)(StampCostEstimate / FrameBudget), 0, MaxStampTicksToSkip);
 }
 
 void UDynamicMeshSculptTool::PrecomputeRemeshInfo()
@@ -1927,10 +2143,8 @@ void UDynamicMeshSculptTool::RemeshROIPass_ActiveRemesher(bool bHasPrecomputedRO
 
 			if (ActiveMeshChange != nullptr)
 			{
-				// [TODO] would like to only save vertices here, as triangles will be saved by Remesher as necessary.
-				// However currently FDynamicMeshChangeTracker cannot independently save vertices, only vertices 
-				// that are part of saved triangles will be included in the output FDynamicMeshChange
-				Remesher.SaveActiveROI(ActiveMeshChange);
+				// only save vertex positions here, triangles will be saved by Remesher as necessary
+				ActiveMeshChangePositions.SaveTriangleVertices(Mesh, Remesher.GetCurrentTriangleROI());
 				//ActiveMeshChange->VerifySaveState();    // useful for debugging
 			}
 
@@ -1997,10 +2211,8 @@ void UDynamicMeshSculptTool::RemeshROIPass()
 
 			if (ActiveMeshChange != nullptr)
 			{
-				// [TODO] would like to only save vertices here, as triangles will be saved by Remesher as necessary.
-				// However currently FDynamicMeshChangeTracker cannot independently save vertices, only vertices 
-				// that are part of saved triangles will be included in the output FDynamicMeshChange
-				Remesher.SaveActiveROI(ActiveMeshChange);
+				// only save vertex positions here, triangles will be saved by Remesher as necessary
+				ActiveMeshChangePositions.SaveTriangleVertices(Mesh, Remesher.GetCurrentTriangleROI());
 				//ActiveMeshChange->VerifySaveState();    // useful for debugging
 			}
 
@@ -2113,61 +2325,146 @@ void UDynamicMeshSculptTool::RecalculateNormals_Overlay(const TSet<int32>& Trian
 }
 
 
-void UDynamicMeshSculptTool::UpdateTarget()
+bool UDynamicMeshSculptTool::UpdateTarget()
 {
 	if (SculptProperties != nullptr )
 	{
 		bCachedFreezeTarget = SculptProperties->bFreezeTarget;
 		if (SculptProperties->bFreezeTarget)
 		{
-			return;   // do not update frozen target
+			return true;   // do not update frozen target
 		}
 	}
 
-	// Allow any in-progress update to finish before starting a new one
-	PendingTargetUpdate.Wait();
+	// don't wait for an in-progress update, caller will try again later
+	if (PendingTargetUpdate.IsValid())
+	{
+		return false;
+	}
+
+	const FDynamicMesh3* SculptMesh = DynamicMeshComponent->GetMesh();
+	FBrushTarget& Target = BrushTargets[1 - FrontBrushTarget];
 
-	// TODO: could have a second set of target meshes, and swap between them while we update the other one
-	PendingTargetUpdate = Async(DynamicSculptToolAsyncExecTarget, [this]()
+	bool bFullUpdate = Target.bNeedsFullUpdate
+		|| Target.SculptTopologyStamp != SculptMesh->GetTopologyChangeStamp()
+		|| Target.Mesh.MaxVertexID() != SculptMesh->MaxVertexID();
+	TArray<int32> DirtyVertices;
+	if (bFullUpdate == false)
+	{
+		Target.DirtyVertices.GetIndices(DirtyVertices);
+	}
+	Target.DirtyVertices.Reset();
+	Target.bNeedsFullUpdate = false;
+	Target.SculptTopologyStamp = SculptMesh->GetTopologyChangeStamp();
+
+	PendingTargetCopy = Async(DynamicSculptToolAsyncExecTarget, [this, &Target, SculptMesh, bFullUpdate, DirtyVertices]()
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(DynamicMeshSculptTool_UpdateTarget_Copy);
+		if (bFullUpdate)
+		{
+			Target.Mesh.Copy(*SculptMesh, false, false, false, false);
+		}
+		else
+		{
+			for (int32 vid : DirtyVertices)
+			{
+				Target.Mesh.SetVertex(vid, SculptMesh->GetVertex(vid));
+			}
+		}
+	});
+
+	PendingTargetUpdate = Async(DynamicSculptToolAsyncExecTarget, [this, &Target, bFullUpdate, DirtyVertices = MoveTemp(DirtyVertices)]()
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE(DynamicMeshSculptTool_UpdateTarget);
-		BrushTargetMesh.Copy(*DynamicMeshComponent->GetMesh(), false, false, false, false);
+		PendingTargetCopy.Wait();
 
-		TFuture<void> TargetSpatialUpdate = Async(DynamicSculptToolAsyncExecTarget, [this]() {
+		// the AABB tree has no incremental refit, so it is always rebuilt. That is fine as nothing waits for it.
+		TFuture<void> TargetSpatialUpdate = Async(DynamicSculptToolAsyncExecTarget, [&Target]() {
 			TRACE_CPUPROFILER_EVENT_SCOPE(DynamicMeshSculptTool_UpdateTarget_Spatial);
-			BrushTargetMeshSpatial.SetMesh(&BrushTargetMesh, true);
-		});
-		TFuture<void> TargetNormalsUpdate = Async(DynamicSculptToolAsyncExecTarget, [this]() {
-			TRACE_CPUPROFILER_EVENT_SCOPE(DynamicMeshSculptTool_UpdateTarget_Normals);
-			BrushTargetNormals.SetMesh(&BrushTargetMesh);
-			BrushTargetNormals.ComputeVertexNormals();
+			Target.Spatial.SetMesh(&Target.Mesh, true);
 		});
 
+		TRACE_CPUPROFILER_EVENT_SCOPE(DynamicMeshSculptTool_UpdateTarget_Normals);
+		if (bFullUpdate)
+		{
+			Target.Normals.SetMesh(&Target.Mesh);
+			Target.Normals.ComputeVertexNormals();
+		}
+		else
+		{
+			// normals change for the moved vertices and their neighbours
+			Target.NormalsROI.Grow(Target.Mesh.MaxVertexID());
+			for (int32 vid : DirtyVertices)
+			{
+				Target.NormalsROI.Add(vid);
+				Target.Mesh.EnumerateVertexVertices(vid, [&Target](int32 nbrvid) { Target.NormalsROI.Add(nbrvid); });
+			}
+			TArray<int32> NormalsVertices;
+			Target.NormalsROI.GetIndices(NormalsVertices);
+			Target.NormalsROI.Reset();
+			ParallelFor(NormalsVertices.Num(), [&](int32 k)
+			{
+				int32 vid = NormalsVertices[k];
+				Target.Normals[vid] = FMeshNormals::ComputeVertexNormal(Target.Mesh, vid);
+			});
+		}
+
 		TargetSpatialUpdate.Wait();
-		TargetNormalsUpdate.Wait();
 	});
 
+	return true;
+}
+
+
+void UDynamicMeshSculptTool::WaitForTargetCopy()
+{
+	if (PendingTargetCopy.IsValid())
+	{
+		PendingTargetCopy.Wait();
+	}
+}
+
+
+void UDynamicMeshSculptTool::SwapTargetIfReady()
+{
+	if (PendingTargetUpdate.IsValid() && PendingTargetUpdate.IsReady())
+	{
+		PendingTargetUpdate.Reset();
+		PendingTargetCopy.Reset();
+		FrontBrushTarget = 1 - FrontBrushTarget;
+	}
+}
+
+
+void UDynamicMeshSculptTool::NotifyTargetVerticesModified(const TArray<int>& Vertices)
+{
+	int32 MaxVertexID = DynamicMeshComponent->GetMesh()->MaxVertexID();
+	for (FBrushTarget& Target : BrushTargets)
+	{
+		Target.DirtyVertices.Grow(MaxVertexID);
+		Target.DirtyVertices.Add(Vertices);
+	}
 }
 
 bool UDynamicMeshSculptTool::GetTargetMeshNearest(const FVector3d& Position, double SearchRadius, FVector3d& TargetPosOut, FVector3d& TargetNormalOut)
 {
-	PendingTargetUpdate.Wait();
+	const FBrushTarget& Target = GetBrushTarget();
 
 	double fDistSqr;
-	int NearTID = BrushTargetMeshSpatial.FindNearestTriangle(Position, fDistSqr, SearchRadius);
+	int NearTID = Target.Spatial.FindNearestTriangle(Position, fDistSqr, SearchRadius);
 	if (NearTID <= 0)
 	{
 		return false;
 	}
 	FTriangle3d Triangle;
-	BrushTargetMesh.GetTriVertices(NearTID, Triangle.V[0], Triangle.V[1], Triangle.V[2]);
+	Target.Mesh.GetTriVertices(NearTID, Triangle.V[0], Triangle.V[1], Triangle.V[2]);
 	FDistPoint3Triangle3d Query(Position, Triangle);
 	Query.Get();
-	FIndex3i Tri = BrushTargetMesh.GetTriangle(NearTID);
+	FIndex3i Tri = Target.Mesh.GetTriangle(NearTID);
 	TargetNormalOut =
-		Query.TriangleBaryCoords.X*BrushTargetNormals[Tri.A]
-		+ Query.TriangleBaryCoords.Y*BrushTargetNormals[Tri.B]
-		+ Query.TriangleBaryCoords.Z*BrushTargetNormals[Tri.C];
+		Query.TriangleBaryCoords.X*Target.Normals[Tri.A]
+		+ Query.TriangleBaryCoords.Y*Target.Normals[Tri.B]
+		+ Query.TriangleBaryCoords.Z*Target.Normals[Tri.C];
 	UE::Geometry::Normalize(TargetNormalOut);
 	TargetPosOut = Query.ClosestTrianglePoint;
 	return true;
@@ -2393,6 +2690,38 @@ void UDynamicMeshSculptTool::RegisterActions(FInteractiveToolActionSet& ActionSe
 //
 // Change Tracking
 //
+
+/**
+ * Undo record for a remeshing brush stroke. Topology changes are recorded by FDynamicMeshChangeTracker, and vertex
+ * positions separately, so triangles only have to be saved if the remesher modifies them. Topology is always applied
+ * or reverted first, so that the position changes only refer to vertices that exist at that point.
+ */
+class FDynamicSculptStrokeChange : public FToolCommandChange
+{
+public:
+	TUniquePtr<FMeshChange> TopologyChange;
+	TUniquePtr<FMeshVertexChange> RevertPositions;		// vertices that existed before the stroke, at their initial positions
+	TUniquePtr<FMeshVertexChange> ApplyPositions;		// vertices that exist after the stroke, at their final positions
+
+	virtual void Apply(UObject* Object) override
+	{
+		TopologyChange->Apply(Object);
+		ApplyPositions->Apply(Object);
+	}
+
+	virtual void Revert(UObject* Object) override
+	{
+		TopologyChange->Revert(Object);
+		RevertPositions->Revert(Object);
+	}
+
+	virtual FString ToString() const override
+	{
+		return TEXT("FDynamicSculptStrokeChange");
+	}
+};
+
+
 void UDynamicMeshSculptTool::BeginChange(bool bIsVertexChange)
 {
 	check(ActiveVertexChange == nullptr);
@@ -2405,6 +2734,7 @@ void UDynamicMeshSculptTool::BeginChange(bool bIsVertexChange)
 	{
 		ActiveMeshChange = new FDynamicMeshChangeTracker(DynamicMeshComponent->GetMesh());
 		ActiveMeshChange->BeginChange();
+		ActiveMeshChangePositions.Begin(DynamicMeshComponent->GetMesh());
 	}
 }
 
@@ -2420,10 +2750,13 @@ void UDynamicMeshSculptTool::EndChange()
 
 	if (ActiveMeshChange != nullptr)
 	{
-		FMeshChange* NewMeshChange = new FMeshChange();
-		NewMeshChange->DynamicMeshChange = ActiveMeshChange->EndChange();
-		//NewMeshChange->DynamicMeshChange->CheckValidity();
-		TUniquePtr<FMeshChange> NewChange(NewMeshChange);
+		TUniquePtr<FDynamicSculptStrokeChange> NewChange = MakeUnique<FDynamicSculptStrokeChange>();
+		NewChange->TopologyChange = MakeUnique<FMeshChange>();
+		NewChange->TopologyChange->DynamicMeshChange = ActiveMeshChange->EndChange();
+		//NewChange->TopologyChange->DynamicMeshChange->CheckValidity();
+		NewChange->RevertPositions = MakeUnique<FMeshVertexChange>();
+		NewChange->ApplyPositions = MakeUnique<FMeshVertexChange>();
+		ActiveMeshChangePositions.End(DynamicMeshComponent->GetMesh(), *NewChange->RevertPositions, *NewChange->ApplyPositions);
 		GetToolManager()->EmitObjectChange(DynamicMeshComponent, MoveTemp(NewChange), LOCTEXT("MeshSculptChange", "Brush Stroke"));
 		delete ActiveMeshChange;
 		ActiveMeshChange = nullptr;
@@ -2434,8 +2767,8 @@ void UDynamicMeshSculptTool::SaveActiveROI()
 {
 	if (ActiveMeshChange != nullptr)
 	{
-		// must save triangles containing vertex ROI or they will not be included in emitted mesh change (due to limitations of change tracker)
-		ActiveMeshChange->SaveVertexOneRingTriangles(VertexROI, true);
+		// stamps only move vertices, so only positions are saved. Triangles are saved by the remesher if it modifies them.
+		ActiveMeshChangePositions.SaveVertices(DynamicMeshComponent->GetMesh(), VertexROI);
 	}
 }
 
@@ -22,8 +22,9 @@
 #include "Properties/MeshUVChannelProperties.h"
 #include "PropertySets/PolygroupLayersProperties.h"
 #include "Polygroups/PolygroupUtil.h"
+#include "MeshSelectionUtil.h"
 
-#include "Algo/MaxElement.h"
+#include "Async/ParallelFor.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(MeshSelectionTool)
 
@@ -128,6 +129,7 @@ void UMeshSelectionTool::Setup()
 	const FDynamicMesh3* Mesh = PreviewMesh->GetPreviewDynamicMesh();
 	SelectedVertices = TBitArray<>(false, Mesh->MaxVertexID());
 	SelectedTriangles = TBitArray<>(false, Mesh->MaxTriangleID());
+	SelectedFaceIndices.Init(INDEX_NONE, Mesh->MaxTriangleID());
 
 	this->Selection = NewObject<UMeshSelectionSet>(this);
 	Selection->GetOnModified().AddLambda([this](USelectionSet* SelectionObj)
@@ -135,9 +137,15 @@ void UMeshSelectionTool::Setup()
 		OnExternalSelectionChange();
 	});
 
-	// rebuild octree if mesh changes
+	// rebuild octrees if mesh changes, unless the edit was made by the tool and it updated them already (ie not on undo/redo)
 	PreviewMesh->GetOnMeshChanged().AddLambda([this]() { 
-		bOctreeValid = false; 
+		if (bInIncrementalSpatialEdit == false)
+		{
+			bOctreeValid = false;
+			bVerticesOctreeValid = false;
+		}
+		bVisibilitySpatialValid = false;
+		bVisibilityCacheValid = false;
 		bFullMeshInvalidationPending = true; 
 		bColorsUpdatePending = true; 
 		CacheUVIslandIDs(); 
@@ -322,18 +330,7 @@ void UMeshSelectionTool::RegisterActions(FInteractiveToolActionSet& ActionSet)
 
 void UMeshSelectionTool::OnExternalSelectionChange()
 {
-	int32 NumTriangles = SelectedTriangles.Num();
-	TSet<int32> AllModifiedTriangles;
-	for (int32 k = 0; k < NumTriangles; ++k)
-	{
-		if (SelectedTriangles[k])
-		{
-			AllModifiedTriangles.Add(k);
-		}
-	}
-
 	SelectedVertices.SetRange(0, SelectedVertices.Num(), false);
-	SelectedTriangles.SetRange(0, SelectedTriangles.Num(), false);
 
 	if (SelectionType == EMeshSelectionElementType::Vertex)
 	{
@@ -345,17 +342,62 @@ void UMeshSelectionTool::OnExternalSelectionChange()
 	}
 	else if (SelectionType == EMeshSelectionElementType::Face)
 	{
-		for (int FaceIdx : Selection->Faces)
+		TBitArray<> NewSelectedTriangles(false, SelectedTriangles.Num());
+		for (int32 k = 0; k < Selection->Faces.Num(); ++k)
+		{
+			int32 FaceIdx = Selection->Faces[k];
+			NewSelectedTriangles[FaceIdx] = true;
+			SelectedFaceIndices[FaceIdx] = k;
+		}
+
+		// only re-upload the triangles whose selection state changed
+		TArray<int32> ModifiedTriangles;
+		for (TConstSetBitIterator<> It(SelectedTriangles); It; ++It)
 		{
-			SelectedTriangles[FaceIdx] = true;
-			AllModifiedTriangles.Add(FaceIdx);
+			if (NewSelectedTriangles[It.GetIndex()] == false)
+			{
+				ModifiedTriangles.Add(It.GetIndex());
+				SelectedFaceIndices[It.GetIndex()] = INDEX_NONE;
+			}
+		}
+		for (int32 FaceIdx : Selection->Faces)
+		{
+			if (SelectedTriangles[FaceIdx] == false)
+			{
+				ModifiedTriangles.Add(FaceIdx);
+			}
+		}
+
+		SelectedTriangles = MoveTemp(NewSelectedTriangles);
+		if (ModifiedTriangles.Num() > 0)
+		{
+			OnRegionHighlightUpdated(ModifiedTriangles);
 		}
-		// todo: more efficient for rendering update to compute the delta set here...
-		OnRegionHighlightUpdated(AllModifiedTriangles);
 	}
 }
 
 
+void UMeshSelectionTool::AddSelectedTriangle(int32 TriangleID)
+{
+	SelectedTriangles[TriangleID] = true;
+	SelectedFaceIndices[TriangleID] = Selection->Faces.Add(TriangleID);
+}
+
+
+void UMeshSelectionTool::RemoveSelectedTriangle(int32 TriangleID)
+{
+	// move the last face into the removed slot
+	int32 Index = SelectedFaceIndices[TriangleID];
+	int32 LastTriangleID = Selection->Faces.Last();
+	Selection->Faces[Index] = LastTriangleID;
+	SelectedFaceIndices[LastTriangleID] = Index;
+	Selection->Faces.Pop(false);
+
+	SelectedTriangles[TriangleID] = false;
+	SelectedFaceIndices[TriangleID] = INDEX_NONE;
+}
+
+
 
 
 bool UMeshSelectionTool::HitTest(const FRay& Ray, FHitResult& OutHit)
@@ -422,24 +464,68 @@ TUniquePtr<FDynamicMeshOctree3>& UMeshSelectionTool::GetOctree()
 }
 
 
+TUniquePtr<TDynamicVerticesOctree3<FDynamicMesh3>>& UMeshSelectionTool::GetVerticesOctree()
+{
+	if (bVerticesOctreeValid == false)
+	{
+		VerticesOctree = MakeUnique<TDynamicVerticesOctree3<FDynamicMesh3>>();
+		VerticesOctree->Initialize(PreviewMesh->GetPreviewDynamicMesh(), true);
+		bVerticesOctreeValid = true;
+	}
+	return VerticesOctree;
+}
+
+
+void UMeshSelectionTool::UpdateSpatialForEdit(const TArray<int32>& Triangles, const TArray<int32>& Vertices)
+{
+	const FDynamicMesh3* Mesh = PreviewMesh->GetPreviewDynamicMesh();
+
+	if (bOctreeValid && Triangles.Num() > 0)
+	{
+		TArray<int32> RemovedTriangles, ModifiedTriangles;
+		for (int32 tid : Triangles)
+		{
+			if (Mesh->IsTriangle(tid))
+			{
+				ModifiedTriangles.Add(tid);
+			}
+			else
+			{
+				RemovedTriangles.Add(tid);
+			}
+		}
+		Octree->RemoveTriangles(RemovedTriangles);
+		Octree->ReinsertTriangles(ModifiedTriangles);
+	}
+
+	if (bVerticesOctreeValid)
+	{
+		for (int32 vid : Vertices)
+		{
+			// removing a vertex that is not in the octree is a no-op, so this handles added, moved and removed vertices
+			VerticesOctree->RemoveVertex(vid);
+			if (Mesh->IsVertex(vid))
+			{
+				VerticesOctree->InsertVertex(vid);
+			}
+		}
+	}
+}
+
+
 
 void UMeshSelectionTool::CalculateVertexROI(const FBrushStampData& Stamp, TArray<int>& VertexROI)
 {
 	FTransform3d Transform = UE::ToolTarget::GetLocalToWorldTransform(Target);
 	FVector3d StampPosLocal = Transform.InverseTransformPosition((FVector3d)Stamp.WorldPosition);
 
-	// TODO: need dynamic vertex hash table!
 	float Radius = GetCurrentBrushRadiusLocal();
 	float RadiusSqr = Radius * Radius;
 	const FDynamicMesh3* Mesh = PreviewMesh->GetPreviewDynamicMesh();
-	for (int VertIdx : Mesh->VertexIndicesItr())
-	{
-		FVector3d Position = Mesh->GetVertex(VertIdx);
-		if ((Position - StampPosLocal).SquaredLength() < RadiusSqr)
-		{
-			VertexROI.Add(VertIdx);
-		}
-	}
+	FAxisAlignedBox3d QueryBox(StampPosLocal, Radius);
+	GetVerticesOctree()->RangeQuery(QueryBox,
+		[&](int32 VertexID) { return DistanceSquared(Mesh->GetVertex(VertexID), StampPosLocal) < RadiusSqr; },
+		VertexROI);
 }
 
 
@@ -603,65 +689,93 @@ void UMeshSelectionTool::UpdateFaceSelection(const FBrushStampData& Stamp, const
 		FTransform3d LocalToWorld = UE::ToolTarget::GetLocalToWorldTransform(Target);
 		FVector3d LocalEyePosition(LocalToWorld.InverseTransformPosition(StateOut.Position));
 
-		for (int tid : TriangleROI)
-		{
-			FVector3d Centroid = Mesh->GetTriCentroid(tid);
-			int HitTID = GetOctree()->FindNearestHitObject(FRay3d(LocalEyePosition, UE::Geometry::Normalized(Centroid - LocalEyePosition)));
-			if (HitTID == tid)
-			{
-				LocalROI.Add(HitTID);
-			}
-		}
+		ComputeVisibleTriangles(LocalEyePosition, TriangleROI, LocalROI);
 		UseROI = &LocalROI;
 	}
 
-	// separate paths for add and remove because we can't efficiently remove from Selection->Faces TArray
-	if (bInRemoveStroke == false)
+	bool bDesiredValue = (bInRemoveStroke == false);
+	ModifiedTrianglesBuffer.Reset();
+	for (int TriIdx : *UseROI)
 	{
-		for (int TriIdx : *UseROI)
+		if (SelectedTriangles[TriIdx] != bDesiredValue)
 		{
-			if (SelectedTriangles[TriIdx] == false)
+			if (bDesiredValue)
 			{
-				SelectedTriangles[TriIdx] = true;
-				Selection->Faces.Add(TriIdx);
-				if (ActiveSelectionChange != nullptr)
-				{
-					ActiveSelectionChange->Add(TriIdx);
-				}
+				AddSelectedTriangle(TriIdx);
+			}
+			else
+			{
+				RemoveSelectedTriangle(TriIdx);
+			}
+			ModifiedTrianglesBuffer.Add(TriIdx);
+			if (ActiveSelectionChange != nullptr)
+			{
+				ActiveSelectionChange->Add(TriIdx);
 			}
 		}
 	}
-	else
+
+	if (ModifiedTrianglesBuffer.Num() > 0)
+	{
+		OnRegionHighlightUpdated(ModifiedTrianglesBuffer);
+	}
+}
+
+
+
+void UMeshSelectionTool::ComputeVisibleTriangles(const FVector3d& LocalEyePosition, const TArray<int>& Triangles, TArray<int>& VisibleTrianglesOut)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(MeshSelectionTool_ComputeVisibleTriangles);
+
+	const FDynamicMesh3* Mesh = PreviewMesh->GetPreviewDynamicMesh();
+	if (bVisibilitySpatialValid == false)
+	{
+		VisibilitySpatial.SetMesh(Mesh, true);
+		bVisibilitySpatialValid = true;
+		bVisibilityCacheValid = false;
+	}
+
+	if (bVisibilityCacheValid == false || VisibilityCacheEyePosition != LocalEyePosition)
 	{
-		bool bModified = false;
-		TArray<int32> CurSelection = Selection->Faces;
-		for (int TriIdx : *UseROI)
+		VisibilityTested.Init(false, Mesh->MaxTriangleID());
+		VisibilityResult.Init(false, Mesh->MaxTriangleID());
+		VisibilityCacheEyePosition = LocalEyePosition;
+		bVisibilityCacheValid = true;
+	}
+
+	TArray<int32> UntestedTriangles;
+	for (int32 tid : Triangles)
+	{
+		if (VisibilityTested[tid] == false)
 		{
-			if (SelectedTriangles[TriIdx] == true)
-			{
-				SelectedTriangles[TriIdx] = false;
-				bModified = true;
-				if (ActiveSelectionChange != nullptr)
-				{
-					ActiveSelectionChange->Add(TriIdx);
-				}
-			}
+			UntestedTriangles.Add(tid);
 		}
-		// rebuild selection
-		if (bModified)
+	}
+
+	// bits of a TBitArray share words, so cast the rays into a byte per triangle and set the bits afterwards
+	TArray<uint8> UntestedVisible;
+	UntestedVisible.SetNumUninitialized(UntestedTriangles.Num());
+	ParallelFor(UntestedTriangles.Num(), [&](int32 k)
+	{
+		int32 tid = UntestedTriangles[k];
+		FVector3d Centroid = Mesh->GetTriCentroid(tid);
+		int32 HitTID = VisibilitySpatial.FindNearestHitTriangle(FRay3d(LocalEyePosition, UE::Geometry::Normalized(Centroid - LocalEyePosition)));
+		UntestedVisible[k] = (HitTID == tid) ? 1 : 0;
+	});
+
+	for (int32 k = 0; k < UntestedTriangles.Num(); ++k)
+	{
+		VisibilityTested[UntestedTriangles[k]] = true;
+		VisibilityResult[UntestedTriangles[k]] = (UntestedVisible[k] != 0);
+	}
+
+	for (int32 tid : Triangles)
+	{
+		if (VisibilityResult[tid])
 		{
-			Selection->Faces.Reset();
-			for (int32 tid : CurSelection)
-			{
-				if (SelectedTriangles[tid])
-				{
-					Selection->Faces.Add(tid);
-				}
-			}
+			VisibleTrianglesOut.Add(tid);
 		}
 	}
-
-	OnRegionHighlightUpdated(*UseROI);
 }
 
 
@@ -763,10 +877,6 @@ void UMeshSelectionTool::OnRegionHighlightUpdated(const TArray<int32>& Triangles
 {
 	PreviewMesh->NotifyRegionDeferredEditCompleted(Triangles, EMeshRenderAttributeFlags::SecondaryIndexBuffers);
 }
-void UMeshSelectionTool::OnRegionHighlightUpdated(const TSet<int32>& Triangles)
-{
-	PreviewMesh->NotifyRegionDeferredEditCompleted(Triangles, EMeshRenderAttributeFlags::SecondaryIndexBuffers);
-}
 
 
 
@@ -788,10 +898,10 @@ void UMeshSelectionTool::UpdateVisualization(bool bSelectionModified)
 		bFullMeshInvalidationPending = false;
 	}
 
-	// force an update of renderbuffers
+	// only the selection index buffers depend on the selection
 	if (bSelectionModified)
 	{
-		PreviewMesh->NotifyDeferredEditCompleted(UPreviewMesh::ERenderUpdateMode::FullUpdate, EMeshRenderAttributeFlags::AllVertexAttribs, true);
+		OnRegionHighlightUpdated();
 	}
 
 	if (bColorsUpdatePending)
@@ -862,8 +972,21 @@ void UMeshSelectionTool::CacheUVIslandIDs()
 }
 
 
+const UE::MeshSelectionUtil::FGroupTriangles& UMeshSelectionTool::GetGroupTriangles()
+{
+	if (bGroupTrianglesValid == false)
+	{
+		GroupTriangles.Initialize(*PreviewMesh->GetMesh(), *ActiveGroupSet);
+		bGroupTrianglesValid = true;
+	}
+	return GroupTriangles;
+}
+
+
 void UMeshSelectionTool::UpdateActiveGroupLayer()
 {
+	bGroupTrianglesValid = false;
+
 	// todo: need this to be const
 	const FDynamicMesh3* SourceMesh = PreviewMesh->GetMesh();
 
@@ -1149,54 +1272,40 @@ void UMeshSelectionTool::InvertSelection()
 void UMeshSelectionTool::GrowShrinkSelection(bool bGrow)
 {
 	check(SelectionType == EMeshSelectionElementType::Face);
-	TArray<int32> SelectedFaces = Selection->GetElements(EMeshSelectionElementType::Face);
+	const TArray<int32>& SelectedFaces = Selection->Faces;
 	if (SelectedFaces.Num() == 0)
 	{
 		return;
 	}
 
 	const FDynamicMesh3* Mesh = PreviewMesh->GetPreviewDynamicMesh();
-	TArray<int32> Vertices;
-	UE::Geometry::TriangleToVertexIDs(Mesh, SelectedFaces, Vertices);
-
-	TSet<int32> ChangeFaces;
-	for (int vid : Vertices)
+	TArray<int32> ChangeFaces;
+	if (bGrow)
 	{
-		int OutCount = 0;
-		for (int tid : Mesh->VtxTrianglesItr(vid))
-		{
-			if (SelectedTriangles[tid] == false)
-			{
-				OutCount++;
-			}
-		}
-		if (OutCount == 0)
-		{
-			continue;
-		}
-
-		for (int tid : Mesh->VtxTrianglesItr(vid))
-		{
-			if ( (bGrow && SelectedTriangles[tid] == false) || (bGrow == false && SelectedTriangles[tid]) )
-			{
-				ChangeFaces.Add(tid);
-			}
-		}
+		UE::MeshSelectionUtil::FindGrowTriangles(*Mesh, SelectedFaces, SelectedTriangles, ChangeFaces);
 	}
+	else
+	{
+		UE::MeshSelectionUtil::FindShrinkTriangles(*Mesh, SelectedFaces, SelectedTriangles, ChangeFaces);
+	}
+
 	if( SelectionProps->SelectionMode == EMeshSelectionToolPrimaryMode::AllInGroup )
 	{
-		TSet<int32> AdjacentFaces{ChangeFaces};
-		TSet<int32> AdjacentGroups{};
-		ChangeFaces.Empty();
-		for ( int32 TID : AdjacentFaces )
+		TSet<int32> AdjacentGroups;
+		for (int32 TID : ChangeFaces)
 		{
 			AdjacentGroups.Add(ActiveGroupSet->GetTriangleGroup(TID));
 		}
-		for ( int32 TID : Mesh->TriangleIndicesItr() )
+		ChangeFaces.Reset();
+		const UE::MeshSelectionUtil::FGroupTriangles& TrianglesByGroup = GetGroupTriangles();
+		for (int32 GroupID : AdjacentGroups)
 		{
-			if ( AdjacentGroups.Contains(ActiveGroupSet->GetTriangleGroup(TID)) )
+			for (int32 TID : TrianglesByGroup.GetTriangles(GroupID))
 			{
-				ChangeFaces.Add(TID);
+				if (SelectedTriangles[TID] != bGrow)
+				{
+					ChangeFaces.Add(TID);
+				}
 			}
 		}
 	}
@@ -1228,32 +1337,15 @@ void UMeshSelectionTool::GrowShrinkSelection(bool bGrow)
 void UMeshSelectionTool::ExpandToConnected()
 {
 	check(SelectionType == EMeshSelectionElementType::Face);
-	TArray<int32> SelectedFaces = Selection->GetElements(EMeshSelectionElementType::Face);
-	if (SelectedFaces.Num() == 0)
+	if (Selection->Faces.Num() == 0)
 	{
 		return;
 	}
 
 	const FDynamicMesh3* Mesh = PreviewMesh->GetPreviewDynamicMesh();
 
-	TArray<int32> Queue(SelectedFaces);
-	TSet<int32> AddFaces;
-
-	while (Queue.Num() > 0)
-	{
-		int32 CurTri = Queue.Pop(false);
-		FIndex3i NbrTris = Mesh->GetTriNeighbourTris(CurTri);
-
-		for (int j = 0; j < 3; ++j)
-		{
-			int32 tid = NbrTris[j];
-			if (tid != FDynamicMesh3::InvalidID && SelectedTriangles[tid] == false && AddFaces.Contains(tid) == false)
-			{
-				AddFaces.Add(tid);
-				Queue.Add(tid);
-			}
-		}
-	}
+	TArray<int32> AddFaces;
+	UE::MeshSelectionUtil::FindConnectedTriangles(*Mesh, Selection->Faces, SelectedTriangles, AddFaces);
 	if (AddFaces.Num() == 0)
 	{
 		return;
@@ -1271,52 +1363,37 @@ void UMeshSelectionTool::ExpandToConnected()
 void UMeshSelectionTool::SelectLargestComponent(bool bWeightByArea)
 {
 	check(SelectionType == EMeshSelectionElementType::Face);
-	TArray<int32> SelectedFaces = Selection->GetElements(EMeshSelectionElementType::Face);
-	if (SelectedFaces.Num() == 0)
+	if (Selection->Faces.Num() == 0)
 	{
 		return;
 	}
 
 	const FDynamicMesh3* Mesh = PreviewMesh->GetPreviewDynamicMesh();
 
-	// each component gets its own group id
-	FMeshConnectedComponents Components(Mesh);
-	Components.FindConnectedTriangles(SelectedFaces);
+	TArray<int32> LargestComponent;
+	UE::MeshSelectionUtil::FindLargestSelectedComponent(*Mesh, Selection->Faces, SelectedTriangles, bWeightByArea, LargestComponent);
 
-	if (Components.Num() == 0) // no triangles?
+	TBitArray<> InLargestComponent(false, SelectedTriangles.Num());
+	for (int32 TID : LargestComponent)
 	{
-		ClearSelection();
-		return;
+		InLargestComponent[TID] = true;
 	}
-
-
-	int BestComponent = 0;
-	FMeshConnectedComponents::FComponent* MaxComponent = Algo::MaxElementBy(Components, [bWeightByArea, &Mesh](const FMeshConnectedComponents::FComponent& Component)
+	TArray<int32> RemoveFaces;
+	for (int32 TID : Selection->Faces)
 	{
-		if (bWeightByArea)
+		if (InLargestComponent[TID] == false)
 		{
-			double AreaSum = 0;
-			for (int TID : Component.Indices)
-			{
-				AreaSum += Mesh->GetTriArea(TID);
-			}
-			return AreaSum;
+			RemoveFaces.Add(TID);
 		}
-		else
-		{
-			return (double)Component.Indices.Num();
-		}
-	});
-
-	BeginChange(false);
-	for (FMeshConnectedComponents::FComponent& Component : Components)
+	}
+	if (RemoveFaces.Num() == 0)
 	{
-		if (&Component != MaxComponent)
-		{
-			ActiveSelectionChange->Add(Component.Indices);
-			Selection->RemoveIndices(EMeshSelectionElementType::Face, Component.Indices);
-		}
+		return;
 	}
+
+	BeginChange(false);
+	ActiveSelectionChange->Add(RemoveFaces);
+	Selection->RemoveIndices(EMeshSelectionElementType::Face, RemoveFaces);
 	
 	TUniquePtr<FToolCommandChange> SelectionChange = EndChange();
 
@@ -1412,7 +1489,12 @@ void UMeshSelectionTool::DeleteSelectedTriangles()
 	TUniquePtr<FToolCommandChange> SelectionChange = EndChange();
 	ChangeSeq->AppendChange(Selection, MoveTemp(SelectionChange));
 
+	// isolated vertices are removed with the triangles
+	TArray<int32> FaceVertices;
+	UE::Geometry::TriangleToVertexIDs(PreviewMesh->GetMesh(), SelectedFaces, FaceVertices);
+
 	// delete triangles and emit delete triangles change
+	TGuardValue<bool> SpatialEditGuard(bInIncrementalSpatialEdit, true);
 	TUniquePtr<FMeshChange> MeshChange = PreviewMesh->TrackedEditMesh(
 		[&SelectedFaces](FDynamicMesh3& Mesh, FDynamicMeshChangeTracker& ChangeTracker)
 	{
@@ -1420,6 +1502,7 @@ void UMeshSelectionTool::DeleteSelectedTriangles()
 		Editor.RemoveTriangles(SelectedFaces, true, [&ChangeTracker](int TriangleID) { ChangeTracker.SaveTriangle(TriangleID, true); });
 	});
 	ChangeSeq->AppendChange(PreviewMesh, MoveTemp(MeshChange));
+	UpdateSpatialForEdit(SelectedFaces, FaceVertices);
 
 	// emit combined change sequence
 	GetToolManager()->EmitObjectChange(this, MoveTemp(ChangeSeq), LOCTEXT("MeshSelectionToolDeleteFaces", "Delete Faces"));
@@ -1427,7 +1510,6 @@ void UMeshSelectionTool::DeleteSelectedTriangles()
 	bFullMeshInvalidationPending = true;
 	OnExternalSelectionChange();
 	bHaveModifiedMesh = true;
-	bOctreeValid = false;
 }
 
 
@@ -1442,7 +1524,11 @@ void UMeshSelectionTool::DisconnectSelectedTriangles()
 
 	TUniquePtr<FToolCommandChangeSequence> ChangeSeq = MakeUnique<FToolCommandChangeSequence>();
 
+	// disconnecting duplicates the boundary vertices, but does not move any triangles
+	const int32 InitialMaxVertexID = PreviewMesh->GetMesh()->MaxVertexID();
+
 	// split out selected triangles and emit triangle change
+	TGuardValue<bool> SpatialEditGuard(bInIncrementalSpatialEdit, true);
 	TUniquePtr<FMeshChange> MeshChange = PreviewMesh->TrackedEditMesh(
 		[&SelectedFaces](FDynamicMesh3& Mesh, FDynamicMeshChangeTracker& ChangeTracker)
 	{
@@ -1459,6 +1545,13 @@ void UMeshSelectionTool::DisconnectSelectedTriangles()
 	});
 	ChangeSeq->AppendChange(PreviewMesh, MoveTemp(MeshChange));
 
+	TArray<int32> NewVertices;
+	for (int32 vid = InitialMaxVertexID; vid < PreviewMesh->GetMesh()->MaxVertexID(); ++vid)
+	{
+		NewVertices.Add(vid);
+	}
+	UpdateSpatialForEdit(TArray<int32>(), NewVertices);
+
 	// emit combined change sequence
 	GetToolManager()->EmitObjectChange(this, MoveTemp(ChangeSeq), LOCTEXT("MeshSelectionToolDisconnectFaces", "Disconnect Faces"));
 
@@ -1552,7 +1645,8 @@ void UMeshSelectionTool::FlipSelectedTriangles()
 	TUniquePtr<FToolCommandChange> SelectionChange = EndChange();
 	ChangeSeq->AppendChange(Selection, MoveTemp(SelectionChange));
 
-	// flip normals
+	// flip normals, the triangle bounds do not change
+	TGuardValue<bool> SpatialEditGuard(bInIncrementalSpatialEdit, true);
 	TUniquePtr<FMeshChange> MeshChange = PreviewMesh->TrackedEditMesh(
 		[&SelectedFaces](FDynamicMesh3& Mesh, FDynamicMeshChangeTracker& ChangeTracker)
 	{
@@ -1595,6 +1689,7 @@ void UMeshSelectionTool::AssignNewGroupToSelectedTriangles()
 
 	// assign new groups to triangles
 	// note: using an FMeshChange is kind of overkill here
+	TGuardValue<bool> SpatialEditGuard(bInIncrementalSpatialEdit, true);
 	TUniquePtr<FMeshChange> MeshChange = PreviewMesh->TrackedEditMesh(
 		[&SelectedFaces, this](FDynamicMesh3& Mesh, FDynamicMeshChangeTracker& ChangeTracker)
 	{
@@ -1638,6 +1733,13 @@ void UMeshSelectionTool::SmoothSelectionBoundary()
 
 	TUniquePtr<FToolCommandChangeSequence> ChangeSeq = MakeUnique<FToolCommandChangeSequence>();
 
+	TArray<int32> MovedVertices;
+	for (const FEdgeLoop& Loop : BoundaryLoops.Loops)
+	{
+		MovedVertices.Append(Loop.Vertices);
+	}
+
+	TGuardValue<bool> SpatialEditGuard(bInIncrementalSpatialEdit, true);
 	TUniquePtr<FMeshChange> MeshChange = PreviewMesh->TrackedEditMesh(
 		[&BoundaryLoops, this](FDynamicMesh3& Mesh, FDynamicMeshChangeTracker& ChangeTracker)
 	{
@@ -1683,6 +1785,10 @@ void UMeshSelectionTool::SmoothSelectionBoundary()
 
 	ChangeSeq->AppendChange(PreviewMesh, MoveTemp(MeshChange));
 
+	TSet<int32> MovedTriangles;
+	UE::Geometry::VertexToTriangleOneRing(PreviewMesh->GetMesh(), MovedVertices, MovedTriangles);
+	UpdateSpatialForEdit(MovedTriangles.Array(), MovedVertices);
+
 	GetToolManager()->EmitObjectChange(this, MoveTemp(ChangeSeq), LOCTEXT("MeshSelectionToolSmoothBoundary", "Smooth Selection Boundary"));
 
 	OnExternalSelectionChange();
@@ -1691,5 +1797,8 @@ void UMeshSelectionTool::SmoothSelectionBoundary()
 
 
 
+#include "Tests/MeshSelectionTool_Tests.inl"
+
+
 #undef LOCTEXT_NAMESPACE
 
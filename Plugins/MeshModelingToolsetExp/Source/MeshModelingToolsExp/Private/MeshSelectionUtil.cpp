@@ -0,0 +1,236 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "MeshSelectionUtil.h"
+#include "Polygroups/PolygroupSet.h"
+#include "Async/ParallelFor.h"
+#include "Algo/Sort.h"
+
+using namespace UE::Geometry;
+
+namespace
+{
+	// triangles processed by each parallel task when expanding a frontier
+	constexpr int32 FrontierBlockSize = 1024;
+
+	/** Bits that can be set from parallel tasks */
+	class FConcurrentBitArray
+	{
+	public:
+		explicit FConcurrentBitArray(int32 NumBits)
+		{
+			Words.SetNumZeroed(FMath::DivideAndRoundUp(NumBits, 32));
+		}
+
+		/** @return true if the bit was not set before, ie if this call set it */
+		bool TrySet(int32 Index)
+		{
+			const int32 Mask = (int32)(1u << (Index & 31));
+			return (FPlatformAtomics::InterlockedOr(&Words[Index >> 5], Mask) & Mask) == 0;
+		}
+
+	protected:
+		TArray<int32> Words;
+	};
+
+	/**
+	 * Call ProcessFunc(Item, BlockResult) for each of Items, in parallel blocks, and append the results of the blocks
+	 * to ResultOut in block order. If ProcessFunc claims shared items with FConcurrentBitArray::TrySet, which block
+	 * gets an item depends on scheduling, so callers that need a stable order must sort what was appended.
+	 */
+	template<typename ProcessFuncType>
+	void ParallelCollect(const TArray<int32>& Items, TArray<int32>& ResultOut, ProcessFuncType&& ProcessFunc)
+	{
+		const int32 NumBlocks = FMath::DivideAndRoundUp(Items.Num(), FrontierBlockSize);
+		TArray<TArray<int32>> BlockResults;
+		BlockResults.SetNum(NumBlocks);
+
+		ParallelFor(NumBlocks, [&](int32 BlockIndex)
+		{
+			TArray<int32>& BlockResult = BlockResults[BlockIndex];
+			const int32 End = FMath::Min(Items.Num(), (BlockIndex + 1) * FrontierBlockSize);
+			for (int32 k = BlockIndex * FrontierBlockSize; k < End; ++k)
+			{
+				ProcessFunc(Items[k], BlockResult);
+			}
+		});
+
+		for (const TArray<int32>& BlockResult : BlockResults)
+		{
+			ResultOut.Append(BlockResult);
+		}
+	}
+
+	/** Flood from Frontier across the edges for which CanCross(TriangleID) is true, appending each level of reached triangles to TrianglesOut */
+	template<typename CanCrossFuncType>
+	void ExpandAcrossEdges(const FDynamicMesh3& Mesh, TArray<int32>& Frontier, FConcurrentBitArray& Visited, CanCrossFuncType&& CanCross, TArray<int32>& TrianglesOut)
+	{
+		TArray<int32> NextFrontier;
+		while (Frontier.Num() > 0)
+		{
+			NextFrontier.Reset();
+			ParallelCollect(Frontier, NextFrontier, [&](int32 TriangleID, TArray<int32>& Result)
+			{
+				const FIndex3i NbrTris = Mesh.GetTriNeighbourTris(TriangleID);
+				for (int32 j = 0; j < 3; ++j)
+				{
+					if (NbrTris[j] != FDynamicMesh3::InvalidID && CanCross(NbrTris[j]) && Visited.TrySet(NbrTris[j]))
+					{
+						Result.Add(NbrTris[j]);
+					}
+				}
+			});
+
+			// the set of triangles reached at each level does not depend on scheduling, their order does
+			NextFrontier.Sort();
+			TrianglesOut.Append(NextFrontier);
+			Swap(Frontier, NextFrontier);
+		}
+	}
+}
+
+
+void UE::MeshSelectionUtil::FGroupTriangles::Initialize(const FDynamicMesh3& Mesh, const FPolygroupSet& Groups)
+{
+	GroupToIndex.Reset();
+
+	// Count the triangles of each group, turn the counts into offsets, then fill in the triangles.
+	TArray<int32> Counts;
+	for (int32 TriangleID : Mesh.TriangleIndicesItr())
+	{
+		const int32 GroupID = Groups.GetTriangleGroup(TriangleID);
+		const int32* GroupIndex = GroupToIndex.Find(GroupID);
+		if (GroupIndex == nullptr)
+		{
+			GroupIndex = &GroupToIndex.Add(GroupID, Counts.Num());
+			Counts.Add(0);
+		}
+		Counts[*GroupIndex]++;
+	}
+
+	Offsets.SetNumUninitialized(Counts.Num() + 1);
+	Offsets[0] = 0;
+	for (int32 GroupIndex = 0; GroupIndex < Counts.Num(); ++GroupIndex)
+	{
+		Offsets[GroupIndex + 1] = Offsets[GroupIndex] + Counts[GroupIndex];
+		Counts[GroupIndex] = Offsets[GroupIndex];
+	}
+
+	Triangles.SetNumUninitialized(Offsets.Last());
+	for (int32 TriangleID : Mesh.TriangleIndicesItr())
+	{
+		const int32 GroupIndex = GroupToIndex[Groups.GetTriangleGroup(TriangleID)];
+		Triangles[Counts[GroupIndex]++] = TriangleID;
+	}
+}
+
+
+TArrayView<const int32> UE::MeshSelectionUtil::FGroupTriangles::GetTriangles(int32 GroupID) const
+{
+	const int32* GroupIndex = GroupToIndex.Find(GroupID);
+	if (GroupIndex == nullptr)
+	{
+		return TArrayView<const int32>();
+	}
+	return TArrayView<const int32>(Triangles.GetData() + Offsets[*GroupIndex], Offsets[*GroupIndex + 1] - Offsets[*GroupIndex]);
+}
+
+
+void UE::MeshSelectionUtil::FindGrowTriangles(const FDynamicMesh3& Mesh, const TArray<int32>& SelectedTriangles, const TBitArray<>& IsSelected, TArray<int32>& TrianglesOut)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(MeshSelectionUtil_FindGrowTriangles);
+
+	FConcurrentBitArray Added(Mesh.MaxTriangleID());
+	const int32 NumExisting = TrianglesOut.Num();
+	ParallelCollect(SelectedTriangles, TrianglesOut, [&](int32 TriangleID, TArray<int32>& Result)
+	{
+		const FIndex3i Tri = Mesh.GetTriangle(TriangleID);
+		for (int32 j = 0; j < 3; ++j)
+		{
+			for (int32 NbrTriangleID : Mesh.VtxTrianglesItr(Tri[j]))
+			{
+				if (IsSelected[NbrTriangleID] == false && Added.TrySet(NbrTriangleID))
+				{
+					Result.Add(NbrTriangleID);
+				}
+			}
+		}
+	});
+
+	// which block adds a triangle shared by several selected triangles depends on scheduling
+	Algo::Sort(MakeArrayView(TrianglesOut).RightChop(NumExisting));
+}
+
+
+void UE::MeshSelectionUtil::FindShrinkTriangles(const FDynamicMesh3& Mesh, const TArray<int32>& SelectedTriangles, const TBitArray<>& IsSelected, TArray<int32>& TrianglesOut)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(MeshSelectionUtil_FindShrinkTriangles);
+
+	ParallelCollect(SelectedTriangles, TrianglesOut, [&](int32 TriangleID, TArray<int32>& Result)
+	{
+		const FIndex3i Tri = Mesh.GetTriangle(TriangleID);
+		for (int32 j = 0; j < 3; ++j)
+		{
+			for (int32 NbrTriangleID : Mesh.VtxTrianglesItr(Tri[j]))
+			{
+				if (IsSelected[NbrTriangleID] == false)
+				{
+					Result.Add(TriangleID);
+					return;
+				}
+			}
+		}
+	});
+}
+
+
+void UE::MeshSelectionUtil::FindConnectedTriangles(const FDynamicMesh3& Mesh, const TArray<int32>& SelectedTriangles, const TBitArray<>& IsSelected, TArray<int32>& TrianglesOut)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(MeshSelectionUtil_FindConnectedTriangles);
+
+	FConcurrentBitArray Visited(Mesh.MaxTriangleID());
+	TArray<int32> Frontier(SelectedTriangles);
+	ExpandAcrossEdges(Mesh, Frontier, Visited,
+		[&IsSelected](int32 TriangleID) { return IsSelected[TriangleID] == false; }, TrianglesOut);
+}
+
+
+void UE::MeshSelectionUtil::FindLargestSelectedComponent(const FDynamicMesh3& Mesh, const TArray<int32>& SelectedTriangles, const TBitArray<>& IsSelected, bool bWeightByArea, TArray<int32>& ComponentOut)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(MeshSelectionUtil_FindLargestSelectedComponent);
+
+	ComponentOut.Reset();
+	double LargestWeight = -1.0;
+
+	FConcurrentBitArray Visited(Mesh.MaxTriangleID());
+	TArray<int32> Component, Frontier;
+	for (int32 SeedTriangleID : SelectedTriangles)
+	{
+		if (Visited.TrySet(SeedTriangleID) == false)
+		{
+			continue;
+		}
+
+		Component.Reset();
+		Component.Add(SeedTriangleID);
+		Frontier.Reset();
+		Frontier.Add(SeedTriangleID);
+		ExpandAcrossEdges(Mesh, Frontier, Visited,
+			[&IsSelected](int32 TriangleID) { return IsSelected[TriangleID] == true; }, Component);
+
+		double Weight = (double)Component.Num();
+		if (bWeightByArea)
+		{
+			Weight = 0;
+			for (int32 TriangleID : Component)
+			{
+				Weight += Mesh.GetTriArea(TriangleID);
+			}
+		}
+
+		if (Weight > LargestWeight)
+		{
+			LargestWeight = Weight;
+			Swap(ComponentOut, Component);
+		}
+	}
+}
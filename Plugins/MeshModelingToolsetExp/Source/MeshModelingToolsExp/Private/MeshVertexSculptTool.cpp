@@ -163,6 +163,12 @@ void UMeshVertexSculptTool::Setup()
 		bTargetDirty = false;
 	});
 
+	// initialize normals adjacency
+	TFuture<void> InitializeNormalsROICache = Async(VertexSculptToolAsyncExecTarget, [SculptMesh, this]()
+	{
+		NormalsROICache.UpdateForMesh(SculptMesh);
+	});
+
 	// initialize render decomposition
 	TFuture<void> InitializeRenderDecomp = Async(VertexSculptToolAsyncExecTarget, [SculptMesh, &MaterialSet, this]()
 	{
@@ -178,6 +184,7 @@ void UMeshVertexSculptTool::Setup()
 	InitializeComponents.Wait();
 	InitializeGroups.Wait();
 	InitializeBaseMesh.Wait();
+	InitializeNormalsROICache.Wait();
 	InitializeRenderDecomp.Wait();
 	InitializeSymmetry.Wait();
 
@@ -429,6 +436,7 @@ void UMeshVertexSculptTool::OnBeginStroke(const FRay& WorldRay)
 {
 	WaitForPendingUndoRedo();		// cannot start stroke if there is an outstanding undo/redo update
 
+	bHaveDeferredStamp = false;
 	UpdateBrushPosition(WorldRay);
 
 	if (SculptProperties->PrimaryBrushType == EMeshVertexSculptBrushType::Plane ||
@@ -473,6 +481,7 @@ void UMeshVertexSculptTool::OnBeginStroke(const FRay& WorldRay)
 	UseBrushOp->BeginStroke(GetSculptMesh(), LastStamp, VertexROI);
 
 	AccumulatedTriangleROI.Reset();
+	AccumulatedTriangleROI.Grow(GetSculptMesh()->MaxTriangleID());
 
 	// begin change here? or wait for first stamp?
 	BeginChange();
@@ -492,20 +501,42 @@ void UMeshVertexSculptTool::OnEndStroke()
 
 
 void UMeshVertexSculptTool::UpdateROI(const FVector3d& BrushPos)
+{
+	UpdateROI(MakeArrayView(&BrushPos, 1));
+}
+
+void UMeshVertexSculptTool::UpdateROI(TArrayView<const FVector3d> BrushPositions)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(VtxSculptTool_UpdateROI);
 
 	float RadiusSqr = GetCurrentBrushRadius() * GetCurrentBrushRadius();
-	FAxisAlignedBox3d BrushBox(
-		BrushPos - GetCurrentBrushRadius() * FVector3d::One(),
-		BrushPos + GetCurrentBrushRadius() * FVector3d::One());
+	auto IsInsideBrush = [&BrushPositions, RadiusSqr](const FVector3d& Pos)
+	{
+		for (const FVector3d& BrushPos : BrushPositions)
+		{
+			if (DistanceSquared(BrushPos, Pos) < RadiusSqr)
+			{
+				return true;
+			}
+		}
+		return false;
+	};
 
-	// do a parallel range quer
+	// do a parallel range quer for each stamp in the batch. Triangles may be found more than once,
+	// the ROI builders below discard the duplicates
 	RangeQueryTriBuffer.Reset();
 	FDynamicMesh3* Mesh = GetSculptMesh();
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE(VtxSculptTool_UpdateROI_RangeQuery);
-		Octree.ParallelRangeQuery(BrushBox, RangeQueryTriBuffer);
+		for (const FVector3d& BrushPos : BrushPositions)
+		{
+			FAxisAlignedBox3d BrushBox(
+				BrushPos - GetCurrentBrushRadius() * FVector3d::One(),
+				BrushPos + GetCurrentBrushRadius() * FVector3d::One());
+			RangeQueryStampTriBuffer.Reset();
+			Octree.ParallelRangeQuery(BrushBox, RangeQueryStampTriBuffer);
+			RangeQueryTriBuffer.Append(RangeQueryStampTriBuffer);
+		}
 	}
 
 	int32 ActiveComponentID = -1;
@@ -551,9 +582,9 @@ void UMeshVertexSculptTool::UpdateROI(const FVector3d& BrushPos)
 			}
 
 			const FIndex3i& TriV = Mesh->GetTriangleRef(tid);
-			TriangleROIInBuf[k].A = (DistanceSquared(BrushPos, Mesh->GetVertexRef(TriV.A)) < RadiusSqr) ? 1 : 0;
-			TriangleROIInBuf[k].B = (DistanceSquared(BrushPos, Mesh->GetVertexRef(TriV.B)) < RadiusSqr) ? 1 : 0;
-			TriangleROIInBuf[k].C = (DistanceSquared(BrushPos, Mesh->GetVertexRef(TriV.C)) < RadiusSqr) ? 1 : 0;
+			TriangleROIInBuf[k].A = IsInsideBrush(Mesh->GetVertexRef(TriV.A)) ? 1 : 0;
+			TriangleROIInBuf[k].B = IsInsideBrush(Mesh->GetVertexRef(TriV.B)) ? 1 : 0;
+			TriangleROIInBuf[k].C = IsInsideBrush(Mesh->GetVertexRef(TriV.C)) ? 1 : 0;
 			if (TriangleROIInBuf[k].A + TriangleROIInBuf[k].B + TriangleROIInBuf[k].C == 0)
 			{
 				RangeQueryTriBuffer[k] = -1;
@@ -635,7 +666,7 @@ void UMeshVertexSculptTool::UpdateROI(const FVector3d& BrushPos)
 				{
 					InsideCount++;
 				} 
-				else if (BrushPos.DistanceSquared(Mesh->GetVertexRef(TriV[j])) < RadiusSqr)
+				else if (IsInsideBrush(Mesh->GetVertexRef(TriV[j])))
 				{
 					VertexROIBuilder.Add(TriV[j]);
 					InsideCount++;
@@ -750,55 +781,99 @@ TFuture<void> UMeshVertexSculptTool::ApplyStamp()
 
 	TUniquePtr<FMeshSculptBrushOp>& UseBrushOp = GetActiveBrushOp();
 
-	// compute region plane if necessary. This may currently be expensive?
-	if (UseBrushOp->WantsStampRegionPlane())
+	// Apply the stamps of the batch in sequence. They share the combined ROI, and each stamp sees the positions
+	// written by the previous one. Vertices outside a stamp's radius get zero falloff and are left in place.
+	FDynamicMesh3* Mesh = GetSculptMesh();
+	for (const FSculptBrushStamp& BatchStamp : StampBatch)
 	{
-		CurrentStamp.RegionPlane = ComputeStampRegionPlane(CurrentStamp.LocalFrame, TriangleROIArray, true, false, false);
-	}
+		CurrentStamp = BatchStamp;
 
-	// set up alpha function if we have one
-	if (bHaveBrushAlpha)
-	{
-		CurrentStamp.StampAlphaFunc = [this](const FSculptBrushStamp& Stamp, const FVector3d& Position)
+		// compute region plane if necessary. This may currently be expensive?
+		if (UseBrushOp->WantsStampRegionPlane())
 		{
-			return this->SampleBrushAlpha(Stamp, Position);
-		};
-	}
+			CurrentStamp.RegionPlane = ComputeStampRegionPlane(CurrentStamp.LocalFrame, TriangleROIArray, true, false, false);
+		}
 
-	// apply the stamp, which computes new positions
-	FDynamicMesh3* Mesh = GetSculptMesh();
-	{
-		TRACE_CPUPROFILER_EVENT_SCOPE(VtxSculptTool_ApplyStamp_Apply);
-		UseBrushOp->ApplyStamp(Mesh, CurrentStamp, VertexROI, ROIPositionBuffer);
-	}
+		// set up alpha if we have one. Alpha for the ROI vertices is sampled in one batch, the
+		// position-based function is kept for brush ops that evaluate alpha elsewhere
+		if (bHaveBrushAlpha)
+		{
+			UpdateStampAlpha(Mesh);
+			CurrentStamp.VertexAlphaValues = ROIAlphaBuffer;
+			CurrentStamp.StampAlphaFunc = [this](const FSculptBrushStamp& Stamp, const FVector3d& Position)
+			{
+				return this->SampleBrushAlpha(Stamp, Position);
+			};
+		}
 
-	// can discard alpha now
-	CurrentStamp.StampAlphaFunc = nullptr;
+		// apply the stamp, which computes new positions
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE(VtxSculptTool_ApplyStamp_Apply);
+			UseBrushOp->ApplyStamp(Mesh, CurrentStamp, VertexROI, ROIPositionBuffer);
+		}
 
-	// if we are applying symmetry, we need to update the on-plane positions as they
-	// will not be in the SymmetricVertexROI
-	if (bApplySymmetry)
-	{
-		// update position of vertices that are on the symmetry plane
-		Symmetry->ApplySymmetryPlaneConstraints(VertexROI, ROIPositionBuffer);
+		// can discard alpha now
+		CurrentStamp.StampAlphaFunc = nullptr;
+		CurrentStamp.VertexAlphaValues = TArrayView<const float>();
 
-		// currently something gross is that VertexROI/ROIPositionBuffer may have both a vertex and it's mirror vertex,
-		// each with a different position. We somehow need to be able to resolve this, but we don't have the mapping 
-		// between the two locations in VertexROI, and we have no way to figure out the 'new' position of that mirror vertex
-		// until we can look it up by VertexID, not array-index. So, we are going to bake in the new vertex positions for now.
-		const int32 NumV = ROIPositionBuffer.Num();
-		ParallelFor(NumV, [&](int32 k)
+		// if we are applying symmetry, we need to update the on-plane positions as they
+		// will not be in the SymmetricVertexROI
+		if (bApplySymmetry)
 		{
-			int VertIdx = VertexROI[k];
-			const FVector3d& NewPos = ROIPositionBuffer[k];
-			Mesh->SetVertex(VertIdx, NewPos, false);
-		});
+			// update position of vertices that are on the symmetry plane
+			Symmetry->ApplySymmetryPlaneConstraints(VertexROI, ROIPositionBuffer);
+
+			// currently something gross is that VertexROI/ROIPositionBuffer may have both a vertex and it's mirror vertex,
+			// each with a different position. We somehow need to be able to resolve this, but we don't have the mapping 
+			// between the two locations in VertexROI, and we have no way to figure out the 'new' position of that mirror vertex
+			// until we can look it up by VertexID, not array-index. So, we are going to bake in the new vertex positions for now.
+			const int32 NumV = ROIPositionBuffer.Num();
+			ParallelFor(NumV, [&](int32 k)
+			{
+				int VertIdx = VertexROI[k];
+				const FVector3d& NewPos = ROIPositionBuffer[k];
+				Mesh->SetVertex(VertIdx, NewPos, false);
+			});
+
+			// compute all the mirror vertex positions
+			Symmetry->ComputeSymmetryConstrainedPositions(VertexROI, SymmetricVertexROI, ROIPositionBuffer, SymmetricROIPositionBuffer);
+		}
+
+		// now actually update the mesh, which happens on the game thread
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE(VtxSculptTool_ApplyStamp_Sync);
+			const int32 NumV = ROIPositionBuffer.Num();
 
-		// compute all the mirror vertex positions
-		Symmetry->ComputeSymmetryConstrainedPositions(VertexROI, SymmetricVertexROI, ROIPositionBuffer, SymmetricROIPositionBuffer);
+			// If we are applying symmetry, we already baked these positions in in the branch above and
+			// can skip it now, otherwise we update the mesh (todo: profile ParallelFor here, is it helping or hurting?)
+			if (bApplySymmetry == false)
+			{
+				ParallelFor(NumV, [&](int32 k)
+				{
+					int VertIdx = VertexROI[k];
+					const FVector3d& NewPos = ROIPositionBuffer[k];
+					Mesh->SetVertex(VertIdx, NewPos, false);
+				});
+			}
+
+			// if applying symmetry, bake in new symmetric positions
+			if (bApplySymmetry)
+			{
+				ParallelFor(NumV, [&](int32 k)
+				{
+					int VertIdx = SymmetricVertexROI[k];
+					if (Mesh->IsVertex(VertIdx))
+					{
+						const FVector3d& NewPos = SymmetricROIPositionBuffer[k];
+						Mesh->SetVertex(VertIdx, NewPos, false);
+					}
+				});
+			}
+		}
 	}
 
-	// once stamp is applied, we can start updating vertex change, which can happen async as we saved all necessary info
+	// once all stamps are applied, we can start updating vertex change, which can happen async as we saved all necessary info.
+	// The ROI position buffers hold the positions after the last stamp, and the prev-position buffers those before the first.
 	TFuture<void> SaveVertexFuture;
 	if (ActiveVertexChange != nullptr)
 	{
@@ -827,39 +902,7 @@ TFuture<void> UMeshVertexSculptTool::ApplyStamp()
 		});
 	}
 
-	// now actually update the mesh, which happens on the game thread
-	{
-		TRACE_CPUPROFILER_EVENT_SCOPE(VtxSculptTool_ApplyStamp_Sync);
-		const int32 NumV = ROIPositionBuffer.Num();
-
-		// If we are applying symmetry, we already baked these positions in in the branch above and
-		// can skip it now, otherwise we update the mesh (todo: profile ParallelFor here, is it helping or hurting?)
-		if (bApplySymmetry == false)
-		{
-			ParallelFor(NumV, [&](int32 k)
-			{
-				int VertIdx = VertexROI[k];
-				const FVector3d& NewPos = ROIPositionBuffer[k];
-				Mesh->SetVertex(VertIdx, NewPos, false);
-			});
-		}
-
-		// if applying symmetry, bake in new symmetric positions
-		if (bApplySymmetry)
-		{
-			ParallelFor(NumV, [&](int32 k)
-			{
-				int VertIdx = SymmetricVertexROI[k];
-				if (Mesh->IsVertex(VertIdx))
-				{
-					const FVector3d& NewPos = SymmetricROIPositionBuffer[k];
-					Mesh->SetVertex(VertIdx, NewPos, false);
-				}
-			});
-		}
-
-		Mesh->UpdateChangeStamps(true, false);
-	}
+	Mesh->UpdateChangeStamps(true, false);
 
 	LastStamp = CurrentStamp;
 	LastStamp.TimeStamp = FDateTime::Now();
@@ -1043,7 +1086,7 @@ void UMeshVertexSculptTool::OnTick(float DeltaTime)
 		WaitForPendingUndoRedo();
 
 		// post rendering update
-		DynamicMeshComponent->FastNotifyTriangleVerticesUpdated(AccumulatedTriangleROI,
+		DynamicMeshComponent->FastNotifyTriangleVerticesUpdated(AccumulatedTriangleROIArray,
 			EMeshRenderAttributeFlags::Positions | EMeshRenderAttributeFlags::VertexNormals);
 		GetToolManager()->PostInvalidation();
 
@@ -1063,115 +1106,207 @@ void UMeshVertexSculptTool::OnTick(float DeltaTime)
 	{
 		//UE_LOG(LogTemp, Warning, TEXT("dt is %.3f, tick fps %.2f - roi size %d/%d"), DeltaTime, 1.0 / DeltaTime, VertexROI.Num(), TriangleROI.Num());
 		TRACE_CPUPROFILER_EVENT_SCOPE(VtxSculptTool_Tick_StrokeUpdate);
-		FDynamicMesh3* Mesh = GetSculptMesh();
+		UpdateStroke();
+	}
+	else if (bTargetDirty)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(VtxSculptTool_Tick_UpdateTarget);
+		check(InStroke() == false);
 
-		// update brush position
-		if (UpdateStampPosition(GetPendingStampRayWorld()) == false)
-		{
-			return;
-		}
-		UpdateStampPendingState();
-		if (IsStampPending() == false)
-		{
-			return;
-		}
+		// this spawns futures that we could allow to run while other things happen...
+		AccumulatedTriangleROI.GetIndices(AccumulatedTriangleROIArray);
+		UpdateBaseMesh(&AccumulatedTriangleROIArray);
+		AccumulatedTriangleROI.Reset();
 
-		// need to make sure previous stamp finished
-		WaitForPendingStampUpdate();
+		bTargetDirty = false;
+	}
 
-		// update sculpt ROI
-		UpdateROI(CurrentStamp.LocalFrame.Origin);
+}
 
-		// Append updated ROI to modified region (async). For some reason this is very expensive,
-		// maybe because of TSet? but we have a lot of time to do it.
-		TFuture<void> AccumulateROI = Async(VertexSculptToolAsyncExecTarget, [this]()
-		{
-			TRACE_CPUPROFILER_EVENT_SCOPE(VtxSculptTool_Tick_AccumROI);
-			for (int32 tid : TriangleROIArray)
-			{
-				AccumulatedTriangleROI.Add(tid);
-			}
-		});
 
-		// Start precomputing the normals ROI. This is currently the most expensive single thing we do next
-		// to Octree re-insertion, despite it being almost trivial. Why?!?
-		bool bUsingOverlayNormalsOut = false;
-		TFuture<void> NormalsROI = Async(VertexSculptToolAsyncExecTarget, [Mesh, &bUsingOverlayNormalsOut, this]()
-		{
-			TRACE_CPUPROFILER_EVENT_SCOPE(VtxSculptTool_Tick_NormalsROI);
+bool UMeshVertexSculptTool::UpdateStroke()
+{
+	FDynamicMesh3* Mesh = GetSculptMesh();
 
-			//UE::SculptUtil::PrecalculateNormalsROI(Mesh, TriangleROIArray, NormalsROIBuilder, bUsingOverlayNormals, false);
-			UE::SculptUtil::PrecalculateNormalsROI(Mesh, TriangleROIArray, NormalsFlags, bUsingOverlayNormalsOut, false);
-		});
+	// need to make sure previous stamp finished, as stamp positions may be found on the sculpt mesh
+	WaitForPendingStampUpdate();
+	if (UE::SculptUtil::FSculptStampTimings* StampTimings = UE::SculptUtil::FSculptStampTimings::GetActive())
+	{
+		StampTimings->EndStamp();
+	}
+
+	// update brush position for each stamp along the stroke since the last tick
+	if (CollectStampBatch() == false)
+	{
+		return false;
+	}
 
-		// NOTE: you might try to speculatively do the octree remove here, to save doing it later on Reinsert().
-		// This will not improve things, as Reinsert() checks if it needs to actually re-insert, which avoids many
-		// removes, and does much of the work of Remove anyway.
+	// update sculpt ROI, which covers all stamps in the batch
+	StampBatchPositions.Reset();
+	for (const FSculptBrushStamp& Stamp : StampBatch)
+	{
+		StampBatchPositions.Add(Stamp.LocalFrame.Origin);
+	}
+	{
+		UE::SculptUtil::FScopedSculptStampTimer StageTimer(UE::SculptUtil::ESculptStampStage::UpdateROI);
+		UpdateROI(StampBatchPositions);
+	}
 
-		// Apply the stamp. This will return a future that is updating the vertex-change record, 
-		// which can run until the end of the frame, as it is using cached information
-		TFuture<void> UpdateChangeFuture = ApplyStamp();
+	// Append updated ROI to modified region (async). This is just setting bits, but we have a lot of time to do it.
+	TFuture<void> AccumulateROI = Async(VertexSculptToolAsyncExecTarget, [this]()
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(VtxSculptTool_Tick_AccumROI);
+		AccumulatedTriangleROI.Add(TriangleROIArray);
+	});
 
-		// begin octree rebuild calculation
-		StampUpdateOctreeFuture = Async(VertexSculptToolAsyncExecTarget, [this]()
-		{
-			TRACE_CPUPROFILER_EVENT_SCOPE(VtxSculptTool_Tick_OctreeReinsert);
-			Octree.ReinsertTrianglesParallel(TriangleROIArray, OctreeUpdateTempBuffer, OctreeUpdateTempFlagBuffer);
-		});
-		bStampUpdatePending = true;
-		//TFuture<void> OctreeRebuild = Async(VertexSculptToolAsyncExecTarget, [&]()
-		//{
-		//	TRACE_CPUPROFILER_EVENT_SCOPE(VtxSculptTool_Tick_OctreeReinsert);
-		//	Octree.ReinsertTriangles(TriangleROIArray);
-		//});
-
-		// TODO: first step of RecalculateROINormals() is to convert TriangleROI into vertex or element ROI.
-		// We can do this while we are computing stamp!
-
-		// precompute dynamic mesh update info
-		TArray<int32> RenderUpdateSets; FAxisAlignedBox3d RenderUpdateBounds;
-		TFuture<bool> RenderUpdatePrecompute = DynamicMeshComponent->FastNotifyTriangleVerticesUpdated_TryPrecompute(
-				TriangleROIArray, RenderUpdateSets, RenderUpdateBounds);
-
-		// recalculate normals. This has to complete before we can update component
-		// (in fact we could do it per-chunk...)
+	// Start precomputing the normals ROI. This used to be the most expensive single thing we did next to
+	// Octree re-insertion, because of clearing and scanning flags over all the normal elements. Now it is a
+	// gather over cached adjacency that only touches the ROI.
+	TFuture<void> NormalsROI = Async(VertexSculptToolAsyncExecTarget, [Mesh, this]()
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(VtxSculptTool_Tick_NormalsROI);
+		UE::SculptUtil::FScopedSculptStampTimer StageTimer(UE::SculptUtil::ESculptStampStage::Normals);
+		NormalsROICache.UpdateForMesh(Mesh);
+		NormalsROICache.GatherNormalsROI(Mesh, TriangleROIArray, NormalsROIIndices);
+	});
+
+	// NOTE: you might try to speculatively do the octree remove here, to save doing it later on Reinsert().
+	// This will not improve things, as Reinsert() checks if it needs to actually re-insert, which avoids many
+	// removes, and does much of the work of Remove anyway.
+
+	// Apply the stamp. This will return a future that is updating the vertex-change record, 
+	// which can run until the end of the frame, as it is using cached information
+	TFuture<void> UpdateChangeFuture;
+	{
+		UE::SculptUtil::FScopedSculptStampTimer StageTimer(UE::SculptUtil::ESculptStampStage::ApplyStamp);
+		UpdateChangeFuture = ApplyStamp();
+	}
+
+	// begin octree rebuild calculation
+	StampUpdateOctreeFuture = Async(VertexSculptToolAsyncExecTarget, [this]()
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(VtxSculptTool_Tick_OctreeReinsert);
+		UE::SculptUtil::FScopedSculptStampTimer StageTimer(UE::SculptUtil::ESculptStampStage::OctreeReinsert);
+		Octree.ReinsertTrianglesParallel(TriangleROIArray, OctreeUpdateTempBuffer, OctreeUpdateTempFlagBuffer);
+	});
+	bStampUpdatePending = true;
+	//TFuture<void> OctreeRebuild = Async(VertexSculptToolAsyncExecTarget, [&]()
+	//{
+	//	TRACE_CPUPROFILER_EVENT_SCOPE(VtxSculptTool_Tick_OctreeReinsert);
+	//	Octree.ReinsertTriangles(TriangleROIArray);
+	//});
+
+	// TODO: first step of RecalculateROINormals() is to convert TriangleROI into vertex or element ROI.
+	// We can do this while we are computing stamp!
+
+	// precompute dynamic mesh update info
+	TArray<int32> RenderUpdateSets; FAxisAlignedBox3d RenderUpdateBounds;
+	TFuture<bool> RenderUpdatePrecompute = DynamicMeshComponent->FastNotifyTriangleVerticesUpdated_TryPrecompute(
+			TriangleROIArray, RenderUpdateSets, RenderUpdateBounds);
+
+	// recalculate normals. This has to complete before we can update component
+	// (in fact we could do it per-chunk...)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(VtxSculptTool_Tick_RecalcNormals);
+		NormalsROI.Wait();
+		UE::SculptUtil::FScopedSculptStampTimer StageTimer(UE::SculptUtil::ESculptStampStage::Normals);
+		NormalsROICache.RecalculateNormals(Mesh, NormalsROIIndices);
+	}
+
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(VtxSculptTool_Tick_UpdateMesh);
+		UE::SculptUtil::FScopedSculptStampTimer StageTimer(UE::SculptUtil::ESculptStampStage::RenderUpdate);
+		RenderUpdatePrecompute.Wait();
+		DynamicMeshComponent->FastNotifyTriangleVerticesUpdated_ApplyPrecompute(TriangleROIArray,
+			EMeshRenderAttributeFlags::Positions | EMeshRenderAttributeFlags::VertexNormals,
+			RenderUpdatePrecompute, RenderUpdateSets, RenderUpdateBounds);
+
+		GetToolManager()->PostInvalidation();
+	}
+
+	// we don't really need to wait for these to happen to end Tick()...
+	UpdateChangeFuture.Wait();
+	AccumulateROI.Wait();
+
+	return true;
+}
+
+
+void UMeshVertexSculptTool::FlushStrokeStamps()
+{
+	// stamp the stroke samples and the deferred stamp that have not been applied yet, otherwise the end of a
+	// fast stroke is lost when the change record is closed
+	while (PendingStrokeSampleRays.Num() > 0 || bHaveDeferredStamp)
+	{
+		if (UpdateStroke() == false)
 		{
-			TRACE_CPUPROFILER_EVENT_SCOPE(VtxSculptTool_Tick_RecalcNormals);
-			NormalsROI.Wait();
-			UE::SculptUtil::RecalculateROINormals(Mesh, NormalsFlags, bUsingOverlayNormalsOut);
-			//UE::SculptUtil::RecalculateROINormals(Mesh, NormalsROIBuilder.Indices(), bUsingOverlayNormals);
+			break;
 		}
+	}
+	WaitForPendingStampUpdate();
+}
 
-		{
-			TRACE_CPUPROFILER_EVENT_SCOPE(VtxSculptTool_Tick_UpdateMesh);
-			RenderUpdatePrecompute.Wait();
-			DynamicMeshComponent->FastNotifyTriangleVerticesUpdated_ApplyPrecompute(TriangleROIArray,
-				EMeshRenderAttributeFlags::Positions | EMeshRenderAttributeFlags::VertexNormals,
-				RenderUpdatePrecompute, RenderUpdateSets, RenderUpdateBounds);
 
-			GetToolManager()->PostInvalidation();
+bool UMeshVertexSculptTool::CollectStampBatch()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(VtxSculptTool_CollectStampBatch);
+
+	StampBatch.Reset();
+	if (bHaveDeferredStamp)
+	{
+		StampBatch.Add(DeferredStamp);
+		LastStamp = DeferredStamp;
+		bHaveDeferredStamp = false;
+	}
+
+	// without new stroke input, flow rate may still emit a stamp at the current position
+	if (PendingStrokeSampleRays.Num() == 0)
+	{
+		if (StampBatch.Num() == 0 && UpdateStampPosition(GetPendingStampRayWorld()))
+		{
+			UpdateStampPendingState();
+			if (IsStampPending())
+			{
+				StampBatch.Add(CurrentStamp);
+			}
 		}
+		return StampBatch.Num() > 0;
+	}
 
-		// we don't really need to wait for these to happen to end Tick()...
-		UpdateChangeFuture.Wait();
-		AccumulateROI.Wait();
-	} 
-	else if (bTargetDirty)
+	// Consume resampled stroke rays in order. Consecutive stamps are batched as long as each overlaps the
+	// previous one, a stamp that does not is kept for the next batch.
+	const int32 MaxStamps = UE::SculptUtil::GetMaxStampsPerBatch();
+	int32 NumConsumed = 0;
+	while (NumConsumed < PendingStrokeSampleRays.Num() && StampBatch.Num() < MaxStamps)
 	{
-		TRACE_CPUPROFILER_EVENT_SCOPE(VtxSculptTool_Tick_UpdateTarget);
-		check(InStroke() == false);
+		const FRay& SampleRay = PendingStrokeSampleRays[NumConsumed++];
+		if (UpdateStampPosition(SampleRay) == false)
+		{
+			continue;
+		}
+		UpdateStampPendingState();
+		if (IsStampPending() == false)
+		{
+			continue;
+		}
 
-		// this spawns futures that we could allow to run while other things happen...
-		UpdateBaseMesh(&AccumulatedTriangleROI);
-		AccumulatedTriangleROI.Reset();
+		// the next stamp is computed relative to this one
+		LastStamp = CurrentStamp;
 
-		bTargetDirty = false;
+		if (StampBatch.Num() > 0 && Distance(CurrentStamp.LocalFrame.Origin, StampBatch.Last().LocalFrame.Origin) > 2.0 * GetCurrentBrushRadius())
+		{
+			DeferredStamp = CurrentStamp;
+			bHaveDeferredStamp = true;
+			break;
+		}
+		StampBatch.Add(CurrentStamp);
 	}
+	PendingStrokeSampleRays.RemoveAt(0, NumConsumed, false);
 
+	return StampBatch.Num() > 0;
 }
 
 
-
 void UMeshVertexSculptTool::WaitForPendingStampUpdate()
 {
 	if (bStampUpdatePending)
@@ -1183,7 +1318,7 @@ void UMeshVertexSculptTool::WaitForPendingStampUpdate()
 
 
 
-void UMeshVertexSculptTool::UpdateBaseMesh(const TSet<int32>* TriangleSet)
+void UMeshVertexSculptTool::UpdateBaseMesh(const TArray<int32>* TriangleSet)
 {
 	if (SculptProperties != nullptr)
 	{
@@ -1275,9 +1410,9 @@ void UMeshVertexSculptTool::UpdateBrushAlpha(UTexture2D* NewAlpha)
 			const bool bReadOK = UE::AssetUtils::ReadTexture(this->BrushAlpha, AlphaValues, bPreferPlatformData);
 			if (bReadOK)
 			{
-				BrushAlphaValues = MoveTemp(AlphaValues);
-				BrushAlphaDimensions = AlphaValues.GetDimensions();
-				bHaveBrushAlpha = true;
+				// only the red channel is used, keep it as a mip chain so small stamps can sample a prefiltered level
+				BrushAlphaMips.Initialize(AlphaValues);
+				bHaveBrushAlpha = (BrushAlphaMips.IsEmpty() == false);
 
 				BrushIndicatorMaterial->SetTextureParameterValue(TEXT("BrushAlpha"), NewAlpha);
 				BrushIndicatorMaterial->SetScalarParameterValue(TEXT("AlphaPower"), 1.0);
@@ -1286,8 +1421,7 @@ void UMeshVertexSculptTool::UpdateBrushAlpha(UTexture2D* NewAlpha)
 			}
 		}
 		bHaveBrushAlpha = false;
-		BrushAlphaValues = TImageBuilder<FVector4f>();
-		BrushAlphaDimensions = FImageDimensions();
+		BrushAlphaMips.Reset();
 
 		BrushIndicatorMaterial->SetTextureParameterValue(TEXT("BrushAlpha"), nullptr);
 		BrushIndicatorMaterial->SetScalarParameterValue(TEXT("AlphaPower"), 0.0);
@@ -1295,21 +1429,65 @@ void UMeshVertexSculptTool::UpdateBrushAlpha(UTexture2D* NewAlpha)
 }
 
 
+FVector2d UMeshVertexSculptTool::GetBrushAlphaUV(const FSculptBrushStamp& Stamp, const FVector3d& Position) const
+{
+	// stamp disc maps to [0,1], flipped to match the brush indicator. Tiling scales around the stamp center
+	FVector2d AlphaUV = Stamp.LocalFrame.ToPlaneUV(Position, 2);
+	double u = 0.5 - 0.5 * StampAlphaTiling * AlphaUV.X / Stamp.Radius;
+	double v = 0.5 - 0.5 * StampAlphaTiling * AlphaUV.Y / Stamp.Radius;
+	return FVector2d(u, v);
+}
+
+
 double UMeshVertexSculptTool::SampleBrushAlpha(const FSculptBrushStamp& Stamp, const FVector3d& Position) const
 {
 	if (! bHaveBrushAlpha) return 1.0;
 
-	static const FVector4f InvalidValue(0, 0, 0, 0);
+	FVector2d AlphaUV = GetBrushAlphaUV(Stamp, Position);
+	float AlphaValue = BrushAlphaMips.Sample((float)AlphaUV.X, (float)AlphaUV.Y, StampAlphaLOD, StampAlphaTiling > 1.0);
+	return FMathd::Clamp(AlphaValue, 0.0, 1.0);
+}
+
 
-	FVector2d AlphaUV = Stamp.LocalFrame.ToPlaneUV(Position, 2);
-	double u = AlphaUV.X / Stamp.Radius;
-	u = 1.0 - (u + 1.0) / 2.0;
-	double v = AlphaUV.Y / Stamp.Radius;
-	v = 1.0 - (v + 1.0) / 2.0;
-	if (u < 0 || u > 1) return 0.0;
-	if (v < 0 || v > 1) return 0.0;
-	FVector4f AlphaValue = BrushAlphaValues.BilinearSampleUV<float>(FVector2d(u, v), InvalidValue);
-	return FMathd::Clamp(AlphaValue.X, 0.0, 1.0);
+void UMeshVertexSculptTool::UpdateStampAlpha(const FDynamicMesh3* Mesh)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(VtxSculptTool_UpdateStampAlpha);
+
+	StampAlphaTiling = FMath::Max((double)AlphaProperties->Tiling, 1.0);
+
+	// Estimate vertex spacing under the stamp from a sample of ROI triangles, and pick the alpha
+	// level at which one texel is about one vertex apart. Finer levels would only alias.
+	constexpr int32 MaxSpacingSamples = 64;
+	const int32 NumTriangles = TriangleROIArray.Num();
+	const int32 SampleStep = FMath::Max(NumTriangles / MaxSpacingSamples, 1);
+	double EdgeLengthSum = 0;
+	int32 EdgeCount = 0;
+	for (int32 k = 0; k < NumTriangles; k += SampleStep)
+	{
+		FVector3d A, B, C;
+		Mesh->GetTriVertices(TriangleROIArray[k], A, B, C);
+		EdgeLengthSum += Distance(A, B) + Distance(B, C) + Distance(C, A);
+		EdgeCount += 3;
+	}
+	StampAlphaLOD = 0.0f;
+	if (EdgeCount > 0 && CurrentStamp.Radius > 0)
+	{
+		double VertexSpacingUV = (EdgeLengthSum / (double)EdgeCount) * StampAlphaTiling / (2.0 * CurrentStamp.Radius);
+		StampAlphaLOD = BrushAlphaMips.ComputeLOD(VertexSpacingUV);
+	}
+
+	const int32 NumV = VertexROI.Num();
+	ROIAlphaUVBuffer.SetNum(NumV, false);
+	ROIAlphaBuffer.SetNum(NumV, false);
+	ParallelFor(NumV, [&](int32 k)
+	{
+		ROIAlphaUVBuffer[k] = (FVector2f)GetBrushAlphaUV(CurrentStamp, Mesh->GetVertex(VertexROI[k]));
+	});
+	BrushAlphaMips.SampleBatch(ROIAlphaUVBuffer, StampAlphaLOD, StampAlphaTiling > 1.0, ROIAlphaBuffer);
+	for (float& Alpha : ROIAlphaBuffer)
+	{
+		Alpha = FMath::Clamp(Alpha, 0.0f, 1.0f);
+	}
 }
 
 
@@ -1393,26 +1571,34 @@ void UMeshVertexSculptTool::OnDynamicMeshComponentChanged(UDynamicMeshComponent*
 
 	// figure out the set of modified triangles
 	AccumulatedTriangleROI.Reset();
-	UE::Geometry::VertexToTriangleOneRing(Mesh, Change->Vertices, AccumulatedTriangleROI);
+	AccumulatedTriangleROI.Grow(Mesh->MaxTriangleID());
+	for (int32 VertexID : Change->Vertices)
+	{
+		Mesh->EnumerateVertexTriangles(VertexID, [&](int32 tid) { AccumulatedTriangleROI.Add(tid); });
+	}
+	AccumulatedTriangleROI.GetIndices(AccumulatedTriangleROIArray);
+	AccumulatedTriangleROI.Reset();
 
 	// start the normal recomputation
 	UndoNormalsFuture = Async(VertexSculptToolAsyncExecTarget, [this, Mesh]()
 	{
-		UE::SculptUtil::RecalculateROINormals(Mesh, AccumulatedTriangleROI, NormalsROIBuilder);
+		NormalsROICache.UpdateForMesh(Mesh);
+		NormalsROICache.GatherNormalsROI(Mesh, AccumulatedTriangleROIArray, NormalsROIIndices);
+		NormalsROICache.RecalculateNormals(Mesh, NormalsROIIndices);
 		return true;
 	});
 
 	// start the octree update
 	UndoUpdateOctreeFuture = Async(VertexSculptToolAsyncExecTarget, [this, Mesh]()
 	{
-		Octree.ReinsertTriangles(AccumulatedTriangleROI);
+		Octree.ReinsertTriangles(AccumulatedTriangleROIArray);
 		return true;
 	});
 
 	// start the base mesh update
 	UndoUpdateBaseMeshFuture = Async(VertexSculptToolAsyncExecTarget, [this, Mesh]()
 	{
-		UpdateBaseMesh(&AccumulatedTriangleROI);
+		UpdateBaseMesh(&AccumulatedTriangleROIArray);
 		return true;
 	});
 
@@ -0,0 +1,416 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Sculpting/MeshSculptStrokeRecorder.h"
+#include "DynamicMesh/DynamicMesh3.h"
+#include "InteractiveTool.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Hash/CityHash.h"
+#include "UObject/UnrealType.h"
+
+using namespace UE::Geometry;
+
+namespace
+{
+	TAutoConsoleVariable<bool> CVarSculptRecordStrokes(
+		TEXT("modeling.Sculpting.RecordStrokes"),
+		false,
+		TEXT("Record the input of sculpt tools into Saved/Sculpting when the tool is closed, for replay with the MeshModeling.Sculpting.StrokeReplay automation test."));
+
+	const TCHAR* SculptStrokeRecordingHeader = TEXT("SculptStrokeRecording 1");
+
+	const TCHAR* StrokeEventTypeNames[] = { TEXT("Begin"), TEXT("Update"), TEXT("End"), TEXT("Tick") };
+
+	double GetNormalizedScale(const FAxisAlignedBox3d& LocalBounds)
+	{
+		return FMathd::Max(LocalBounds.MaxDim(), FMathd::ZeroTolerance);
+	}
+}
+
+
+
+//
+// FSculptStrokeRecording
+//
+
+bool UE::SculptUtil::FSculptStrokeRecording::SaveToFile(const FString& Path) const
+{
+	TArray<FString> Lines;
+	Lines.Add(SculptStrokeRecordingHeader);
+	Lines.Add(FString::Printf(TEXT("Tool %s"), *ToolClass));
+	for (const FSculptStroke& Stroke : Strokes)
+	{
+		const FViewCameraState& Camera = Stroke.CameraState;
+		const FQuat& Rot = Camera.Orientation;
+		Lines.Add(FString::Printf(TEXT("Stroke %d %d"), Stroke.bShiftToggle ? 1 : 0, Stroke.bCtrlToggle ? 1 : 0));
+		Lines.Add(FString::Printf(TEXT("Camera %.17g %.17g %.17g %.17g %.17g %.17g %.17g %.9g %.9g %d %.17g"),
+			Camera.Position.X, Camera.Position.Y, Camera.Position.Z, Rot.X, Rot.Y, Rot.Z, Rot.W,
+			Camera.HorizontalFOVDegrees, Camera.AspectRatio, Camera.bIsOrthographic ? 1 : 0, Camera.OrthoWorldCoordinateWidth));
+		for (const FString& Property : Stroke.Properties)
+		{
+			Lines.Add(TEXT("Property ") + Property);
+		}
+		for (const FSculptStrokeEvent& Event : Stroke.Events)
+		{
+			if (Event.Type == ESculptStrokeEventType::Tick)
+			{
+				Lines.Add(FString::Printf(TEXT("%s %.17g %.9g %.9g"), StrokeEventTypeNames[(int32)Event.Type], Event.Time, Event.DeltaTime, Event.Pressure));
+			}
+			else
+			{
+				Lines.Add(FString::Printf(TEXT("%s %.17g %.17g %.17g %.17g %.17g %.17g %.17g"), StrokeEventTypeNames[(int32)Event.Type], Event.Time,
+					Event.RayOrigin.X, Event.RayOrigin.Y, Event.RayOrigin.Z, Event.RayDirection.X, Event.RayDirection.Y, Event.RayDirection.Z));
+			}
+		}
+	}
+
+	return FFileHelper::SaveStringArrayToFile(Lines, *Path);
+}
+
+
+bool UE::SculptUtil::FSculptStrokeRecording::LoadFromFile(const FString& Path)
+{
+	ToolClass.Reset();
+	Strokes.Reset();
+
+	TArray<FString> Lines;
+	if (FFileHelper::LoadFileToStringArray(Lines, *Path) == false || Lines.Num() == 0 || Lines[0].TrimEnd() != SculptStrokeRecordingHeader)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Cannot load sculpt stroke recording %s"), *Path);
+		return false;
+	}
+
+	TArray<FString> Tokens;
+	for (int32 LineIndex = 1; LineIndex < Lines.Num(); ++LineIndex)
+	{
+		const FString& Line = Lines[LineIndex];
+
+		// property values may contain whitespace, take everything after the keyword
+		if (Line.StartsWith(TEXT("Property ")))
+		{
+			if (Strokes.Num() > 0)
+			{
+				Strokes.Last().Properties.Add(Line.RightChop(9));
+			}
+			continue;
+		}
+
+		Line.ParseIntoArrayWS(Tokens);
+		if (Tokens.Num() == 0)
+		{
+			continue;
+		}
+
+		auto Num = [&Tokens](int32 k) { return FCString::Atod(*Tokens[k]); };
+
+		if (Tokens[0] == TEXT("Tool") && Tokens.Num() == 2)
+		{
+			ToolClass = Tokens[1];
+		}
+		else if (Tokens[0] == TEXT("Stroke") && Tokens.Num() == 3)
+		{
+			FSculptStroke& Stroke = Strokes.AddDefaulted_GetRef();
+			Stroke.bShiftToggle = (Tokens[1] == TEXT("1"));
+			Stroke.bCtrlToggle = (Tokens[2] == TEXT("1"));
+		}
+		else if (Tokens[0] == TEXT("Camera") && Tokens.Num() == 12 && Strokes.Num() > 0)
+		{
+			FViewCameraState& Camera = Strokes.Last().CameraState;
+			Camera.Position = FVector(Num(1), Num(2), Num(3));
+			Camera.Orientation = FQuat(Num(4), Num(5), Num(6), Num(7));
+			Camera.HorizontalFOVDegrees = (float)Num(8);
+			Camera.AspectRatio = (float)Num(9);
+			Camera.bIsOrthographic = (Tokens[10] == TEXT("1"));
+			Camera.OrthoWorldCoordinateWidth = (float)Num(11);
+		}
+		else if (Tokens[0] == StrokeEventTypeNames[(int32)ESculptStrokeEventType::Tick] && Tokens.Num() == 4 && Strokes.Num() > 0)
+		{
+			FSculptStrokeEvent& Event = Strokes.Last().Events.AddDefaulted_GetRef();
+			Event.Type = ESculptStrokeEventType::Tick;
+			Event.Time = Num(1);
+			Event.DeltaTime = (float)Num(2);
+			Event.Pressure = (float)Num(3);
+		}
+		else if (Tokens.Num() == 8 && Strokes.Num() > 0)
+		{
+			int32 TypeIndex = 0;
+			while (TypeIndex < (int32)ESculptStrokeEventType::Tick && Tokens[0] != StrokeEventTypeNames[TypeIndex])
+			{
+				TypeIndex++;
+			}
+			if (TypeIndex == (int32)ESculptStrokeEventType::Tick)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Ignoring line %d of sculpt stroke recording %s"), LineIndex + 1, *Path);
+				continue;
+			}
+			FSculptStrokeEvent& Event = Strokes.Last().Events.AddDefaulted_GetRef();
+			Event.Type = (ESculptStrokeEventType)TypeIndex;
+			Event.Time = Num(1);
+			Event.RayOrigin = FVector3d(Num(2), Num(3), Num(4));
+			Event.RayDirection = FVector3d(Num(5), Num(6), Num(7));
+		}
+		else
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Ignoring line %d of sculpt stroke recording %s"), LineIndex + 1, *Path);
+		}
+	}
+
+	return ToolClass.Len() > 0;
+}
+
+
+FVector3d UE::SculptUtil::FSculptStrokeRecording::ToNormalizedPosition(const FVector3d& WorldPos, const FTransformSRT3d& TargetTransform, const FAxisAlignedBox3d& LocalBounds)
+{
+	return (TargetTransform.InverseTransformPosition(WorldPos) - LocalBounds.Center()) / GetNormalizedScale(LocalBounds);
+}
+
+FVector3d UE::SculptUtil::FSculptStrokeRecording::ToWorldPosition(const FVector3d& NormalizedPos, const FTransformSRT3d& TargetTransform, const FAxisAlignedBox3d& LocalBounds)
+{
+	return TargetTransform.TransformPosition(LocalBounds.Center() + NormalizedPos * GetNormalizedScale(LocalBounds));
+}
+
+FVector3d UE::SculptUtil::FSculptStrokeRecording::ToNormalizedDirection(const FVector3d& WorldDir, const FTransformSRT3d& TargetTransform)
+{
+	return UE::Geometry::Normalized(TargetTransform.InverseTransformVector(WorldDir));
+}
+
+FVector3d UE::SculptUtil::FSculptStrokeRecording::ToWorldDirection(const FVector3d& NormalizedDir, const FTransformSRT3d& TargetTransform)
+{
+	return UE::Geometry::Normalized(TargetTransform.TransformVector(NormalizedDir));
+}
+
+
+void UE::SculptUtil::FSculptStrokeRecording::CaptureProperties(const TArray<UObject*>& PropertySets, TArray<FString>& PropertiesOut)
+{
+	for (UObject* PropertySet : PropertySets)
+	{
+		if (PropertySet == nullptr)
+		{
+			continue;
+		}
+		const FString ClassName = PropertySet->GetClass()->GetName();
+		for (TFieldIterator<FProperty> PropIt(PropertySet->GetClass()); PropIt; ++PropIt)
+		{
+			FProperty* Property = *PropIt;
+			if (Property->HasAnyPropertyFlags(CPF_Edit) && Property->HasAnyPropertyFlags(CPF_EditConst) == false)
+			{
+				FString Value;
+				Property->ExportText_InContainer(0, Value, PropertySet, nullptr, PropertySet, PPF_None);
+				PropertiesOut.Add(FString::Printf(TEXT("%s.%s=%s"), *ClassName, *Property->GetName(), *Value));
+			}
+		}
+	}
+}
+
+int32 UE::SculptUtil::FSculptStrokeRecording::ApplyProperties(const TArray<FString>& Properties, UInteractiveTool* Tool)
+{
+	TArray<UObject*> PropertySets = Tool->GetToolProperties(false);
+
+	int32 NumApplied = 0;
+	for (const FString& PropertyString : Properties)
+	{
+		FString Key, Value, ClassName, PropertyName;
+		if (PropertyString.Split(TEXT("="), &Key, &Value) == false || Key.Split(TEXT("."), &ClassName, &PropertyName) == false)
+		{
+			continue;
+		}
+
+		UObject** Found = PropertySets.FindByPredicate([&ClassName](UObject* PropertySet) { return PropertySet != nullptr && PropertySet->GetClass()->GetName() == ClassName; });
+		FProperty* Property = (Found != nullptr) ? FindFProperty<FProperty>((*Found)->GetClass(), *PropertyName) : nullptr;
+		if (Property != nullptr && Property->ImportText_InContainer(*Value, *Found, *Found, PPF_None) != nullptr)
+		{
+			Tool->OnPropertyModified(*Found, Property);
+			NumApplied++;
+		}
+	}
+	return NumApplied;
+}
+
+
+
+//
+// FSculptStrokeRecorder
+//
+
+void UE::SculptUtil::FSculptStrokeRecorder::BeginRecording(const UInteractiveTool* Tool, const FTransformSRT3d& TargetTransformIn, const FAxisAlignedBox3d& LocalBoundsIn)
+{
+	bRecording = CVarSculptRecordStrokes.GetValueOnGameThread() && bReplaying == false;
+	bInStroke = false;
+	TargetTransform = TargetTransformIn;
+	LocalBounds = LocalBoundsIn;
+	Recording = FSculptStrokeRecording();
+	Recording.ToolClass = Tool->GetClass()->GetName();
+}
+
+void UE::SculptUtil::FSculptStrokeRecorder::EndRecording()
+{
+	if (bRecording && Recording.Strokes.Num() > 0)
+	{
+		const FString Dir = FPaths::ProjectSavedDir() / TEXT("Sculpting");
+		IFileManager::Get().MakeDirectory(*Dir, true);
+		const FString Path = Dir / FString::Printf(TEXT("Strokes_%s_%s.txt"), *Recording.ToolClass, *FDateTime::Now().ToString());
+		if (Recording.SaveToFile(Path))
+		{
+			UE_LOG(LogTemp, Display, TEXT("Saved %d sculpt strokes to %s"), Recording.Strokes.Num(), *Path);
+		}
+	}
+	bRecording = false;
+	bInStroke = false;
+	Recording = FSculptStrokeRecording();
+}
+
+void UE::SculptUtil::FSculptStrokeRecorder::RecordBeginDrag(const FRay& WorldRay, const UInteractiveTool* Tool, const FViewCameraState& CameraState, bool bShiftToggle, bool bCtrlToggle)
+{
+	if (bRecording == false)
+	{
+		return;
+	}
+
+	FSculptStroke& Stroke = Recording.Strokes.AddDefaulted_GetRef();
+	Stroke.bShiftToggle = bShiftToggle;
+	Stroke.bCtrlToggle = bCtrlToggle;
+	Stroke.CameraState = CameraState;
+	Stroke.CameraState.Position = (FVector)FSculptStrokeRecording::ToNormalizedPosition((FVector3d)CameraState.Position, TargetTransform, LocalBounds);
+	Stroke.CameraState.Orientation = ((FQuat)TargetTransform.GetRotation()).Inverse() * CameraState.Orientation;
+	Stroke.CameraState.OrthoWorldCoordinateWidth = (float)(CameraState.OrthoWorldCoordinateWidth / GetNormalizedScale(LocalBounds));
+	FSculptStrokeRecording::CaptureProperties(Tool->GetToolProperties(false), Stroke.Properties);
+
+	bInStroke = true;
+	StrokeStartTime = FPlatformTime::Seconds();
+	AddDragEvent(ESculptStrokeEventType::BeginDrag, WorldRay);
+}
+
+void UE::SculptUtil::FSculptStrokeRecorder::RecordUpdateDrag(const FRay& WorldRay)
+{
+	if (bRecording && bInStroke)
+	{
+		AddDragEvent(ESculptStrokeEventType::UpdateDrag, WorldRay);
+	}
+}
+
+void UE::SculptUtil::FSculptStrokeRecorder::RecordEndDrag(const FRay& WorldRay)
+{
+	if (bRecording && bInStroke)
+	{
+		AddDragEvent(ESculptStrokeEventType::EndDrag, WorldRay);
+		bInStroke = false;
+	}
+}
+
+void UE::SculptUtil::FSculptStrokeRecorder::RecordTick(float DeltaTime, float Pressure)
+{
+	if (bRecording && bInStroke)
+	{
+		FSculptStrokeEvent& Event = Recording.Strokes.Last().Events.AddDefaulted_GetRef();
+		Event.Type = ESculptStrokeEventType::Tick;
+		Event.Time = FPlatformTime::Seconds() - StrokeStartTime;
+		Event.DeltaTime = DeltaTime;
+		Event.Pressure = Pressure;
+	}
+}
+
+void UE::SculptUtil::FSculptStrokeRecorder::AddDragEvent(ESculptStrokeEventType Type, const FRay& WorldRay)
+{
+	FSculptStrokeEvent& Event = Recording.Strokes.Last().Events.AddDefaulted_GetRef();
+	Event.Type = Type;
+	Event.Time = FPlatformTime::Seconds() - StrokeStartTime;
+	Event.RayOrigin = FSculptStrokeRecording::ToNormalizedPosition((FVector3d)WorldRay.Origin, TargetTransform, LocalBounds);
+	Event.RayDirection = FSculptStrokeRecording::ToNormalizedDirection((FVector3d)WorldRay.Direction, TargetTransform);
+}
+
+void UE::SculptUtil::FSculptStrokeRecorder::SetReplayInput(float Pressure, const FViewCameraState& CameraState)
+{
+	ReplayPressure = Pressure;
+	ReplayCameraState = CameraState;
+}
+
+
+
+//
+// FSculptStampTimings
+//
+
+UE::SculptUtil::FSculptStampTimings* UE::SculptUtil::FSculptStampTimings::ActiveTimings = nullptr;
+
+UE::SculptUtil::FSculptStampTimings::FSculptStampTimings()
+{
+	for (std::atomic<uint64>& Cycles : OpenStampCycles)
+	{
+		Cycles = 0;
+	}
+}
+
+void UE::SculptUtil::FSculptStampTimings::AddStageTime(ESculptStampStage Stage, uint64 Cycles)
+{
+	OpenStampCycles[(int32)Stage].fetch_add(Cycles, std::memory_order_relaxed);
+}
+
+void UE::SculptUtil::FSculptStampTimings::EndStamp()
+{
+	TStaticArray<double, (int32)ESculptStampStage::Num> Row;
+	bool bAnyTimed = false;
+	for (int32 k = 0; k < (int32)ESculptStampStage::Num; ++k)
+	{
+		uint64 Cycles = OpenStampCycles[k].exchange(0);
+		Row[k] = FPlatformTime::ToMilliseconds64(Cycles);
+		bAnyTimed = bAnyTimed || (Cycles > 0);
+	}
+	if (bAnyTimed)
+	{
+		StampMs.Add(Row);
+	}
+}
+
+double UE::SculptUtil::FSculptStampTimings::GetTotalMs(ESculptStampStage Stage) const
+{
+	double Total = 0;
+	for (const TStaticArray<double, (int32)ESculptStampStage::Num>& Row : StampMs)
+	{
+		Total += Row[(int32)Stage];
+	}
+	return Total;
+}
+
+FString UE::SculptUtil::FSculptStampTimings::GetCSVHeader()
+{
+	return TEXT("Label,Stamp,UpdateROI_ms,ApplyStamp_ms,Remesh_ms,OctreeReinsert_ms,Normals_ms,RenderUpdate_ms\n");
+}
+
+void UE::SculptUtil::FSculptStampTimings::AppendCSV(const FString& Label, FString& CSVOut) const
+{
+	for (int32 StampIndex = 0; StampIndex < StampMs.Num(); ++StampIndex)
+	{
+		CSVOut += FString::Printf(TEXT("%s,%d"), *Label, StampIndex);
+		for (double Ms : StampMs[StampIndex])
+		{
+			CSVOut += FString::Printf(TEXT(",%.4f"), Ms);
+		}
+		CSVOut += TEXT("\n");
+	}
+}
+
+
+
+uint64 UE::SculptUtil::ComputeSculptMeshHash(const FDynamicMesh3& Mesh)
+{
+	uint64 Hash = 0;
+	for (int32 vid : Mesh.VertexIndicesItr())
+	{
+		const FVector3d Pos = Mesh.GetVertex(vid);
+		Hash = CityHash64WithSeed((const char*)&vid, sizeof(int32), Hash);
+		Hash = CityHash64WithSeed((const char*)&Pos, sizeof(FVector3d), Hash);
+	}
+	for (int32 tid : Mesh.TriangleIndicesItr())
+	{
+		const FIndex3i Tri = Mesh.GetTriangle(tid);
+		Hash = CityHash64WithSeed((const char*)&tid, sizeof(int32), Hash);
+		Hash = CityHash64WithSeed((const char*)&Tri, sizeof(FIndex3i), Hash);
+	}
+	return Hash;
+}
+
+
+
+#include "Tests/MeshSculptStrokeReplay_Tests.inl"
@@ -12,6 +12,7 @@
 #include "Drawing/MeshDebugDrawing.h"
 
 #include "Sculpting/StampFalloffs.h"
+#include "Sculpting/MeshSculptUtil.h"
 
 #include "Generators/SphereGenerator.h"
 
@@ -160,6 +161,8 @@ void UMeshSculptToolBase::OnCompleteSetup()
 	{
 		SetToolPropertySourceEnabled(Pair.Value, false);
 	}
+
+	StrokeRecorder.BeginRecording(this, CurTargetTransform, GetSculptMesh()->GetBounds(true));
 }
 
 
@@ -173,6 +176,8 @@ void UMeshSculptToolBase::Shutdown(EToolShutdownType ShutdownType)
 
 	UMeshSurfacePointTool::Shutdown(ShutdownType);
 
+	StrokeRecorder.EndRecording();
+
 	BrushIndicatorMesh->Disconnect();
 	BrushIndicatorMesh = nullptr;
 
@@ -231,7 +236,9 @@ void UMeshSculptToolBase::OnTick(float DeltaTime)
 	GizmoPositionWatcher.CheckAndUpdate();
 	GizmoRotationWatcher.CheckAndUpdate();
 
-	ActivePressure = GetCurrentDevicePressure();
+	StrokeRecorder.GetReplayCameraState(CameraState);
+	ActivePressure = StrokeRecorder.GetPressure(GetCurrentDevicePressure());
+	StrokeRecorder.RecordTick(DeltaTime, (float)ActivePressure);
 
 	if (InStroke() == false)
 	{
@@ -538,10 +545,13 @@ bool UMeshSculptToolBase::HitTest(const FRay& Ray, FHitResult& OutHit)
 void UMeshSculptToolBase::OnBeginDrag(const FRay& WorldRay)
 {
 	SaveActiveStrokeModifiers();
+	StrokeRecorder.GetReplayCameraState(CameraState);
 
 	FHitResult OutHit;
 	if (HitTest(WorldRay, OutHit))
 	{
+		StrokeRecorder.RecordBeginDrag(WorldRay, this, CameraState, GetShiftToggle(), GetCtrlToggle());
+
 		bInStroke = true;
 		ResetStrokeTime();
 
@@ -550,6 +560,8 @@ void UMeshSculptToolBase::OnBeginDrag(const FRay& WorldRay)
 		// initialize first stamp
 		PendingStampRay = WorldRay;
 		bIsStampPending = true;
+		PendingStrokeSampleRays.Reset();
+		LastStrokeInputRay = WorldRay;
 
 		// set falloff
 		PrimaryBrushOp->Falloff = PrimaryFalloff;
@@ -562,16 +574,28 @@ void UMeshSculptToolBase::OnUpdateDrag(const FRay& WorldRay)
 {
 	if (InStroke())
 	{
+		StrokeRecorder.RecordUpdateDrag(WorldRay);
+
 		PendingStampRay = WorldRay;
+		if (WantsStrokeResampling())
+		{
+			AddStrokeInputRay(WorldRay);
+		}
 	}
 }
 
 void UMeshSculptToolBase::OnEndDrag(const FRay& Ray)
 {
+	StrokeRecorder.RecordEndDrag(Ray);
+
+	// the last samples of the stroke still belong in this change record
+	FlushStrokeStamps();
+
 	bInStroke = false;
 
 	// cancel any outstanding stamps! otherwise change record could become invalid
 	bIsStampPending = false;
+	PendingStrokeSampleRays.Reset();
 
 	OnEndStroke();
 
@@ -579,6 +603,35 @@ void UMeshSculptToolBase::OnEndDrag(const FRay& Ray)
 
 
 
+double UMeshSculptToolBase::GetStrokeSampleSpacing()
+{
+	if (BrushProperties->Spacing > 0 && GetActiveBrushOp()->SupportsVariableSpacing())
+	{
+		return BrushProperties->Spacing * (2 * GetCurrentBrushRadius());
+	}
+	return UE::SculptUtil::GetContinuousStrokeSampleSpacing(GetCurrentBrushRadius());
+}
+
+void UMeshSculptToolBase::AddStrokeInputRay(const FRay& WorldRay)
+{
+	// a single input segment is not subdivided further than this...
+	constexpr int32 MaxSamplesPerInputRay = 16;
+	// ...and if the tool falls behind, the oldest samples are dropped so stamps don't lag too far behind the cursor
+	constexpr int32 MaxPendingSamples = 64;
+
+	// measure spacing at the depth of the current brush position
+	double BrushDepth = (LastBrushFrameWorld.Origin - (FVector3d)LastStrokeInputRay.Origin).Dot((FVector3d)LastStrokeInputRay.Direction);
+	UE::SculptUtil::ResampleStrokeRays(LastStrokeInputRay, WorldRay, FMathd::Max(BrushDepth, 0.0), GetStrokeSampleSpacing(),
+		MaxSamplesPerInputRay, PendingStrokeSampleRays);
+	LastStrokeInputRay = WorldRay;
+
+	if (PendingStrokeSampleRays.Num() > MaxPendingSamples)
+	{
+		PendingStrokeSampleRays.RemoveAt(0, PendingStrokeSampleRays.Num() - MaxPendingSamples, false);
+	}
+}
+
+
 FRay3d UMeshSculptToolBase::GetLocalRay(const FRay& WorldRay) const
 {
 	FRay3d LocalRay(CurTargetTransform.InverseTransformPosition((FVector3d)WorldRay.Origin),
@@ -3,9 +3,54 @@
 #include "Sculpting/MeshSculptUtil.h"
 #include "Async/ParallelFor.h"
 #include "Async/Async.h"
+#include "HAL/IConsoleManager.h"
+#include "Changes/MeshVertexChange.h"
 
 using namespace UE::Geometry;
 
+namespace
+{
+	TAutoConsoleVariable<float> CVarSculptStrokeSampleSpacing(
+		TEXT("modeling.Sculpting.StrokeSampleSpacing"),
+		0.25f,
+		TEXT("Distance between interpolated stroke stamps, as a fraction of the brush radius, for brushes without explicit stamp spacing."));
+
+	TAutoConsoleVariable<int32> CVarSculptMaxStampsPerBatch(
+		TEXT("modeling.Sculpting.MaxStampsPerBatch"),
+		8,
+		TEXT("Maximum number of overlapping stroke stamps that are applied together with a single ROI, octree and normals update."));
+}
+
+double UE::SculptUtil::GetContinuousStrokeSampleSpacing(double BrushRadius)
+{
+	return FMath::Max((double)CVarSculptStrokeSampleSpacing.GetValueOnGameThread(), 0.01) * BrushRadius;
+}
+
+int32 UE::SculptUtil::GetMaxStampsPerBatch()
+{
+	return FMath::Max(CVarSculptMaxStampsPerBatch.GetValueOnGameThread(), 1);
+}
+
+void UE::SculptUtil::ResampleStrokeRays(const FRay& StartRay, const FRay& EndRay, double BrushDepth, double SampleSpacing, int32 MaxSamples, TArray<FRay>& RaysOut)
+{
+	const FVector3d StartPos = (FVector3d)StartRay.PointAt(BrushDepth);
+	const FVector3d EndPos = (FVector3d)EndRay.PointAt(BrushDepth);
+	int32 NumSamples = 1;
+	if (SampleSpacing > 0)
+	{
+		NumSamples = (int32)FMath::Clamp(FMathd::Ceil(Distance(StartPos, EndPos) / SampleSpacing), 1.0, (double)FMath::Max(MaxSamples, 1));
+	}
+
+	for (int32 k = 1; k < NumSamples; ++k)
+	{
+		const double t = (double)k / (double)NumSamples;
+		FVector Origin = FMath::Lerp(StartRay.Origin, EndRay.Origin, t);
+		FVector Direction = FMath::Lerp(StartRay.Direction, EndRay.Direction, t);
+		RaysOut.Add(FRay(Origin, Direction.GetSafeNormal(SMALL_NUMBER, EndRay.Direction), true));
+	}
+	RaysOut.Add(EndRay);
+}
+
 void UE::SculptUtil::RecalculateNormals_Overlay(
 	FDynamicMesh3* Mesh, 
 	const TSet<int32>& ModifiedTris, 
@@ -210,6 +255,141 @@ namespace
 
 
 
+void UE::SculptUtil::FAtomicIndexFlags::ClearIndices(const TArray<int32>& Indices)
+{
+	ParallelFor(Indices.Num(), [&](int32 k)
+	{
+		Words[Indices[k] >> 5].store(0, std::memory_order_relaxed);
+	});
+}
+
+
+// Run Body(Index, OutBuffer) for Index in [0,Num) in parallel blocks, where each block appends to its own buffer,
+// and then concatenate the per-block buffers into Output
+template<typename BodyFuncType>
+static void ParallelGatherIndices(int32 Num, TArray<int32>& Output, BodyFuncType&& Body)
+{
+	constexpr int32 BlockSize = 1024;
+	int32 Blocks = (Num / BlockSize) + 1;
+	TArray<TArray<int32>> BlockBuffers;
+	BlockBuffers.SetNum(Blocks);
+	ParallelFor(Blocks, [&](int32 bi)
+	{
+		TArray<int32>& Buffer = BlockBuffers[bi];
+		int32 End = FMath::Min(Num, (bi + 1) * BlockSize);
+		for (int32 i = bi * BlockSize; i < End; ++i)
+		{
+			Body(i, Buffer);
+		}
+	});
+
+	int32 Total = 0;
+	for (const TArray<int32>& Buffer : BlockBuffers)
+	{
+		Total += Buffer.Num();
+	}
+	Output.Reset(Total);
+	for (const TArray<int32>& Buffer : BlockBuffers)
+	{
+		Output.Append(Buffer);
+	}
+}
+
+
+void UE::SculptUtil::FDirtyIndexSet::Reset()
+{
+	for (int32 WordIndex : DirtyWords)
+	{
+		Words[WordIndex] = 0;
+	}
+	DirtyWords.Reset();
+}
+
+
+void UE::SculptUtil::FDirtyIndexSet::GetIndices(TArray<int32>& IndicesOut) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(SculptUtil_DirtyIndexSet_GetIndices);
+	ParallelGatherIndices(DirtyWords.Num(), IndicesOut, [&](int32 k, TArray<int32>& Buffer)
+	{
+		int32 WordIndex = DirtyWords[k];
+		uint32 Word = Words[WordIndex];
+		while (Word != 0)
+		{
+			int32 Bit = (int32)FMath::CountTrailingZeros(Word);
+			Buffer.Add(WordIndex * 32 + Bit);
+			Word &= Word - 1;
+		}
+	});
+}
+
+
+void UE::SculptUtil::CollectBrushROIParallel(
+	const FDynamicMesh3* Mesh,
+	const TArray<int32>& CandidateTriangles,
+	TArrayView<const FVector3d> BrushPositions, double BrushRadius,
+	FAtomicIndexFlags& VertexFlags, FAtomicIndexFlags& TriangleFlags,
+	TArray<int32>& VertexROIOut, TArray<int32>& TriangleROIOut)
+{
+	const double RadiusSqr = BrushRadius * BrushRadius;
+	auto IsInsideBrush = [&BrushPositions, RadiusSqr](const FVector3d& Pos)
+	{
+		for (const FVector3d& BrushPos : BrushPositions)
+		{
+			if (DistanceSquared(BrushPos, Pos) < RadiusSqr)
+			{
+				return true;
+			}
+		}
+		return false;
+	};
+	VertexFlags.Grow(Mesh->MaxVertexID());
+	TriangleFlags.Grow(Mesh->MaxTriangleID());
+
+	// vertices of candidate triangles inside the brush sphere. Distance tests may be repeated for shared vertices,
+	// that is cheaper than serializing on the flags
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(SculptUtil_CollectBrushROI_Vertices);
+		ParallelGatherIndices(CandidateTriangles.Num(), VertexROIOut, [&](int32 k, TArray<int32>& Buffer)
+		{
+			const FIndex3i& TriV = Mesh->GetTriangleRef(CandidateTriangles[k]);
+			for (int32 j = 0; j < 3; ++j)
+			{
+				int32 vid = TriV[j];
+				if (VertexFlags.Contains(vid) == false
+					&& IsInsideBrush(Mesh->GetVertexRef(vid))
+					&& VertexFlags.TestAndSet(vid))
+				{
+					Buffer.Add(vid);
+				}
+			}
+		});
+
+		// which block claims a shared vertex depends on scheduling, sort so that the ROI order does not
+		VertexROIOut.Sort();
+	}
+
+	// one-ring triangles of the vertex ROI
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(SculptUtil_CollectBrushROI_Triangles);
+		ParallelGatherIndices(VertexROIOut.Num(), TriangleROIOut, [&](int32 k, TArray<int32>& Buffer)
+		{
+			Mesh->EnumerateVertexTriangles(VertexROIOut[k], [&](int32 tid)
+			{
+				if (TriangleFlags.TestAndSet(tid))
+				{
+					Buffer.Add(tid);
+				}
+			});
+		});
+		TriangleROIOut.Sort();
+	}
+
+	VertexFlags.ClearIndices(VertexROIOut);
+	TriangleFlags.ClearIndices(TriangleROIOut);
+}
+
+
+
 void UE::SculptUtil::PrecalculateNormalsROI(
 	const FDynamicMesh3* Mesh,
 	const TArray<int32>& TriangleROI,
@@ -421,3 +601,431 @@ void UE::SculptUtil::RecalculateROINormals(FDynamicMesh3* Mesh, TArray<std::atom
 }
 
 
+
+
+void UE::SculptUtil::FNormalsROICache::UpdateForMesh(const FDynamicMesh3* Mesh, bool bForceVertex)
+{
+	const FDynamicMeshNormalOverlay* Normals = (Mesh->HasAttributes() && bForceVertex == false) ? Mesh->Attributes()->PrimaryNormals() : nullptr;
+	bool bUseOverlay = (Normals != nullptr);
+	int32 MaxIndex = bUseOverlay ? Normals->MaxElementID() : Mesh->MaxVertexID();
+
+	if (CachedMesh == Mesh && CachedTopologyStamp == Mesh->GetTopologyChangeStamp() && bOverlayElements == bUseOverlay
+		&& CachedMaxTriangleID == Mesh->MaxTriangleID() && CachedMaxIndex == MaxIndex)
+	{
+		return;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(SculptUtil_NormalsROICache_Build);
+
+	CachedMesh = Mesh;
+	CachedTopologyStamp = Mesh->GetTopologyChangeStamp();
+	CachedMaxTriangleID = Mesh->MaxTriangleID();
+	CachedMaxIndex = MaxIndex;
+	bOverlayElements = bUseOverlay;
+
+	auto GetTriangleIndices = [Mesh, Normals, bUseOverlay](int32 tid)
+	{
+		return bUseOverlay ? Normals->GetTriangle(tid) : Mesh->GetTriangle(tid);
+	};
+
+	// count triangles per index, then prefix-sum into offsets and fill
+	IndexTriOffsets.Init(0, MaxIndex + 1);
+	for (int32 tid : Mesh->TriangleIndicesItr())
+	{
+		if (bUseOverlay && Normals->IsSetTriangle(tid) == false)
+		{
+			continue;
+		}
+		FIndex3i Tri = GetTriangleIndices(tid);
+		IndexTriOffsets[Tri.A + 1]++;
+		IndexTriOffsets[Tri.B + 1]++;
+		IndexTriOffsets[Tri.C + 1]++;
+	}
+	for (int32 k = 1; k <= MaxIndex; ++k)
+	{
+		IndexTriOffsets[k] += IndexTriOffsets[k - 1];
+	}
+
+	IndexTris.SetNumUninitialized(IndexTriOffsets[MaxIndex]);
+	TArray<int32> InsertPos(IndexTriOffsets.GetData(), MaxIndex);
+	for (int32 tid : Mesh->TriangleIndicesItr())
+	{
+		if (bUseOverlay && Normals->IsSetTriangle(tid) == false)
+		{
+			continue;
+		}
+		FIndex3i Tri = GetTriangleIndices(tid);
+		IndexTris[InsertPos[Tri.A]++] = tid;
+		IndexTris[InsertPos[Tri.B]++] = tid;
+		IndexTris[InsertPos[Tri.C]++] = tid;
+	}
+
+	ROIFlags.Grow(MaxIndex);
+}
+
+
+void UE::SculptUtil::FNormalsROICache::GatherNormalsROI(const FDynamicMesh3* Mesh, const TArray<int32>& TriangleROI, TArray<int32>& IndicesOut)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(SculptUtil_NormalsROICache_Gather);
+	checkSlow(CachedMesh == Mesh);
+
+	const FDynamicMeshNormalOverlay* Normals = bOverlayElements ? Mesh->Attributes()->PrimaryNormals() : nullptr;
+	ParallelGatherIndices(TriangleROI.Num(), IndicesOut, [&](int32 k, TArray<int32>& Buffer)
+	{
+		int32 tid = TriangleROI[k];
+		if (bOverlayElements && Normals->IsSetTriangle(tid) == false)
+		{
+			return;
+		}
+		FIndex3i Tri = bOverlayElements ? Normals->GetTriangle(tid) : Mesh->GetTriangle(tid);
+		for (int32 j = 0; j < 3; ++j)
+		{
+			if (ROIFlags.TestAndSet(Tri[j]))
+			{
+				Buffer.Add(Tri[j]);
+			}
+		}
+	});
+	ROIFlags.ClearIndices(IndicesOut);
+}
+
+
+void UE::SculptUtil::FNormalsROICache::RecalculateNormals(FDynamicMesh3* Mesh, const TArray<int32>& Indices) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(SculptUtil_NormalsROICache_Recalculate);
+	checkSlow(CachedMesh == Mesh);
+
+	if (bOverlayElements)
+	{
+		// area-weighted sum of the normals of the triangles using each element, same as FMeshNormals::ComputeOverlayNormal
+		FDynamicMeshNormalOverlay* Normals = Mesh->Attributes()->PrimaryNormals();
+		ParallelFor(Indices.Num(), [&](int32 k)
+		{
+			int32 elemid = Indices[k];
+			FVector3d SumNormal = FVector3d::Zero();
+			for (int32 j = IndexTriOffsets[elemid], End = IndexTriOffsets[elemid + 1]; j < End; ++j)
+			{
+				FVector3d Normal, Centroid;
+				double Area;
+				Mesh->GetTriInfo(IndexTris[j], Normal, Area, Centroid);
+				SumNormal += Area * Normal;
+			}
+			Normals->SetElement(elemid, (FVector3f)UE::Geometry::Normalized(SumNormal));
+		});
+	}
+	else
+	{
+		// vertex normals can find their triangles directly, use the standard weighting
+		ParallelFor(Indices.Num(), [&](int32 k)
+		{
+			int32 vid = Indices[k];
+			FVector3d NewNormal = FMeshNormals::ComputeVertexNormal(*Mesh, vid);
+			Mesh->SetVertexNormal(vid, (FVector3f)NewNormal);
+		});
+	}
+}
+
+
+
+void UE::SculptUtil::FVertexPositionDeltaStore::Begin(const FDynamicMesh3* Mesh)
+{
+	InitialMaxVertexID = Mesh->MaxVertexID();
+	bInitialVerticesCompact = Mesh->IsCompactV();
+	InitialVertices.Reset();
+	if (bInitialVerticesCompact == false)
+	{
+		InitialVertices.Init(false, InitialMaxVertexID);
+		for (int32 vid : Mesh->VertexIndicesItr())
+		{
+			InitialVertices[vid] = true;
+		}
+	}
+
+	SavedFlags.Reset();
+	SavedVertices.Reset();
+	InitialPositions.Reset();
+}
+
+void UE::SculptUtil::FVertexPositionDeltaStore::SaveVertex(const FDynamicMesh3* Mesh, int32 VertexID)
+{
+	if (SavedFlags.Contains(VertexID) == false && Mesh->IsVertex(VertexID))
+	{
+		SavedFlags.Add(VertexID);
+		SavedVertices.Add(VertexID);
+		InitialPositions.Add(Mesh->GetVertex(VertexID));
+	}
+}
+
+void UE::SculptUtil::FVertexPositionDeltaStore::SaveVertices(const FDynamicMesh3* Mesh, TArrayView<const int32> Vertices)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(SculptUtil_VertexPositionDeltaStore_SaveVertices);
+	SavedFlags.Grow(Mesh->MaxVertexID());
+	for (int32 vid : Vertices)
+	{
+		SaveVertex(Mesh, vid);
+	}
+}
+
+void UE::SculptUtil::FVertexPositionDeltaStore::SaveTriangleVertices(const FDynamicMesh3* Mesh, const TSet<int32>& Triangles)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(SculptUtil_VertexPositionDeltaStore_SaveTriangleVertices);
+	SavedFlags.Grow(Mesh->MaxVertexID());
+	for (int32 tid : Triangles)
+	{
+		if (Mesh->IsTriangle(tid))
+		{
+			const FIndex3i& Tri = Mesh->GetTriangleRef(tid);
+			SaveVertex(Mesh, Tri.A);
+			SaveVertex(Mesh, Tri.B);
+			SaveVertex(Mesh, Tri.C);
+		}
+	}
+}
+
+void UE::SculptUtil::FVertexPositionDeltaStore::End(const FDynamicMesh3* Mesh, FMeshVertexChange& RevertChangeOut, FMeshVertexChange& ApplyChangeOut) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(SculptUtil_VertexPositionDeltaStore_End);
+
+	// A saved vertex ID that did not exist initially was created during the edit (possibly re-using a free ID). An initial
+	// vertex can only be removed after it was saved, so its ID cannot have been re-used before that.
+	const int32 NumSaved = SavedVertices.Num();
+	for (int32 k = 0; k < NumSaved; ++k)
+	{
+		const int32 vid = SavedVertices[k];
+		if (IsInitialVertex(vid))
+		{
+			RevertChangeOut.Vertices.Add(vid);
+			RevertChangeOut.OldPositions.Add(InitialPositions[k]);
+			RevertChangeOut.NewPositions.Add(InitialPositions[k]);
+		}
+		if (Mesh->IsVertex(vid))
+		{
+			const FVector3d FinalPos = Mesh->GetVertex(vid);
+			ApplyChangeOut.Vertices.Add(vid);
+			ApplyChangeOut.OldPositions.Add(FinalPos);
+			ApplyChangeOut.NewPositions.Add(FinalPos);
+		}
+	}
+}
+
+
+void UE::SculptUtil::FBrushAlphaMips::Initialize(const TImageBuilder<FVector4f>& Image)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(SculptUtil_BrushAlphaMips_Initialize);
+
+	Levels.Reset();
+	const FImageDimensions Dimensions = Image.GetDimensions();
+	const int32 Width = (int32)Dimensions.GetWidth(), Height = (int32)Dimensions.GetHeight();
+	if (Width <= 0 || Height <= 0)
+	{
+		return;
+	}
+	Levels.Reserve(1 + (int32)FMath::FloorLog2((uint32)FMath::Max(Width, Height)));
+
+	FLevel& BaseLevel = Levels.Emplace_GetRef();
+	BaseLevel.Width = Width;
+	BaseLevel.Height = Height;
+	BaseLevel.Values.SetNumUninitialized(Width * Height);
+	ParallelFor(Height, [&](int32 y)
+	{
+		for (int32 x = 0; x < Width; ++x)
+		{
+			int64 LinearIndex = (int64)y * Width + x;
+			BaseLevel.Values[LinearIndex] = Image.GetPixel(LinearIndex).X;
+		}
+	});
+
+	while (Levels.Last().Width > 1 || Levels.Last().Height > 1)
+	{
+		const int32 SrcIndex = Levels.Num() - 1;
+		FLevel& Dst = Levels.Emplace_GetRef();
+		const FLevel& Src = Levels[SrcIndex];
+		Dst.Width = FMath::Max(Src.Width / 2, 1);
+		Dst.Height = FMath::Max(Src.Height / 2, 1);
+		Dst.Values.SetNumUninitialized(Dst.Width * Dst.Height);
+
+		// 2x2 box filter, odd rows/columns at the border are folded into the last texel
+		ParallelFor(Dst.Height, [&](int32 y)
+		{
+			const int32 y0 = FMath::Min(2 * y, Src.Height - 1);
+			const int32 y1 = FMath::Min(2 * y + 1, Src.Height - 1);
+			for (int32 x = 0; x < Dst.Width; ++x)
+			{
+				const int32 x0 = FMath::Min(2 * x, Src.Width - 1);
+				const int32 x1 = FMath::Min(2 * x + 1, Src.Width - 1);
+				Dst.Values[y * Dst.Width + x] = 0.25f * (
+					Src.Values[y0 * Src.Width + x0] + Src.Values[y0 * Src.Width + x1] +
+					Src.Values[y1 * Src.Width + x0] + Src.Values[y1 * Src.Width + x1]);
+			}
+		});
+	}
+}
+
+
+float UE::SculptUtil::FBrushAlphaMips::ComputeLOD(double SampleSpacingUV) const
+{
+	if (Levels.Num() == 0)
+	{
+		return 0.0f;
+	}
+	const double TexelsPerSample = SampleSpacingUV * (double)FMath::Max(Levels[0].Width, Levels[0].Height);
+	if (TexelsPerSample <= 1.0)
+	{
+		return 0.0f;
+	}
+	return FMath::Clamp((float)FMath::Log2(TexelsPerSample), 0.0f, (float)(Levels.Num() - 1));
+}
+
+
+bool UE::SculptUtil::FBrushAlphaMips::GetBilinearCorners(const FLevel& Level, float U, float V, bool bWrap, int32 IndicesOut[4], float& FracXOut, float& FracYOut)
+{
+	if (bWrap)
+	{
+		U -= FMath::FloorToFloat(U);
+		V -= FMath::FloorToFloat(V);
+	}
+	else if (U < 0.0f || U > 1.0f || V < 0.0f || V > 1.0f)
+	{
+		return false;
+	}
+
+	// texel centers are at half-integer coordinates
+	const float X = U * (float)Level.Width - 0.5f;
+	const float Y = V * (float)Level.Height - 0.5f;
+	int32 X0 = FMath::FloorToInt(X), Y0 = FMath::FloorToInt(Y);
+	FracXOut = X - (float)X0;
+	FracYOut = Y - (float)Y0;
+	int32 X1 = X0 + 1, Y1 = Y0 + 1;
+	if (bWrap)
+	{
+		X0 = (X0 + Level.Width) % Level.Width;
+		X1 = X1 % Level.Width;
+		Y0 = (Y0 + Level.Height) % Level.Height;
+		Y1 = Y1 % Level.Height;
+	}
+	else
+	{
+		X0 = FMath::Clamp(X0, 0, Level.Width - 1);
+		X1 = FMath::Clamp(X1, 0, Level.Width - 1);
+		Y0 = FMath::Clamp(Y0, 0, Level.Height - 1);
+		Y1 = FMath::Clamp(Y1, 0, Level.Height - 1);
+	}
+	IndicesOut[0] = Y0 * Level.Width + X0;
+	IndicesOut[1] = Y0 * Level.Width + X1;
+	IndicesOut[2] = Y1 * Level.Width + X0;
+	IndicesOut[3] = Y1 * Level.Width + X1;
+	return true;
+}
+
+
+float UE::SculptUtil::FBrushAlphaMips::SampleBilinear(const FLevel& Level, float U, float V, bool bWrap)
+{
+	int32 Indices[4];
+	float FracX, FracY;
+	if (GetBilinearCorners(Level, U, V, bWrap, Indices, FracX, FracY) == false)
+	{
+		return 0.0f;
+	}
+	const float Top = FMath::Lerp(Level.Values[Indices[0]], Level.Values[Indices[1]], FracX);
+	const float Bottom = FMath::Lerp(Level.Values[Indices[2]], Level.Values[Indices[3]], FracX);
+	return FMath::Lerp(Top, Bottom, FracY);
+}
+
+
+float UE::SculptUtil::FBrushAlphaMips::Sample(float U, float V, float LOD, bool bWrap) const
+{
+	if (Levels.Num() == 0)
+	{
+		return 0.0f;
+	}
+	LOD = FMath::Clamp(LOD, 0.0f, (float)(Levels.Num() - 1));
+	const int32 Level0 = FMath::FloorToInt(LOD);
+	const int32 Level1 = FMath::Min(Level0 + 1, Levels.Num() - 1);
+	const float Value0 = SampleBilinear(Levels[Level0], U, V, bWrap);
+	if (Level1 == Level0)
+	{
+		return Value0;
+	}
+	return FMath::Lerp(Value0, SampleBilinear(Levels[Level1], U, V, bWrap), LOD - (float)Level0);
+}
+
+
+void UE::SculptUtil::FBrushAlphaMips::SampleBatch(TArrayView<const FVector2f> UVs, float LOD, bool bWrap, TArrayView<float> ValuesOut) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(SculptUtil_BrushAlphaMips_SampleBatch);
+
+	const int32 NumUVs = UVs.Num();
+	check(ValuesOut.Num() >= NumUVs);
+	if (Levels.Num() == 0)
+	{
+		for (int32 k = 0; k < NumUVs; ++k)
+		{
+			ValuesOut[k] = 0.0f;
+		}
+		return;
+	}
+
+	LOD = FMath::Clamp(LOD, 0.0f, (float)(Levels.Num() - 1));
+	const int32 LevelIndex[2] = { FMath::FloorToInt(LOD), FMath::Min(FMath::FloorToInt(LOD) + 1, Levels.Num() - 1) };
+	const VectorRegister4Float LevelT = VectorSetFloat1(LOD - (float)LevelIndex[0]);
+
+	// texel fetches are gathers, the bilinear and trilinear blends are done four samples at a time
+	constexpr int32 BlockSize = 256;
+	const int32 NumBlocks = (NumUVs + BlockSize - 1) / BlockSize;
+	ParallelFor(NumBlocks, [&](int32 BlockIndex)
+	{
+		const int32 Start = BlockIndex * BlockSize;
+		const int32 End = FMath::Min(Start + BlockSize, NumUVs);
+		int32 k = Start;
+		for (; k + 4 <= End; k += 4)
+		{
+			alignas(16) float Corners[2][4][4];		// [level][corner][lane]
+			alignas(16) float FracX[2][4];
+			alignas(16) float FracY[2][4];
+			for (int32 li = 0; li < 2; ++li)
+			{
+				const FLevel& Level = Levels[LevelIndex[li]];
+				for (int32 Lane = 0; Lane < 4; ++Lane)
+				{
+					int32 Indices[4];
+					const FVector2f& UV = UVs[k + Lane];
+					if (GetBilinearCorners(Level, UV.X, UV.Y, bWrap, Indices, FracX[li][Lane], FracY[li][Lane]))
+					{
+						for (int32 j = 0; j < 4; ++j)
+						{
+							Corners[li][j][Lane] = Level.Values[Indices[j]];
+						}
+					}
+					else
+					{
+						FracX[li][Lane] = FracY[li][Lane] = 0.0f;
+						for (int32 j = 0; j < 4; ++j)
+						{
+							Corners[li][j][Lane] = 0.0f;
+						}
+					}
+				}
+			}
+
+			VectorRegister4Float LevelValues[2];
+			for (int32 li = 0; li < 2; ++li)
+			{
+				const VectorRegister4Float C00 = VectorLoadAligned(Corners[li][0]);
+				const VectorRegister4Float C10 = VectorLoadAligned(Corners[li][1]);
+				const VectorRegister4Float C01 = VectorLoadAligned(Corners[li][2]);
+				const VectorRegister4Float C11 = VectorLoadAligned(Corners[li][3]);
+				const VectorRegister4Float FX = VectorLoadAligned(FracX[li]);
+				const VectorRegister4Float FY = VectorLoadAligned(FracY[li]);
+				const VectorRegister4Float Top = VectorMultiplyAdd(VectorSubtract(C10, C00), FX, C00);
+				const VectorRegister4Float Bottom = VectorMultiplyAdd(VectorSubtract(C11, C01), FX, C01);
+				LevelValues[li] = VectorMultiplyAdd(VectorSubtract(Bottom, Top), FY, Top);
+			}
+			const VectorRegister4Float Result = VectorMultiplyAdd(VectorSubtract(LevelValues[1], LevelValues[0]), LevelT, LevelValues[0]);
+			VectorStore(Result, &ValuesOut[k]);
+		}
+		for (; k < End; ++k)
+		{
+			ValuesOut[k] = Sample(UVs[k].X, UVs[k].Y, LOD, bWrap);
+		}
+	});
+}
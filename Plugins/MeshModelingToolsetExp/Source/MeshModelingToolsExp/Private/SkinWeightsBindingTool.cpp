@@ -2,7 +2,10 @@
 
 #include "SkinWeightsBindingTool.h"
 
+#include "Async/Async.h"
 #include "BoneWeights.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
 #include "DynamicMeshToMeshDescription.h"
 #include "DynamicMesh/DynamicVertexSkinWeightsAttribute.h"
 #include "InteractiveToolManager.h"
@@ -26,155 +29,6 @@
 
 #define LOCTEXT_NAMESPACE "USkinWeightsBindingTool"
 
-// TODO: Move to a helper function.
-
-// A simple FIFO queue. Maintains a set of blocks, rather than allocate for each element.
-template<typename T, int32 BlockSize=256>
-class TFIFOQueue
-{
-public:
-	TFIFOQueue() = default;
-
-	void Push(T InElem)
-	{
-		// Container Empty?
-		if (Blocks.IsEmpty())
-		{
-			Blocks.SetNum(1);
-			Blocks[0].bIsFree = false;
-			PushIndex = -1;
-		}
-		// Or are we at the end of current block?
-		else if (PushIndex == (BlockSize - 1))
-		{
-			PushBlock = AllocateNewPushBlock();
-			PushIndex = -1;
-		}
-
-		PushIndex++;
-
-		Blocks[PushBlock].Data[PushIndex] = InElem;
-	}
-
-	T Pop()
-	{
-		check(!IsEmpty());
-
-		if (PopIndex == (BlockSize - 1))
-		{
-			// Reached the end. Free this block and move onto the next one.
-			PopBlock = FreeCurrentPopBlock();
-			PopIndex = -1;
-		}
-
-		PopIndex++;
-		return Blocks[PopBlock].Data[PopIndex];
-	}
-
-	bool TryPop(T &OutValue)
-	{
-		if (IsEmpty())
-		{
-			return false;
-		}
-
-		OutValue = Pop();
-		return true;
-	}
-
-	void Reset()
-	{
-		Blocks.Reset();
-		PushBlock = 0;
-		PushIndex = -1;
-		PopBlock = 0;
-		PopIndex = -1;
-	}
-	
-
-	bool IsEmpty() const
-	{
-		return PushBlock == PopBlock && PushIndex == PopIndex;
-	}
-
-private:
-	int32 AllocateNewPushBlock()
-	{
-		checkSlow(PushBlock != -1);
-
-		int NewBlockIndex = INDEX_NONE;
-		
-		if (FreeCount > 0)
-		{
-			// Find a free block
-			for (int32 Index = 0; Index < Blocks.Num(); Index++)
-			{
-				if (Blocks[Index].bIsFree)
-				{
-					NewBlockIndex = Index;
-					FreeCount--;
-					break;
-				}
-			}
-			checkfSlow(NewBlockIndex != INDEX_NONE, TEXT("We should have found a free block."));
-		}
-		else
-		{
-			NewBlockIndex = Blocks.Num();
-			Blocks.AddDefaulted();
-		}
-
-		Blocks[PushBlock].NextBlock = NewBlockIndex;
-		Blocks[NewBlockIndex].bIsFree = false;
-		Blocks[NewBlockIndex].NextBlock = INDEX_NONE;
-		return NewBlockIndex;
-	}
-
-	int32 FreeCurrentPopBlock()
-	{
-		const int32 NextBlock = Blocks[PopBlock].NextBlock;
-		checkSlow(NextBlock != -1);
-		Blocks[PopBlock].bIsFree = true;
-		FreeCount++;
-
-		return NextBlock;
-	}
-	
-
-	int32 PushBlock = 0;
-	int32 PushIndex = -1;
-
-	int32 PopBlock = 0;
-	int32 PopIndex = -1;
-
-	int32 FreeCount = 0;
-	
-	struct FBlock
-	{
-		FBlock()
-		{
-			Data = new T[BlockSize];
-		}
-		~FBlock()
-		{
-			delete [] Data;
-		}
-
-		FBlock(FBlock &&InOther) noexcept
-		{
-			Data = InOther.Data;
-			InOther.Data = nullptr;
-		}
-		
-		bool bIsFree = true;
-		int32 NextBlock = INDEX_NONE;
-		T *Data;
-	};
-	
-	TArray<FBlock> Blocks;
-};
-
-
 static float DistanceToLineSegment(const FVector& P, const FVector& A, const FVector& B)
 {
 	const FVector M = B - A;
@@ -312,7 +166,6 @@ struct FOccupancyGrid
 		Interior
 	};
 
-	UE::Geometry::FDenseGrid3i Occupancy;
 	float CellSize;
 	FVector3f GridOrigin;
 	FVector3f CellMidPoint;
@@ -323,6 +176,8 @@ struct FOccupancyGrid
 		)
 	{
 		using namespace UE::Geometry;
+
+		TRACE_CPUPROFILER_EVENT_SCOPE(FOccupancyGrid_Build);
 	
 		// Compute a voxel grid 
 		FDynamicMeshAABBTree3 Spatial(&InMesh);
@@ -337,56 +192,120 @@ struct FOccupancyGrid
 
 		// Our occupancy grid is computed on the winding number grid's cell centers.
 		const FVector3i WindingDims = WindingGrid.Dimensions();
-		Occupancy = FDenseGrid3i(WindingDims.X - 1, WindingDims.Y - 1, WindingDims.Z - 1, Exterior);
+		Dimensions = FVector3i(WindingDims.X - 1, WindingDims.Y - 1, WindingDims.Z - 1);
+
+		// Each Z-slab starts on a new word, so that slabs can be written from different threads. Zero is Exterior.
+		SlabWords = FMath::DivideAndRoundUp(Dimensions.X * Dimensions.Y, CellsPerWord);
+		PackedCells.SetNumZeroed(SlabWords * Dimensions.Z);
 
 		GridOrigin = WindingGrid.GridOrigin + FVector3f(CellSize / 2.0f, CellSize / 2.0f, CellSize / 2.0f);
 
-		static const FVector3i CornerOffsets[] = {
-			FVector3i(0, 0, 0),
-			FVector3i(0, 0, 1),
-			FVector3i(0, 1, 0),
-			FVector3i(0, 1, 1),
-			FVector3i(1, 0, 0),
-			FVector3i(1, 0, 1),
-			FVector3i(1, 1, 0),
-			FVector3i(1, 1, 1),
-		};
-		
-		// TODO: Parallel-for
-		for (int32 OccupancyId = 0; OccupancyId < Occupancy.Size(); OccupancyId++)
+		// Test each winding number corner once, rather than once for each of the 8 cells sharing it. A cell slab reads
+		// the corner layers below and above it.
+		TArray<TBitArray<>> InsideLayers;
+		InsideLayers.SetNum(WindingDims.Z);
+		ParallelFor(WindingDims.Z, [&](int32 Z)
 		{
-			const FVector3i OccupancyIndex(Occupancy.ToIndex(OccupancyId));
-			int32 Count = 0;
-			for (int32 CornerId = 0; CornerId < 8; CornerId++)
+			TBitArray<>& Layer = InsideLayers[Z];
+			Layer.Init(false, WindingDims.X * WindingDims.Y);
+			for (int32 Y = 0; Y < WindingDims.Y; Y++)
 			{
-				const FVector3i CornerIndex(OccupancyIndex + CornerOffsets[CornerId]);
-				if (WindingGrid.GetValue(CornerIndex) >= WindingGrid.WindingIsoValue)
+				for (int32 X = 0; X < WindingDims.X; X++)
 				{
-					Count++;
+					if (WindingGrid.GetValue(FVector3i(X, Y, Z)) >= WindingGrid.WindingIsoValue)
+					{
+						Layer[Y * WindingDims.X + X] = true;
+					}
 				}
 			}
+		});
 
-			if (Count == 8)
-			{
-				Occupancy[OccupancyIndex] = Interior;
-			}
-			else if (Count > 0)
+		ParallelFor(Dimensions.Z, [&](int32 Z)
+		{
+			const TBitArray<>* Layers[2] = { &InsideLayers[Z], &InsideLayers[Z + 1] };
+			for (int32 Y = 0; Y < Dimensions.Y; Y++)
 			{
-				Occupancy[OccupancyIndex] = Boundary;
+				for (int32 X = 0; X < Dimensions.X; X++)
+				{
+					const int32 CornerId = Y * WindingDims.X + X;
+					const int32 CornerIds[4] = { CornerId, CornerId + 1, CornerId + WindingDims.X, CornerId + WindingDims.X + 1 };
+					int32 Count = 0;
+					for (const TBitArray<>* Layer : Layers)
+					{
+						for (const int32 LayerCornerId : CornerIds)
+						{
+							if ((*Layer)[LayerCornerId])
+							{
+								Count++;
+							}
+						}
+					}
+
+					if (Count == 8)
+					{
+						SetDomain(FVector3i(X, Y, Z), Interior);
+					}
+					else if (Count > 0)
+					{
+						SetDomain(FVector3i(X, Y, Z), Boundary);
+					}
+				}
 			}
-		}
+		});
 
 		// Make sure we include all the vertices of the mesh as a part of the boundary, if
-		// the vertex areas are marked as being exterior.
-		for (int32 VertexIdx = 0; VertexIdx < InMesh.VertexCount(); VertexIdx++)
+		// the vertex areas are marked as being exterior. Cells only go from Exterior to Boundary here,
+		// which is a single bit set, so concurrent promotions of cells sharing a word can be atomic ORs.
+		ParallelFor(InMesh.MaxVertexID(), [&](int32 VertexIdx)
 		{
+			if (!InMesh.IsVertex(VertexIdx))
+			{
+				return;
+			}
 			const FVector3d& Pos = InMesh.GetVertex(VertexIdx);
 			const FVector3i OccupancyIndex = GetCellIndexFromPoint(FVector(Pos));
-			if (Occupancy[OccupancyIndex] == Exterior)
+			if (!ensure(IsValidIndex(OccupancyIndex)))
 			{
-				Occupancy[OccupancyIndex] = Boundary;
+				return;
 			}
-		}
+
+			int32 Shift;
+			volatile int64* Word = reinterpret_cast<volatile int64*>(&PackedCells[GetWordIndex(OccupancyIndex, Shift)]);
+			if (((FPlatformAtomics::AtomicRead(Word) >> Shift) & DomainMask) == Exterior)
+			{
+				FPlatformAtomics::InterlockedOr(Word, static_cast<int64>(Boundary) << Shift);
+			}
+		});
+	}
+
+	const UE::Geometry::FVector3i& GetDimensions() const
+	{
+		return Dimensions;
+	}
+
+	int64 Num() const
+	{
+		return static_cast<int64>(Dimensions.X) * Dimensions.Y * Dimensions.Z;
+	}
+
+	UE::Geometry::FVector3i ToIndex(int64 LinearIndex) const
+	{
+		const int32 X = static_cast<int32>(LinearIndex % Dimensions.X);
+		const int32 Y = static_cast<int32>((LinearIndex / Dimensions.X) % Dimensions.Y);
+		const int32 Z = static_cast<int32>(LinearIndex / (static_cast<int64>(Dimensions.X) * Dimensions.Y));
+		return { X, Y, Z };
+	}
+
+	bool IsValidIndex(const UE::Geometry::FVector3i& Index) const
+	{
+		return Index.X >= 0 && Index.Y >= 0 && Index.Z >= 0 && Index.X < Dimensions.X && Index.Y < Dimensions.Y && Index.Z < Dimensions.Z;
+	}
+
+	EDomain GetDomain(const UE::Geometry::FVector3i& Index) const
+	{
+		int32 Shift;
+		const uint64 Word = PackedCells[GetWordIndex(Index, Shift)];
+		return static_cast<EDomain>((Word >> Shift) & DomainMask);
 	}
 	
 	UE::Geometry::FVector3i GetCellIndexFromPoint(const FVector &InPoint) const
@@ -411,6 +330,30 @@ struct FOccupancyGrid
 		const FVector3f P = (FVector3f)GetCellCenterFromIndex(Index);
 		return {P - CellMidPoint, P + CellMidPoint};
 	}
+
+private:
+	// The domain of each cell is packed into 2 bits, 32 cells to a word.
+	static constexpr int32 CellsPerWord = 32;
+	static constexpr uint64 DomainMask = 0x3;
+
+	UE::Geometry::FVector3i Dimensions;
+	int32 SlabWords = 0;
+	TArray<uint64> PackedCells;
+
+	int32 GetWordIndex(const UE::Geometry::FVector3i& Index, int32& OutShift) const
+	{
+		const int32 SlabCell = Index.Y * Dimensions.X + Index.X;
+		OutShift = 2 * (SlabCell % CellsPerWord);
+		return Index.Z * SlabWords + SlabCell / CellsPerWord;
+	}
+
+	// Not thread-safe for cells that share a word, only used while building one Z-slab per thread.
+	void SetDomain(const UE::Geometry::FVector3i& Index, EDomain Domain)
+	{
+		int32 Shift;
+		uint64& Word = PackedCells[GetWordIndex(Index, Shift)];
+		Word = (Word & ~(DomainMask << Shift)) | (static_cast<uint64>(Domain) << Shift);
+	}
 };
 
 
@@ -427,6 +370,61 @@ namespace
 	{
 		return (1.0f - InStiffness) * InWeight + InStiffness * InWeight * InWeight;
 	}
+
+	static TAutoConsoleVariable<float> CVarSkinWeightsGeodesicCutoff(
+		TEXT("modeling.SkinWeights.GeodesicCutoff"),
+		0.5f,
+		TEXT("Distance, as a fraction of the mesh bounds diagonal, beyond which a bone does not influence a vertex in geodesic voxel binding."));
+
+	// Number of locks guarding the per-vertex bone candidates of geodesic voxel binding
+	static constexpr int32 NumCandidateLocks = 64;
+
+	// Distances over the cells of an FOccupancyGrid, allocated in bricks of 8x8x8 cells as cells are reached,
+	// so a bone only pays for the part of the grid within its cutoff distance.
+	struct FSparseCellDistances
+	{
+		static constexpr int32 BrickShift = 3;
+		static constexpr int32 BrickSize = 1 << BrickShift;
+		static constexpr int32 BrickMask = BrickSize - 1;
+		static constexpr int32 BrickCells = BrickSize * BrickSize * BrickSize;
+
+		TMap<int64, int32> BrickIndices;
+		TArray<float> Distances;
+
+		static int64 GetBrickKey(const UE::Geometry::FVector3i& Cell)
+		{
+			return (static_cast<int64>(Cell.X >> BrickShift) << 42) | (static_cast<int64>(Cell.Y >> BrickShift) << 21) | static_cast<int64>(Cell.Z >> BrickShift);
+		}
+
+		static int32 GetBrickOffset(const UE::Geometry::FVector3i& Cell)
+		{
+			return ((Cell.Z & BrickMask) * BrickSize + (Cell.Y & BrickMask)) * BrickSize + (Cell.X & BrickMask);
+		}
+
+		/** @return the distance of a cell, or the maximum float if it was not reached */
+		float Get(const UE::Geometry::FVector3i& Cell) const
+		{
+			const int32* BrickIndex = BrickIndices.Find(GetBrickKey(Cell));
+			return BrickIndex ? Distances[*BrickIndex * BrickCells + GetBrickOffset(Cell)] : TNumericLimits<float>::Max();
+		}
+
+		float& FindOrAdd(const UE::Geometry::FVector3i& Cell)
+		{
+			const int64 BrickKey = GetBrickKey(Cell);
+			int32* BrickIndex = BrickIndices.Find(BrickKey);
+			if (!BrickIndex)
+			{
+				const int32 NewBrickIndex = Distances.Num() / BrickCells;
+				Distances.Reserve(Distances.Num() + BrickCells);
+				for (int32 Index = 0; Index < BrickCells; Index++)
+				{
+					Distances.Add(TNumericLimits<float>::Max());
+				}
+				BrickIndex = &BrickIndices.Add(BrickKey, NewBrickIndex);
+			}
+			return Distances[*BrickIndex * BrickCells + GetBrickOffset(Cell)];
+		}
+	};
 	
 }
 
@@ -446,7 +444,9 @@ public:
 	ESkinWeightsBindType BindType = ESkinWeightsBindType::DirectDistance;
 	float Stiffness = 0.2f;
 	int32 MaxInfluences = 5;
-	int32 VoxelResolution = 256;
+
+	// Shared with the tool and other operators, only needed for GeodesicVoxel. May still be building.
+	TSharedFuture<TSharedPtr<const FOccupancyGrid, ESPMode::ThreadSafe>> OccupancyGrid;
 	
 	void CalculateResult(FProgressCancel* InProgress) override
 	{
@@ -474,7 +474,7 @@ public:
 			break;
 			
 		case ESkinWeightsBindType::GeodesicVoxel:
-			CreateSkinWeights_GeodesicVoxel(*ResultMesh, ClampedStiffness, Settings);
+			CreateSkinWeights_GeodesicVoxel(*ResultMesh, ClampedStiffness, Settings, InProgress);
 			break;
 		}
 	}
@@ -564,12 +564,32 @@ private:
 	void CreateSkinWeights_GeodesicVoxel(
 		FDynamicMesh3& InMesh,
 		float InStiffness,
-		const UE::AnimationCore::FBoneWeightsSettings& InSettings
+		const UE::AnimationCore::FBoneWeightsSettings& InSettings,
+		FProgressCancel* InProgress
 		)
 	{
 		using namespace UE::AnimationCore;
 		using namespace UE::Geometry;
 
+		if (!ensure(OccupancyGrid.IsValid()))
+		{
+			return;
+		}
+		
+		// Wait for the tool to finish building the grid, if it has not yet, but stay responsive to cancellation.
+		while (!OccupancyGrid.WaitFor(FTimespan::FromMilliseconds(10)))
+		{
+			if (InProgress && InProgress->Cancelled())
+			{
+				return;
+			}
+		}
+		if (!ensure(OccupancyGrid.Get().IsValid()))
+		{
+			return;
+		}
+		const FOccupancyGrid& Occupancy = *OccupancyGrid.Get();
+
 		FDynamicMeshVertexSkinWeightsAttribute *SkinWeights = InMesh.Attributes()->GetSkinWeightsAttribute(ProfileName);
 		
 		const int32 NumVertices = InMesh.VertexCount();
@@ -579,19 +599,110 @@ private:
 		
 		const FTransformHierarchyQuery Skeleton(TransformHierarchy);
 
-		// This is grossly inefficient but tricky to do otherwise, since each bone distance
-		// computation is done per-thread. We could possibly solve this by chunking instead
-		// and accumulating partial results.
-		TArray<float> Weights;
-		Weights.SetNumUninitialized(NumVertices * TransformHierarchy.Num());
+		const int32 NumBones = TransformHierarchy.Num();
+		const int32 MaxCandidates = FMath::Max(InSettings.GetMaxWeightCount(), 1);
+
+		// Bones stop propagating at this distance. Their weight beyond it is negligible next to a closer bone's.
+		const float CutoffDistance = FMath::Max(CVarSkinWeightsGeodesicCutoff.GetValueOnAnyThread(), 0.0f) * DiagBounds;
+
+		// Weight of a vertex at Distance from a bone. W = (1/S(D))^2, where S(x) is the stiffness function.
+		auto DistanceToWeight = [DiagBounds, InStiffness](float Distance)
+		{
+			// Normalize the distance by the diagonal size of the bbox to maintain scale invariance.
+			// Avoid div-by-zero but allow for the possibility that multiple bones may touch this vertex.
+			const float NormalizedDistance = FMath::Max(Distance / DiagBounds, KINDA_SMALL_NUMBER);
+			return FMath::Square(1.0f / ComputeWeightStiffness(NormalizedDistance, InStiffness));
+		};
 
-		FOccupancyGrid Occupancy(InMesh, VoxelResolution);
+		// Group the vertices by the distance brick of their cell, so each bone only visits the vertices in the bricks it reached.
+		struct FVertexBrick
+		{
+			TArray<int32> Vertices;
+			int32 LockIndex = 0;
+		};
+		TMap<int64, FVertexBrick> VertexBricks;
+		TArray<FVector3i> VertexCells;
+		VertexCells.SetNumUninitialized(NumVertices);
+		for (int32 VertexIdx = 0; VertexIdx < NumVertices; VertexIdx++)
+		{
+			VertexCells[VertexIdx] = Occupancy.GetCellIndexFromPoint(InMesh.GetVertex(VertexIdx));
+			if (Occupancy.IsValidIndex(VertexCells[VertexIdx]))
+			{
+				const int64 BrickKey = FSparseCellDistances::GetBrickKey(VertexCells[VertexIdx]);
+				FVertexBrick* Brick = VertexBricks.Find(BrickKey);
+				if (!Brick)
+				{
+					Brick = &VertexBricks.Add(BrickKey);
+					Brick->LockIndex = VertexBricks.Num() % NumCandidateLocks;
+				}
+				Brick->Vertices.Add(VertexIdx);
+			}
+		}
 
-		const FVector3i Dimensions = Occupancy.Occupancy.GetDimensions();
+		// The best MaxCandidates bones of each vertex, as (bone, weight) pairs. Bones are solved in parallel, so the
+		// candidates of the vertices in a brick are guarded by one of a small set of locks.
+		TArray<TPair<FBoneIndexType, float>> Candidates;
+		Candidates.SetNumUninitialized(NumVertices * MaxCandidates);
+		TArray<int32> NumVertexCandidates;
+		NumVertexCandidates.SetNumZeroed(NumVertices);
+		FCriticalSection CandidateLocks[NumCandidateLocks];
+
+		auto AddCandidate = [&](int32 VertexIdx, FBoneIndexType BoneIndex, float Weight)
+		{
+			TPair<FBoneIndexType, float>* VertexCandidates = &Candidates[VertexIdx * MaxCandidates];
+			int32& NumCandidates = NumVertexCandidates[VertexIdx];
+			if (NumCandidates < MaxCandidates)
+			{
+				VertexCandidates[NumCandidates++] = MakeTuple(BoneIndex, Weight);
+				return;
+			}
+
+			// Replace the weakest candidate, if this bone is stronger.
+			int32 WeakestIndex = 0;
+			for (int32 Index = 1; Index < MaxCandidates; Index++)
+			{
+				if (VertexCandidates[Index].Value < VertexCandidates[WeakestIndex].Value)
+				{
+					WeakestIndex = Index;
+				}
+			}
+			if (Weight > VertexCandidates[WeakestIndex].Value)
+			{
+				VertexCandidates[WeakestIndex] = MakeTuple(BoneIndex, Weight);
+			}
+		};
+
+		float NeighbourDistances[26];
+		for (int32 N = 0; N < 26; N++)
+		{
+			NeighbourDistances[N] = (FVector3f(IndexUtil::GridOffsets26[N]) * Occupancy.CellSize).Length();
+		}
 		
-		ParallelFor(TransformHierarchy.Num(), [&](int32 BoneIndex) {
-			TFIFOQueue<FVector3i> WorkingSet;  
-			FDenseGrid3f BoneDistance(Dimensions.X, Dimensions.Y, Dimensions.Z, DiagBounds);
+		ParallelFor(NumBones, [&](int32 BoneIndex) {
+			if (InProgress && InProgress->Cancelled())
+			{
+				return;
+			}
+
+			FSparseCellDistances BoneDistance;
+
+			// Dial's bucketed Dijkstra. Buckets are CellSize wide, which is the shortest step between cells, so the
+			// cells in a bucket cannot shorten each other's paths and each one is final when its bucket is reached.
+			struct FCellDistance
+			{
+				FVector3i Cell;
+				float Distance;
+			};
+			TArray<TArray<FCellDistance>> Buckets;
+			auto Push = [&Buckets, &Occupancy](const FVector3i& Cell, float Distance)
+			{
+				const int32 Bucket = FMath::FloorToInt(Distance / Occupancy.CellSize);
+				if (Bucket >= Buckets.Num())
+				{
+					Buckets.SetNum(Bucket + 1);
+				}
+				Buckets[Bucket].Add({ Cell, Distance });
+			};
 
 			// Mark all the cells that the bone intersects with distance of 0 and put them
 			// on the work queue.
@@ -606,102 +717,132 @@ private:
 					for (int32 K = BoneMin.Z; K <= BoneMax.Z; K++)
 					{
 						const FVector3i Candidate(I, J, K);
+						if (!Occupancy.IsValidIndex(Candidate))
+						{
+							continue;
+						}
 						const FBox CellBox = Occupancy.GetCellBoxFromIndex(Candidate);
 						if (Skeleton.GetBoneFanIntersectsBox(BoneIndex, CellBox))
 						{
-							WorkingSet.Push(Candidate);
-							BoneDistance[Candidate] = 0.0f;
+							float& Distance = BoneDistance.FindOrAdd(Candidate);
+							if (Distance > 0.0f)
+							{
+								Distance = 0.0f;
+								Push(Candidate, 0.0f);
+							}
 						}
 					}
 				}
 			}
 
-			// Iterate over all the voxels until we have constructed shortest distance paths
-			// throughout the level set.
-			while (!WorkingSet.IsEmpty())
+			// Expand each cell once, in order of distance, until the cutoff.
+			for (int32 Bucket = 0; Bucket < Buckets.Num(); Bucket++)
 			{
-				const FVector3i WorkItem = WorkingSet.Pop();
-
-				// Loop through each of the neighbours (6 face neighbours, 12 edge neighbors,
-				// and 8 corner neighbours) and see if any of them are closer to the bone
-				// than their current marked distance.
-				float CurrentDistance = BoneDistance[WorkItem];
-				for (int32 N = 0; N < 26; N++)
+				// Float rounding can put a step back into the current bucket, so drain it until it stays empty.
+				while (!Buckets[Bucket].IsEmpty())
 				{
-					FVector3i Offset(IndexUtil::GridOffsets26[N]);
-					FVector3i Candidate(WorkItem + Offset);
-
-					if (!BoneDistance.IsValidIndex(Candidate))
+					const TArray<FCellDistance> Current = MoveTemp(Buckets[Bucket]);
+					Buckets[Bucket].Reset();
+					for (const FCellDistance& WorkItem : Current)
 					{
-						continue;
-					}
-					
-					// Ensure this entry is either a part of the interior or boundary domain.
-					if (Occupancy.Occupancy[Candidate] == FOccupancyGrid::Exterior)
-					{
-						continue;
-					}
-
-					const float CellDistance = (FVector3f(Offset) * Occupancy.CellSize).Length();
-					const float CandidateDistance = CurrentDistance + CellDistance;
-					const float OldDistance = BoneDistance[Candidate]; 
+						// Skip entries that were superseded by a shorter path.
+						if (WorkItem.Distance > BoneDistance.Get(WorkItem.Cell))
+						{
+							continue;
+						}
 
-					if (OldDistance > CandidateDistance)
-					{
-						WorkingSet.Push(Candidate);
-						BoneDistance[Candidate] = CandidateDistance;
+						// Loop through each of the neighbours (6 face neighbours, 12 edge neighbors,
+						// and 8 corner neighbours) and see if any of them are closer to the bone
+						// than their current marked distance.
+						for (int32 N = 0; N < 26; N++)
+						{
+							const FVector3i Candidate(WorkItem.Cell + FVector3i(IndexUtil::GridOffsets26[N]));
+
+							// Ensure this entry is either a part of the interior or boundary domain.
+							if (!Occupancy.IsValidIndex(Candidate) || Occupancy.GetDomain(Candidate) == FOccupancyGrid::Exterior)
+							{
+								continue;
+							}
+
+							const float CandidateDistance = WorkItem.Distance + NeighbourDistances[N];
+							if (CandidateDistance > CutoffDistance)
+							{
+								continue;
+							}
+
+							float& OldDistance = BoneDistance.FindOrAdd(Candidate);
+							if (OldDistance > CandidateDistance)
+							{
+								OldDistance = CandidateDistance;
+								Push(Candidate, CandidateDistance);
+							}
+						}
 					}
 				}
 			}
 
-			// Loop through all the vertices, find the voxel each belongs to, and compute
-			// the distance from the voxel to the vertex (assuming the distance stored in the
-			// voxel is based on traversing from voxel center to voxel center).
-			for (int32 VertexIdx = 0; VertexIdx < NumVertices; VertexIdx++)
+			// Find the voxel of each vertex in the reached bricks, and compute the distance from
+			// the voxel to the vertex (assuming the distance stored in the voxel is based on
+			// traversing from voxel center to voxel center).
+			for (const TPair<int64, int32>& ReachedBrick : BoneDistance.BrickIndices)
 			{
-				const FVector3d& Pos = InMesh.GetVertex(VertexIdx);
-				const FVector3i CellIndex = Occupancy.GetCellIndexFromPoint(Pos);
-				const FVector3d CellCenter = Occupancy.GetCellCenterFromIndex(CellIndex);
-
-				float Distance = BoneDistance[CellIndex];
-				const FOccupancyGrid::EDomain Domain = static_cast<FOccupancyGrid::EDomain>(Occupancy.Occupancy[CellIndex]);
-				// check(Distance != std::numeric_limits<float>::max());
-
-				Distance += FVector3d::Distance(CellCenter, Pos);
-				
-				// Normalize the distance by the diagonal size of the bbox to maintain scale invariance.
-				float Weight = Distance / DiagBounds;
-
-				// Avoid div-by-zero but allow for the possibility that multiple bones may
-				// touch this vertex.
-				Weight = FMath::Max(Weight, KINDA_SMALL_NUMBER);
+				const FVertexBrick* Brick = VertexBricks.Find(ReachedBrick.Key);
+				if (!Brick)
+				{
+					continue;
+				}
 
-				// Compute the actual weight, factoring in the stiffness value. W = (1/S(D))^2
-				// Where S(x) is the stiffness function.
-				Weight = FMath::Square(1.0f / ComputeWeightStiffness(Weight, InStiffness));
+				FScopeLock Lock(&CandidateLocks[Brick->LockIndex]);
+				for (const int32 VertexIdx : Brick->Vertices)
+				{
+					const float CellDistance = BoneDistance.Get(VertexCells[VertexIdx]);
+					if (CellDistance == TNumericLimits<float>::Max())
+					{
+						continue;
+					}
 
-				Weights[VertexIdx * TransformHierarchy.Num() + BoneIndex] = Weight;
+					const FVector3d CellCenter = Occupancy.GetCellCenterFromIndex(VertexCells[VertexIdx]);
+					const float Distance = CellDistance + FVector3d::Distance(CellCenter, InMesh.GetVertex(VertexIdx));
+					AddCandidate(VertexIdx, static_cast<FBoneIndexType>(BoneIndex), DistanceToWeight(Distance));
+				}
 			}
-		});	
+		});
+
+		if (InProgress && InProgress->Cancelled())
+		{
+			return;
+		}
 
 		ParallelFor(NumVertices, [&](const int32 VertexIdx)
 		{
+			// Vertices that no bone reached within the cutoff fall back to the straight line distance to each bone.
+			if (NumVertexCandidates[VertexIdx] == 0)
+			{
+				const FVector3d& Pos = InMesh.GetVertex(VertexIdx);
+				for (int32 BoneIndex = 0; BoneIndex < NumBones; BoneIndex++)
+				{
+					AddCandidate(VertexIdx, static_cast<FBoneIndexType>(BoneIndex), DistanceToWeight(Skeleton.GetDistanceToBoneFan(BoneIndex, Pos)));
+				}
+			}
+
 			FCreateSkinWeights_Closest_WorkData &WorkData = FCreateSkinWeights_Closest_WorkData::Get();
 			
-			WorkData.RawBoneWeights.Reset(TransformHierarchy.Num());
+			WorkData.RawBoneWeights.Reset(MaxCandidates);
+			WorkData.RawBoneWeights.Append(&Candidates[VertexIdx * MaxCandidates], NumVertexCandidates[VertexIdx]);
 
 			float TotalWeight = 0.0f;
-			for (int32 BoneIndex = 0; BoneIndex < TransformHierarchy.Num(); BoneIndex++)
+			for (const TPair<FBoneIndexType, float> &BoneWeight: WorkData.RawBoneWeights)
 			{
-				const float Weight = Weights[VertexIdx * TransformHierarchy.Num() + BoneIndex];
-				TotalWeight += Weight;
-				WorkData.RawBoneWeights.Add(MakeTuple(static_cast<FBoneIndexType>(BoneIndex), Weight));
+				TotalWeight += BoneWeight.Value;
 			}
 
 			// Normalize
-			for (TPair<FBoneIndexType, float> &BoneWeight: WorkData.RawBoneWeights)
+			if (TotalWeight > 0.0f)
 			{
-				BoneWeight.Value /= TotalWeight;
+				for (TPair<FBoneIndexType, float> &BoneWeight: WorkData.RawBoneWeights)
+				{
+					BoneWeight.Value /= TotalWeight;
+				}
 			}
 				
 			WorkData.RawBoneWeights.Sort([](const TPair<FBoneIndexType, float> &A, const TPair<FBoneIndexType, float> &B)
@@ -709,10 +850,9 @@ private:
 				return A.Value > B.Value;
 			});
 
-			WorkData.BoneWeights.Reset(InSettings.GetMaxWeightCount());
-			for (int32 BoneIndex = 0; BoneIndex < FMath::Min(InSettings.GetMaxWeightCount(), WorkData.RawBoneWeights.Num()); BoneIndex++)
+			WorkData.BoneWeights.Reset(MaxCandidates);
+			for (const TPair<FBoneIndexType, float>& BoneWeight : WorkData.RawBoneWeights)
 			{
-				const TPair<FBoneIndexType, float>& BoneWeight = WorkData.RawBoneWeights[BoneIndex];
 				WorkData.BoneWeights.Add(FBoneWeight(BoneWeight.Key, BoneWeight.Value));
 			}
 
@@ -813,6 +953,7 @@ void USkinWeightsBindingTool::Setup()
 	Preview->SetIsMeshTopologyConstant(true, EMeshRenderAttributeFlags::VertexColors);
 	Preview->OnMeshUpdated.AddLambda([this](UMeshOpPreviewWithBackgroundCompute* Compute)
 	{
+		UpdateBoneVertexWeights();
 		UpdateVisualization();
 	});
 	
@@ -850,8 +991,10 @@ void USkinWeightsBindingTool::Setup()
 	Preview->PreviewMesh->SetShadowsEnabled(false);
 	Preview->PreviewMesh->UpdatePreview(OriginalMesh.Get());
 
-	Occupancy = MakeShared<FOccupancyGrid>(*OriginalMesh, Properties->VoxelResolution);
-	
+	// Results are copies of OriginalMesh, so they share its color elements.
+	VertexColorElements.Initialize(*OriginalMesh, *OriginalMesh->Attributes()->PrimaryColors());
+
+	UpdateBoneVertexWeights();
 	UpdateVisualization(/*bForce=*/true);
 	
 	// add properties to GUI
@@ -931,7 +1074,10 @@ void USkinWeightsBindingTool::Render(IToolsContextRenderAPI* RenderAPI)
 {
 	/**/
 
-	if (Occupancy && Properties->bDebugDraw)
+	// Only draw a grid that has finished building, never wait for one here.
+	const TSharedFuture<FOccupancyGridPtr> PendingGrid = Properties->bDebugDraw ? GetOccupancyGrid() : TSharedFuture<FOccupancyGridPtr>();
+	const FOccupancyGridPtr OccupancyGrid = (PendingGrid.IsValid() && PendingGrid.IsReady()) ? PendingGrid.Get() : nullptr;
+	if (OccupancyGrid)
 	{
 		bool bShowInterior = false;
 		bool bShowBoundary = true;
@@ -940,14 +1086,14 @@ void USkinWeightsBindingTool::Render(IToolsContextRenderAPI* RenderAPI)
 		const FTransform Transform = (FTransform) UE::ToolTarget::GetLocalToWorldTransform(Targets[0]);
 		float PDIScale = RenderAPI->GetCameraState().GetPDIScalingFactor();
 
-		for (int32 I = 0; I < Occupancy->Occupancy.Size(); I++)
+		for (int64 I = 0; I < OccupancyGrid->Num(); I++)
 		{
-			UE::Geometry::FVector3i G(Occupancy->Occupancy.ToIndex(I));
+			UE::Geometry::FVector3i G(OccupancyGrid->ToIndex(I));
 
-			FOccupancyGrid::EDomain Domain = static_cast<FOccupancyGrid::EDomain>(Occupancy->Occupancy[G]);
+			FOccupancyGrid::EDomain Domain = OccupancyGrid->GetDomain(G);
 			if (bShowBoundary && Domain == FOccupancyGrid::Boundary)
 			{
-				FBox Box = Occupancy->GetCellBoxFromIndex(G);
+				FBox Box = OccupancyGrid->GetCellBoxFromIndex(G);
 				DrawBox(RenderAPI, Transform, Box, FLinearColor(1.0, 1.0, 0.0, 0.5), 0.5f);
 			}
 			
@@ -974,8 +1120,7 @@ void USkinWeightsBindingTool::OnPropertyModified(UObject* PropertySet, FProperty
 		}
 		else
 		{
-			Occupancy = MakeShared<FOccupancyGrid>(*OriginalMesh, Properties->VoxelResolution);
-			
+			// The occupancy grid is rebuilt by MakeNewOperator() only if VoxelResolution changed.
 			Preview->InvalidateResult();
 		}
 	}
@@ -990,7 +1135,10 @@ TUniquePtr<UE::Geometry::FDynamicMeshOperator> USkinWeightsBindingTool::MakeNewO
 	Op->BindType = Properties->BindingType;
 	Op->Stiffness = Properties->Stiffness;
 	Op->MaxInfluences = Properties->MaxInfluences;
-	Op->VoxelResolution = Properties->VoxelResolution;
+	if (Op->BindType == ESkinWeightsBindType::GeodesicVoxel)
+	{
+		Op->OccupancyGrid = GetOccupancyGrid();
+	}
 	
 	Op->OriginalMesh = OriginalMesh;
 	Op->TransformHierarchy = TransformHierarchy;
@@ -1002,6 +1150,28 @@ TUniquePtr<UE::Geometry::FDynamicMeshOperator> USkinWeightsBindingTool::MakeNewO
 }
 
 
+TSharedFuture<USkinWeightsBindingTool::FOccupancyGridPtr> USkinWeightsBindingTool::GetOccupancyGrid()
+{
+	const uint64 MeshChangeStamp = OriginalMesh->GetChangeStamp();
+	const int32 VoxelResolution = FMath::Max(Properties->VoxelResolution, 1);
+
+	if (!Occupancy.IsValid() || OccupancyMeshChangeStamp != MeshChangeStamp || OccupancyVoxelResolution != VoxelResolution)
+	{
+		OccupancyMeshChangeStamp = MeshChangeStamp;
+		OccupancyVoxelResolution = VoxelResolution;
+
+		// Operators that still hold the previous grid keep it alive until they finish.
+		TSharedPtr<const FDynamicMesh3, ESPMode::ThreadSafe> Mesh = OriginalMesh;
+		Occupancy = Async(EAsyncExecution::ThreadPool, [Mesh, VoxelResolution]() -> FOccupancyGridPtr
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE(SkinWeightsBindingTool_BuildOccupancyGrid);
+			return MakeShared<FOccupancyGrid, ESPMode::ThreadSafe>(*Mesh, VoxelResolution);
+		}).Share();
+	}
+	return Occupancy;
+}
+
+
 void USkinWeightsBindingTool::GenerateAsset(const FDynamicMeshOpResult& Result)
 {
 	// TODO: Update FDynamicMeshToMeshDescription to allow update the skin weights only.
@@ -1013,14 +1183,54 @@ void USkinWeightsBindingTool::GenerateAsset(const FDynamicMeshOpResult& Result)
 	GetToolManager()->EndUndoTransaction();	
 }
 
-FVector4f USkinWeightsBindingTool::WeightToColor(float Value)
+void USkinWeightsBindingTool::UpdateBoneVertexWeights()
 {
-	Value = FMath::Clamp(Value, 0.0f, 1.0f);
+	using namespace UE::AnimationCore;
+	using namespace UE::Geometry;
+
+	const int32 NumBones = TransformHierarchy.Num();
+	BoneVertexOffsets.Reset();
+	BoneVertexOffsets.SetNumZeroed(NumBones + 1);
+	BoneVertexWeights.Reset();
+	VisualizedBoneIndex = INDEX_NONE;
+
+	const FDynamicMesh3* Mesh = Preview->PreviewMesh->GetMesh();
+	const FDynamicMeshVertexSkinWeightsAttribute* SkinWeights = Mesh->HasAttributes() ? Mesh->Attributes()->GetSkinWeightsAttribute(FSkeletalMeshAttributes::DefaultSkinWeightProfileName) : nullptr;
+	if (!SkinWeights)
+	{
+		return;
+	}
 
+	// Count the vertices of each bone, turn the counts into offsets, then fill in the vertices.
+	FBoneWeights BoneWeights;
+	for (const int32 VertexId : Mesh->VertexIndicesItr())
 	{
-		// A close approximation of the skeletal mesh editor's bone weight ramp. 
-		const FLinearColor HSV((1.0f - Value) * 285.0f, 100.0f, 85.0f);
-		return UE::Geometry::ToVector4<float>(HSV.HSVToLinearRGB());
+		SkinWeights->GetValue(VertexId, BoneWeights);
+		for (const FBoneWeight BW : BoneWeights)
+		{
+			if (BW.GetBoneIndex() < NumBones)
+			{
+				BoneVertexOffsets[BW.GetBoneIndex() + 1]++;
+			}
+		}
+	}
+	for (int32 BoneIndex = 0; BoneIndex < NumBones; BoneIndex++)
+	{
+		BoneVertexOffsets[BoneIndex + 1] += BoneVertexOffsets[BoneIndex];
+	}
+
+	TArray<int32> NextVertex(BoneVertexOffsets.GetData(), NumBones);
+	BoneVertexWeights.SetNumUninitialized(BoneVertexOffsets.Last());
+	for (const int32 VertexId : Mesh->VertexIndicesItr())
+	{
+		SkinWeights->GetValue(VertexId, BoneWeights);
+		for (const FBoneWeight BW : BoneWeights)
+		{
+			if (BW.GetBoneIndex() < NumBones)
+			{
+				BoneVertexWeights[NextVertex[BW.GetBoneIndex()]++] = MakeTuple(VertexId, BW.GetWeight());
+			}
+		}
 	}
 }
 
@@ -1032,43 +1242,48 @@ void USkinWeightsBindingTool::UpdateVisualization(bool bInForce)
 	if ((bInForce || Preview->HaveValidNonEmptyResult()) && BoneToIndex.Contains(Properties->CurrentBone.BoneName))
 	{
 		const FBoneIndexType BoneIndex = BoneToIndex[Properties->CurrentBone.BoneName];
+		if (BoneIndex == VisualizedBoneIndex || !ensure(BoneIndex + 1 < BoneVertexOffsets.Num()))
+		{
+			return;
+		}
 
 		// update mesh with new value colors
-		Preview->PreviewMesh->EditMesh([&](FDynamicMesh3& InMesh)
+		Preview->PreviewMesh->DeferredEditMesh([&](FDynamicMesh3& InMesh)
 		{
-			FDynamicMeshVertexSkinWeightsAttribute *SkinWeights = InMesh.Attributes()->GetSkinWeightsAttribute(FSkeletalMeshAttributes::DefaultSkinWeightProfileName);
 			FDynamicMeshColorOverlay* ColorOverlay = InMesh.Attributes()->PrimaryColors();
+			const FVector4f ZeroColor(UE::SkinWeightsUtil::WeightToColor(0.0f));
 
-			if (!ColorOverlay)
-			{
-				InMesh.EnableAttributes();
-				InMesh.Attributes()->EnablePrimaryColors();
-				// Create an overlay that has no split elements, init with zero value.
-				ColorOverlay = InMesh.Attributes()->PrimaryColors();
-				ColorOverlay->CreateFromPredicate([](int ParentVID, int TriIDA, int TriIDB){return true;}, 0.f);
-			}
-			
-			FBoneWeights BoneWeights;
-			
-			for (int32 ElementId : ColorOverlay->ElementIndicesItr())
+			// Only the vertices of the previous and the new bone can change color, so when switching bones
+			// clear the previous bone's vertices rather than the whole mesh.
+			if (VisualizedBoneIndex == INDEX_NONE)
 			{
-				const int32 VertexId = ColorOverlay->GetParentVertex(ElementId);
-				SkinWeights->GetValue(VertexId, BoneWeights);
-
-				float Weight = 0.0f;
-				for (FBoneWeight BW: BoneWeights)
+				ParallelFor(ColorOverlay->MaxElementID(), [&](int32 ElementId)
 				{
-					if (BW.GetBoneIndex() == BoneIndex)
+					if (ColorOverlay->IsElement(ElementId))
 					{
-						Weight = BW.GetWeight();
-						break;
+						ColorOverlay->SetElement(ElementId, ZeroColor);
 					}
-				}
-				
-				const FVector4f Color(WeightToColor(Weight));
-				ColorOverlay->SetElement(ElementId, Color);
+				});
 			}
-		});
+			else
+			{
+				const int32 PreviousStart = BoneVertexOffsets[VisualizedBoneIndex];
+				ParallelFor(BoneVertexOffsets[VisualizedBoneIndex + 1] - PreviousStart, [&](int32 Index)
+				{
+					VertexColorElements.SetColor(*ColorOverlay, BoneVertexWeights[PreviousStart + Index].Key, ZeroColor);
+				});
+			}
+
+			const int32 Start = BoneVertexOffsets[BoneIndex];
+			ParallelFor(BoneVertexOffsets[BoneIndex + 1] - Start, [&](int32 Index)
+			{
+				const TPair<int32, float>& VertexWeight = BoneVertexWeights[Start + Index];
+				VertexColorElements.SetColor(*ColorOverlay, VertexWeight.Key, UE::SkinWeightsUtil::WeightToColor(VertexWeight.Value));
+			});
+		}, false);
+		Preview->PreviewMesh->NotifyDeferredEditCompleted(UPreviewMesh::ERenderUpdateMode::FastUpdate, EMeshRenderAttributeFlags::VertexColors, false);
+
+		VisualizedBoneIndex = BoneIndex;
 	}
 }
 
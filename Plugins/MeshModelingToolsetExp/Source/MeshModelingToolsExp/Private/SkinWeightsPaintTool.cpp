@@ -7,6 +7,7 @@
 #include "SkeletalMeshAttributes.h"
 #include "SkeletalDebugRendering.h"
 #include "Math/UnrealMathUtility.h"
+#include "Async/ParallelFor.h"
 #include "Components/SkeletalMeshComponent.h"
 
 #include "TargetInterfaces/PrimitiveComponentBackedTarget.h"
@@ -27,17 +28,17 @@ void FMeshSkinWeightsChange::Apply(UObject* Object)
 {
 	USkinWeightsPaintTool* Tool = CastChecked<USkinWeightsPaintTool>(Object);
 
-	Tool->ExternalUpdateValues(BoneName, NewWeights);
+	Tool->ExternalUpdateValues(NewWeights);
 }
 
 void FMeshSkinWeightsChange::Revert(UObject* Object)
 {
 	USkinWeightsPaintTool* Tool = CastChecked<USkinWeightsPaintTool>(Object);
 
-	Tool->ExternalUpdateValues(BoneName, OldWeights);
+	Tool->ExternalUpdateValues(OldWeights);
 }
 
-void FMeshSkinWeightsChange::UpdateValues(const TArray<int32>& Indices, const TArray<float>& OldValues, const TArray<float>& NewValues)
+void FMeshSkinWeightsChange::UpdateValues(const TArray<int32>& Indices, const TArray<FVertexInfluences>& OldValues, const TArray<FVertexInfluences>& NewValues)
 {
 	const int32 NumIndices = Indices.Num();
 	for (int32 i = 0; i < NumIndices; i++)
@@ -48,6 +49,212 @@ void FMeshSkinWeightsChange::UpdateValues(const TArray<int32>& Indices, const TA
 }
 
 
+void FSkinWeightsVertexInfluences::Initialize(int32 NumVertices, int32 NumBones)
+{
+	Influences.SetNumUninitialized(NumVertices * MaxInfluences);
+	NumInfluences.Reset();
+	NumInfluences.SetNumZeroed(NumVertices);
+	BoneVertices.Reset();
+	BoneVertices.SetNum(NumBones);
+	BoneVertexPositions.SetNumUninitialized(NumVertices * MaxInfluences);
+}
+
+float FSkinWeightsVertexInfluences::GetWeight(int32 VertexIndex, FBoneIndexType BoneIndex) const
+{
+	for (const FInfluence& Influence : GetInfluences(VertexIndex))
+	{
+		if (Influence.BoneIndex == BoneIndex)
+		{
+			return Influence.Weight;
+		}
+	}
+	return 0.0f;
+}
+
+bool FSkinWeightsVertexInfluences::SetWeight(int32 VertexIndex, FBoneIndexType BoneIndex, float Weight)
+{
+	FInfluence* VertexInfluences = &Influences[VertexIndex * MaxInfluences];
+	int32* VertexPositions = &BoneVertexPositions[VertexIndex * MaxInfluences];
+	uint8& NumVertexInfluences = NumInfluences[VertexIndex];
+
+	int32 WeakestIndex = INDEX_NONE;
+	for (int32 Index = 0; Index < NumVertexInfluences; Index++)
+	{
+		if (VertexInfluences[Index].BoneIndex == BoneIndex)
+		{
+			// Keep the bone on the vertex even if its weight goes to zero, so that the bone index stays valid.
+			VertexInfluences[Index].Weight = Weight;
+			return true;
+		}
+		if (WeakestIndex == INDEX_NONE || VertexInfluences[Index].Weight < VertexInfluences[WeakestIndex].Weight)
+		{
+			WeakestIndex = Index;
+		}
+	}
+
+	if (Weight <= 0.0f)
+	{
+		return false;
+	}
+
+	int32 Slot;
+	if (NumVertexInfluences < MaxInfluences)
+	{
+		Slot = NumVertexInfluences++;
+	}
+	else if (VertexInfluences[WeakestIndex].Weight < Weight)
+	{
+		Slot = WeakestIndex;
+		RemoveBoneVertex(VertexInfluences[Slot].BoneIndex, VertexPositions[Slot]);
+	}
+	else
+	{
+		return false;
+	}
+	VertexInfluences[Slot] = { BoneIndex, Weight };
+	VertexPositions[Slot] = BoneVertices[BoneIndex].Add(VertexIndex);
+	return true;
+}
+
+
+void FSkinWeightsVertexInfluences::SetInfluences(int32 VertexIndex, TArrayView<const FInfluence> NewInfluences)
+{
+	check(NewInfluences.Num() <= MaxInfluences);
+
+	FInfluence* VertexInfluences = &Influences[VertexIndex * MaxInfluences];
+	int32* VertexPositions = &BoneVertexPositions[VertexIndex * MaxInfluences];
+
+	// Keep the bone index in sync with the bones that were added to or dropped from the vertex. Bones that stay on the
+	// vertex keep their position in the bone index.
+	int32 NewPositions[MaxInfluences];
+	for (int32 NewSlot = 0; NewSlot < NewInfluences.Num(); NewSlot++)
+	{
+		NewPositions[NewSlot] = INDEX_NONE;
+	}
+	for (int32 OldSlot = 0; OldSlot < NumInfluences[VertexIndex]; OldSlot++)
+	{
+		const FBoneIndexType OldBoneIndex = VertexInfluences[OldSlot].BoneIndex;
+		const int32 NewSlot = NewInfluences.IndexOfByPredicate([OldBoneIndex](const FInfluence& Influence) { return Influence.BoneIndex == OldBoneIndex; });
+		if (NewSlot == INDEX_NONE)
+		{
+			RemoveBoneVertex(OldBoneIndex, VertexPositions[OldSlot]);
+		}
+		else
+		{
+			NewPositions[NewSlot] = VertexPositions[OldSlot];
+		}
+	}
+
+	FMemory::Memcpy(VertexInfluences, NewInfluences.GetData(), NewInfluences.Num() * sizeof(FInfluence));
+	NumInfluences[VertexIndex] = static_cast<uint8>(NewInfluences.Num());
+	for (int32 NewSlot = 0; NewSlot < NewInfluences.Num(); NewSlot++)
+	{
+		VertexPositions[NewSlot] = (NewPositions[NewSlot] != INDEX_NONE) ? NewPositions[NewSlot] : BoneVertices[NewInfluences[NewSlot].BoneIndex].Add(VertexIndex);
+	}
+}
+
+
+void FSkinWeightsVertexInfluences::RemoveBoneVertex(FBoneIndexType BoneIndex, int32 Position)
+{
+	TArray<int32>& Vertices = BoneVertices[BoneIndex];
+	Vertices.RemoveAtSwap(Position, 1, false);
+	if (Position == Vertices.Num())
+	{
+		return;
+	}
+
+	// the last vertex moved into Position, find the influence entry that refers to it
+	const int32 MovedVertexIndex = Vertices[Position];
+	const int32 NumMovedInfluences = NumInfluences[MovedVertexIndex];
+	for (int32 Slot = 0; Slot < NumMovedInfluences; Slot++)
+	{
+		if (Influences[MovedVertexIndex * MaxInfluences + Slot].BoneIndex == BoneIndex)
+		{
+			BoneVertexPositions[MovedVertexIndex * MaxInfluences + Slot] = Position;
+			return;
+		}
+	}
+	checkNoEntry();
+}
+
+
+namespace
+{
+	/**
+	 * Set the weight of BoneIndex in the influences of a vertex, and scale the weights of its other bones that are not
+	 * locked so that the weights still sum to one. If the vertex has no room for another bone, the unlocked bone with
+	 * the lowest weight is dropped. Weight removed from a vertex without other unlocked bones has nowhere to go, so
+	 * the bone can then only gain weight.
+	 */
+	void SetNormalizedWeight(FSkinWeightsVertexInfluences::FVertexInfluences& Influences, FBoneIndexType BoneIndex, float Weight, const TArray<FBoneIndexType>& LockedBones)
+	{
+		int32 BoneSlot = Influences.IndexOfByPredicate([BoneIndex](const FSkinWeightsVertexInfluences::FInfluence& Influence) { return Influence.BoneIndex == BoneIndex; });
+		if (BoneSlot == INDEX_NONE)
+		{
+			if (Weight <= 0.0f)
+			{
+				return;
+			}
+			if (Influences.Num() == FSkinWeightsVertexInfluences::MaxInfluences)
+			{
+				int32 WeakestSlot = INDEX_NONE;
+				for (int32 Slot = 0; Slot < Influences.Num(); ++Slot)
+				{
+					if (!LockedBones.Contains(Influences[Slot].BoneIndex) && (WeakestSlot == INDEX_NONE || Influences[Slot].Weight < Influences[WeakestSlot].Weight))
+					{
+						WeakestSlot = Slot;
+					}
+				}
+				if (WeakestSlot == INDEX_NONE)
+				{
+					return;
+				}
+				Influences.RemoveAtSwap(WeakestSlot);
+			}
+			BoneSlot = Influences.Add({ BoneIndex, 0.0f });
+		}
+
+		const float OldWeight = Influences[BoneSlot].Weight;
+		float LockedWeight = 0.0f, UnlockedWeight = 0.0f;
+		for (int32 Slot = 0; Slot < Influences.Num(); ++Slot)
+		{
+			if (Slot == BoneSlot)
+			{
+				continue;
+			}
+			if (LockedBones.Contains(Influences[Slot].BoneIndex))
+			{
+				LockedWeight += Influences[Slot].Weight;
+			}
+			else
+			{
+				UnlockedWeight += Influences[Slot].Weight;
+			}
+		}
+
+		const float AvailableWeight = FMath::Max(1.0f - LockedWeight, 0.0f);
+		Weight = FMath::Clamp(Weight, 0.0f, AvailableWeight);
+		if (UnlockedWeight <= 0.0f)
+		{
+			Weight = FMath::Max(Weight, FMath::Min(OldWeight, AvailableWeight));
+		}
+		Influences[BoneSlot].Weight = Weight;
+
+		if (UnlockedWeight > 0.0f)
+		{
+			const float Scale = (AvailableWeight - Weight) / UnlockedWeight;
+			for (int32 Slot = 0; Slot < Influences.Num(); ++Slot)
+			{
+				if (Slot != BoneSlot && !LockedBones.Contains(Influences[Slot].BoneIndex))
+				{
+					Influences[Slot].Weight *= Scale;
+				}
+			}
+		}
+	}
+}
+
+
 /*
  * ToolBuilder
  */
@@ -114,6 +321,7 @@ void USkinWeightsPaintTool::Setup()
 		// Create an overlay that has no split elements, init with zero value.
 		Mesh.Attributes()->PrimaryColors()->CreateFromPredicate([](int ParentVID, int TriIDA, int TriIDB){return true;}, 0.f);
 	});
+	VertexColorElements.Initialize(*PreviewMesh->GetMesh(), *PreviewMesh->GetMesh()->Attributes()->PrimaryColors());
 
 	// build octree
 	VerticesOctree.Initialize(PreviewMesh->GetMesh(), true);
@@ -295,37 +503,50 @@ void USkinWeightsPaintTool::CalculateVertexROI(const FBrushStampData& Stamp, TAr
 }
 
 
-FVector4f USkinWeightsPaintTool::WeightToColor(float Value)
-{
-	Value = FMath::Clamp(Value, 0.0f, 1.0f);
-
-	{
-		// A close approximation of the skeletal mesh editor's bone weight ramp. 
-		const FLinearColor HSV((1.0f - Value) * 285.0f, 100.0f, 85.0f);
-		return UE::Geometry::ToVector4<float>(HSV.HSVToLinearRGB());
-	}
-}
-
-
 void USkinWeightsPaintTool::UpdateBoneVisualization()
 {
-	if (!SkinWeightsMap.Contains(CurrentBone))
-		return;
+	using namespace UE::Geometry;
 
-	TArray<float>& SkinWeightsData = *SkinWeightsMap.Find(CurrentBone);
+	if (CurrentBoneIndex == INDEX_NONE)
+		return;
+	const FBoneIndexType BoneIndex = static_cast<FBoneIndexType>(CurrentBoneIndex);
 
 	// update mesh with new value colors
-	PreviewMesh->EditMesh([&](FDynamicMesh3& Mesh)
+	PreviewMesh->DeferredEditMesh([&](FDynamicMesh3& Mesh)
 	{
-		UE::Geometry::FDynamicMeshColorOverlay* ColorOverlay = Mesh.Attributes()->PrimaryColors();
-		for (int32 ElementId : ColorOverlay->ElementIndicesItr())
+		FDynamicMeshColorOverlay* ColorOverlay = Mesh.Attributes()->PrimaryColors();
+		auto SetBoneVertexColors = [this, ColorOverlay, BoneIndex](FBoneIndexType FromBoneIndex)
+		{
+			const TArray<int32>& BoneVertices = SkinWeights.GetBoneVertices(FromBoneIndex);
+			ParallelFor(BoneVertices.Num(), [&](int32 Index)
+			{
+				const int32 VertexId = BoneVertices[Index];
+				VertexColorElements.SetColor(*ColorOverlay, VertexId, UE::SkinWeightsUtil::WeightToColor(SkinWeights.GetWeight(VertexId, BoneIndex)));
+			});
+		};
+
+		// Only vertices influenced by the previous or the new bone can change color, so when switching
+		// bones recolor those rather than the whole mesh.
+		if (VisualizedBoneIndex == INDEX_NONE)
 		{
-			const int32 VertexId = ColorOverlay->GetParentVertex(ElementId);
-			const float Value = SkinWeightsData[VertexId];
-			const FVector4f Color(WeightToColor(Value));
-			ColorOverlay->SetElement(ElementId, Color);
+			const FVector4f ZeroColor(UE::SkinWeightsUtil::WeightToColor(0.0f));
+			ParallelFor(ColorOverlay->MaxElementID(), [&](int32 ElementId)
+			{
+				if (ColorOverlay->IsElement(ElementId))
+				{
+					ColorOverlay->SetElement(ElementId, ZeroColor);
+				}
+			});
 		}
-	});
+		else if (VisualizedBoneIndex != CurrentBoneIndex)
+		{
+			SetBoneVertexColors(static_cast<FBoneIndexType>(VisualizedBoneIndex));
+		}
+		SetBoneVertexColors(BoneIndex);
+	}, false);
+	PreviewMesh->NotifyDeferredEditCompleted(UPreviewMesh::ERenderUpdateMode::FastUpdate, EMeshRenderAttributeFlags::VertexColors, false);
+
+	VisualizedBoneIndex = CurrentBoneIndex;
 }
 
 
@@ -348,10 +569,27 @@ double USkinWeightsPaintTool::CalculateBrushFalloff(double Distance) const
 void USkinWeightsPaintTool::ApplyStamp(const FBrushStampData& Stamp)
 {
 	using namespace UE::Geometry;
+	using FVertexInfluences = FSkinWeightsVertexInfluences::FVertexInfluences;
 	
 	// FIXME: Move to earlier.
-	if (!SkinWeightsMap.Contains(CurrentBone))
+	if (CurrentBoneIndex == INDEX_NONE)
 		return;
+	const FBoneIndexType BoneIndex = static_cast<FBoneIndexType>(CurrentBoneIndex);
+
+	const FReferenceSkeleton& RefSkeleton = BoneContainer.GetReferenceSkeleton();
+	TArray<FBoneIndexType> LockedBoneIndices;
+	for (const FBoneReference& LockedBone : ToolProps->LockedBones)
+	{
+		const int32 LockedBoneIndex = RefSkeleton.FindBoneIndex(LockedBone.BoneName);
+		if (LockedBoneIndex != INDEX_NONE)
+		{
+			LockedBoneIndices.AddUnique(static_cast<FBoneIndexType>(LockedBoneIndex));
+		}
+	}
+	if (LockedBoneIndices.Contains(BoneIndex))
+	{
+		return;
+	}
 
 	IPrimitiveComponentBackedTarget* TargetComponent = Cast<IPrimitiveComponentBackedTarget>(Target);
 	FTransform3d Transform(TargetComponent->GetWorldTransform());
@@ -361,52 +599,49 @@ void USkinWeightsPaintTool::ApplyStamp(const FBrushStampData& Stamp)
 	CalculateVertexROI(Stamp, ROIVertices);
 	const int32 NumROIVertices = ROIVertices.Num();
 
-	TArray<float> ROIBefore, ROIAfter;
+	TArray<FVertexInfluences> ROIBefore, ROIAfter;
 	ROIBefore.SetNum(NumROIVertices);
 	ROIAfter.SetNum(NumROIVertices);
 
-	TArray<float>& SkinWeightsData = *SkinWeightsMap.Find(CurrentBone);
-
+	// Vertices only read the weights of the mesh, and write into their own ROI entries, until all are evaluated.
 	const FDynamicMesh3* CurrentMesh = PreviewMesh->GetMesh();
-	if (bInSmoothStroke)
+	const bool bSmooth = bInSmoothStroke;
+	const float Sign = (bInRemoveStroke) ? -1.0f : 1.0f;
+	const float UseStrength = Sign * BrushProperties->BrushStrength;
+	ParallelFor(NumROIVertices, [&](int32 Index)
 	{
-		const float SmoothSpeed = 0.25f;
+		const int32 VertexId = ROIVertices[Index];
+		const FVector3d Position = CurrentMesh->GetVertex(VertexId);
+		const float Falloff = (float)CalculateBrushFalloff(FVector3d::Dist(Position, StampPosLocal));
+		const float OldValue = SkinWeights.GetWeight(VertexId, BoneIndex);
 
-		for (int32 Index = 0; Index < NumROIVertices; ++Index)
+		float NewValue;
+		if (bSmooth)
 		{
-			const int32 VertexId = ROIVertices[Index];
-			FVector3d Position = CurrentMesh->GetVertex(VertexId);
+			const float SmoothSpeed = 0.25f;
+
 			float ValueSum = 0, WeightSum = 0;
 			for (int32 NeighborVertexId : CurrentMesh->VtxVerticesItr(VertexId))
 			{
 				FVector3d NbrPos = CurrentMesh->GetVertex(NeighborVertexId);
 				const float Weight = FMathf::Clamp(1.0f / FVector3d::DistSquared(NbrPos, Position), 0.0001f, 1000.0f);
-				ValueSum += Weight * SkinWeightsData[NeighborVertexId];
+				ValueSum += Weight * SkinWeights.GetWeight(NeighborVertexId, BoneIndex);
 				WeightSum += Weight;
 			}
 			ValueSum /= WeightSum;
 
-			const float Falloff = float(CalculateBrushFalloff(FVector3d::Dist(Position, StampPosLocal)));
-			const float NewValue = FMathf::Lerp(SkinWeightsData[VertexId], ValueSum, SmoothSpeed*Falloff);
-
-			ROIBefore[Index] = SkinWeightsData[VertexId];
-			ROIAfter[Index] = FMath::Clamp(NewValue, 0.0f, 1.0f);
+			NewValue = FMathf::Lerp(OldValue, ValueSum, SmoothSpeed*Falloff);
 		}
-	}
-	else
-	{
-		const bool bInvert = bInRemoveStroke;
-		const float Sign = (bInvert) ? -1.0f : 1.0f;
-		const float UseStrength = Sign * BrushProperties->BrushStrength;
-		for (int32 Index = 0; Index < NumROIVertices; ++Index)
+		else
 		{
-			const int32 VertexId = ROIVertices[Index];
-			const FVector3d Position = CurrentMesh->GetVertex(VertexId);
-			const float Falloff = (float)CalculateBrushFalloff(FVector3d::Dist(Position, StampPosLocal));
-			ROIBefore[Index] = SkinWeightsData[VertexId];
-			ROIAfter[Index] = FMath::Clamp(ROIBefore[Index] + UseStrength * Falloff, 0.0f, 1.0f);
+			NewValue = OldValue + UseStrength * Falloff;
 		}
-	}
+
+		const TArrayView<const FSkinWeightsVertexInfluences::FInfluence> Influences = SkinWeights.GetInfluences(VertexId);
+		ROIBefore[Index].Append(Influences.GetData(), Influences.Num());
+		ROIAfter[Index] = ROIBefore[Index];
+		SetNormalizedWeight(ROIAfter[Index], BoneIndex, FMath::Clamp(NewValue, 0.0f, 1.0f), LockedBoneIndices);
+	});
 
 	// track changes
 	if (ActiveChange)
@@ -415,31 +650,40 @@ void USkinWeightsPaintTool::ApplyStamp(const FBrushStampData& Stamp)
 	}
 
 	// update values and colors
+	for (int32 Index = 0; Index < NumROIVertices; ++Index)
+	{
+		SkinWeights.SetInfluences(ROIVertices[Index], ROIAfter[Index]);
+	}
+	UpdateVertexColors(ROIVertices);
+}
+
+
+void USkinWeightsPaintTool::UpdateVertexColors(const TArray<int32>& VertexIds)
+{
+	using namespace UE::Geometry;
+
+	if (CurrentBoneIndex == INDEX_NONE)
+		return;
+	const FBoneIndexType BoneIndex = static_cast<FBoneIndexType>(CurrentBoneIndex);
+
 	PreviewMesh->DeferredEditMesh([&](FDynamicMesh3& Mesh)
 	{
-		TArray<int> ElementIds;
+		// Vertices own disjoint sets of elements, so they can be written in parallel.
 		FDynamicMeshColorOverlay* ColorOverlay = Mesh.Attributes()->PrimaryColors();
-		for (int32 Index = 0; Index < NumROIVertices; ++Index)
+		ParallelFor(VertexIds.Num(), [&](int32 Index)
 		{
-			const int32 VertexId = ROIVertices[Index];
-			SkinWeightsData[VertexId] = ROIAfter[Index];
-			FVector4f NewColor(WeightToColor(ROIAfter[Index]));
-			ColorOverlay->GetVertexElements(VertexId, ElementIds);
-			for (int ElementId : ElementIds)
-			{
-				ColorOverlay->SetElement(ElementId, NewColor);
-			}
-			ElementIds.Reset();
-		}
+			const int32 VertexId = VertexIds[Index];
+			VertexColorElements.SetColor(*ColorOverlay, VertexId, UE::SkinWeightsUtil::WeightToColor(SkinWeights.GetWeight(VertexId, BoneIndex)));
+		});
 	}, false);
 	PreviewMesh->NotifyDeferredEditCompleted(UPreviewMesh::ERenderUpdateMode::FastUpdate, EMeshRenderAttributeFlags::VertexColors, false);
-
 }
 
 
 void USkinWeightsPaintTool::UpdateCurrentBone(const FName& BoneName)
 {
 	CurrentBone = BoneName;
+	CurrentBoneIndex = BoneContainer.GetReferenceSkeleton().FindBoneIndex(BoneName);
 
 	bVisibleWeightsValid = false;
 }
@@ -610,7 +854,7 @@ void USkinWeightsPaintTool::RenderBonePositions(FPrimitiveDrawInterface* PDI)
 
 void USkinWeightsPaintTool::BeginChange()
 {
-	ActiveChange = MakeUnique<FMeshSkinWeightsChange>(CurrentBone);
+	ActiveChange = MakeUnique<FMeshSkinWeightsChange>();
 }
 
 
@@ -620,21 +864,17 @@ TUniquePtr<FMeshSkinWeightsChange> USkinWeightsPaintTool::EndChange()
 }
 
 
-void USkinWeightsPaintTool::ExternalUpdateValues(const FName& BoneName, const TMap<int32, float>& NewValues)
+void USkinWeightsPaintTool::ExternalUpdateValues(const TMap<int32, FSkinWeightsVertexInfluences::FVertexInfluences>& NewValues)
 {
-	TArray<float>* SkinWeightValues = SkinWeightsMap.Find(BoneName);
-	if (SkinWeightValues == nullptr)
-	{
-		return;
-	}
-
+	TArray<int32> VertexIds;
+	VertexIds.Reserve(NewValues.Num());
 	for (const auto& IV : NewValues)
 	{
-		SkinWeightValues->GetData()[IV.Key] = IV.Value;
+		SkinWeights.SetInfluences(IV.Key, IV.Value);
+		VertexIds.Add(IV.Key);
 	}
 
-	if (BoneName == CurrentBone)
-		UpdateBoneVisualization();
+	UpdateVertexColors(VertexIds);
 }
 
 
@@ -646,12 +886,7 @@ void USkinWeightsPaintTool::InitializeSkinWeights()
 	const FSkinWeightsVertexAttributesConstRef VertexSkinWeights = MeshAttribs.GetVertexSkinWeights();
 	const int32 NumVertices = EditedMesh->Vertices().Num();
 
-	// Create a map of all bones to their per-vertex weights.
-	SkinWeightsMap.Reset();
-	for (const FMeshBoneInfo& BoneInfo : RefSkeleton.GetRefBoneInfo())
-	{
-		SkinWeightsMap.Add(BoneInfo.Name, {}).AddZeroed(NumVertices);
-	}
+	SkinWeights.Initialize(NumVertices, RefSkeleton.GetNum());
 
 	for (int32 VertexIndex = 0; VertexIndex < NumVertices; VertexIndex++)
 	{
@@ -659,26 +894,22 @@ void USkinWeightsPaintTool::InitializeSkinWeights()
 
 		for (UE::AnimationCore::FBoneWeight BoneWeight: VertexSkinWeights.Get(VertexID))
 		{
-			FName BoneName = RefSkeleton.GetBoneName(static_cast<int32>(BoneWeight.GetBoneIndex()));
+			const int32 BoneIndex = static_cast<int32>(BoneWeight.GetBoneIndex());
 			const float Weight = BoneWeight.GetWeight();
 
-			if (Weight >= MinimumWeightThreshold)
+			// If the source mesh has a bone that we don't recognize, we ignore it. It's
+			// weight will get cleared when the new weights are updated back to the 
+			// source mesh.
+			if (Weight >= MinimumWeightThreshold && BoneIndex < RefSkeleton.GetNum())
 			{
-				// If the source mesh has a bone that we don't recognize, we ignore it. It's
-				// weight will get cleared when the new weights are updated back to the 
-				// source mesh.
-				TArray<float>* PerVertexWeights = SkinWeightsMap.Find(BoneName);
-
-				if (PerVertexWeights)
-				{
-					PerVertexWeights->GetData()[VertexIndex] = Weight;
-				}
+				SkinWeights.SetWeight(VertexIndex, static_cast<FBoneIndexType>(BoneIndex), Weight);
 			}
 		}
 	}
 
 	// Pick a root bone.
 	CurrentBone = RefSkeleton.GetBoneName(0);
+	CurrentBoneIndex = 0;
 	PendingCurrentBone.Reset();
 }
 
@@ -690,18 +921,6 @@ void USkinWeightsPaintTool::UpdateEditedSkinWeightsMesh()
 	FSkeletalMeshAttributes MeshAttribs(*EditedMesh);
 	FSkinWeightsVertexAttributesRef VertexSkinWeights = MeshAttribs.GetVertexSkinWeights();
 	
-	const FReferenceSkeleton& RefSkeleton = BoneContainer.GetReferenceSkeleton();
-
-	TMap<FBoneIndexType, const TArray<float>*> BoneIndexWeightMap;
-	for (const auto& BoneNameAndWeights : SkinWeightsMap)
-	{
-		const int32 BoneIndex = RefSkeleton.FindBoneIndex(BoneNameAndWeights.Key);
-		if (BoneIndex != INDEX_NONE)
-		{
-			BoneIndexWeightMap.Add(static_cast<FBoneIndexType>(BoneIndex), &BoneNameAndWeights.Value);
-		}
-	}
-
 	FBoneWeightsSettings Settings;
 	Settings.SetNormalizeType(EBoneWeightNormalizeType::AboveOne);
 
@@ -713,9 +932,9 @@ void USkinWeightsPaintTool::UpdateEditedSkinWeightsMesh()
 	{
 		SourceBoneWeights.Reset();
 
-		for (const auto& BoneIndexWeight : BoneIndexWeightMap)
+		for (const FSkinWeightsVertexInfluences::FInfluence& Influence : SkinWeights.GetInfluences(VertexIndex))
 		{
-			SourceBoneWeights.Add(FBoneWeight(BoneIndexWeight.Key, (*BoneIndexWeight.Value)[VertexIndex]));
+			SourceBoneWeights.Add(FBoneWeight(Influence.BoneIndex, Influence.Weight));
 		}
 
 		VertexSkinWeights.Set(FVertexID(VertexIndex), FBoneWeights::Create(SourceBoneWeights, Settings));
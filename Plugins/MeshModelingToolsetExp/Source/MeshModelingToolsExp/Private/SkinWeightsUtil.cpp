@@ -0,0 +1,48 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "SkinWeightsUtil.h"
+
+using namespace UE::Geometry;
+
+
+const FVector4f& UE::SkinWeightsUtil::WeightToColor(float Weight)
+{
+	static const TStaticArray<FVector4f, 256> Ramp = []()
+	{
+		TStaticArray<FVector4f, 256> Colors;
+		for (int32 Index = 0; Index < 256; ++Index)
+		{
+			const float Value = (float)Index / 255.0f;
+			const FLinearColor HSV((1.0f - Value) * 285.0f, 100.0f, 85.0f);
+			Colors[Index] = ToVector4<float>(HSV.HSVToLinearRGB());
+		}
+		return Colors;
+	}();
+
+	return Ramp[FMath::Clamp(FMath::RoundToInt(Weight * 255.0f), 0, 255)];
+}
+
+
+void UE::SkinWeightsUtil::FVertexColorElements::Initialize(const FDynamicMesh3& Mesh, const FDynamicMeshColorOverlay& ColorOverlay)
+{
+	const int32 MaxVertexID = Mesh.MaxVertexID();
+
+	// Count the elements of each vertex, turn the counts into offsets, then fill in the elements.
+	Offsets.Reset();
+	Offsets.SetNumZeroed(MaxVertexID + 1);
+	for (int32 ElementID : ColorOverlay.ElementIndicesItr())
+	{
+		Offsets[ColorOverlay.GetParentVertex(ElementID) + 1]++;
+	}
+	for (int32 VertexID = 0; VertexID < MaxVertexID; ++VertexID)
+	{
+		Offsets[VertexID + 1] += Offsets[VertexID];
+	}
+
+	TArray<int32> NextElement(Offsets.GetData(), MaxVertexID);
+	Elements.SetNumUninitialized(Offsets.Last());
+	for (int32 ElementID : ColorOverlay.ElementIndicesItr())
+	{
+		Elements[NextElement[ColorOverlay.GetParentVertex(ElementID)]++] = ElementID;
+	}
+}
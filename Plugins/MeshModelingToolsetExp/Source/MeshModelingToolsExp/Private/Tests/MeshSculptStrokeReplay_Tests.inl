@@ -0,0 +1,374 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+//
+// This file is included in MeshSculptStrokeRecorder.cpp
+//
+// Sculpt stroke replay benchmark. Replays a stroke recording (see modeling.Sculpting.RecordStrokes), or a generated one,
+// into a sculpt tool on a generated sphere mesh. Per-stamp stage timings are written to Saved/Sculpting/StrokeReplay_*.csv,
+// and the hash of the final mesh is compared with the expected one, so behavior changes are caught too. Expected hashes
+// for the generated strokes are checked in to Resources/SculptStrokeReplay/StrokeReplayHashes.txt in this plugin, and
+// those for a recording to a _Hashes.txt file next to it. A missing hash is reported as a warning with the computed
+// value, run once with modeling.Sculpting.Replay.UpdateHashes=1 to write it. Only a mismatch fails the test.
+// Intended to run headless, eg
+//   UnrealEditor-Cmd <Project> -nullrhi -unattended -ExecCmds="Automation RunTests MeshModeling.Sculpting.StrokeReplay; Quit"
+//
+
+#include "Misc/AutomationTest.h"
+#include "Misc/ScopeExit.h"
+#include "InteractiveToolsContext.h"
+#include "InteractiveToolManager.h"
+#include "ToolTargets/DynamicMeshComponentToolTarget.h"
+#include "DynamicMeshActor.h"
+#include "Components/DynamicMeshComponent.h"
+#include "Generators/SphereGenerator.h"
+#include "Materials/Material.h"
+#include "Engine/World.h"
+#include "MeshVertexSculptTool.h"
+#include "DynamicMeshSculptTool.h"
+
+// Test helpers
+namespace SculptStrokeReplayTestsLocals
+{
+	using namespace UE::SculptUtil;
+
+	TAutoConsoleVariable<FString> CVarStrokeReplayRecording(
+		TEXT("modeling.Sculpting.Replay.Recording"),
+		TEXT(""),
+		TEXT("Stroke recording replayed by the MeshModeling.Sculpting.StrokeReplay test. If empty, a generated set of strokes is used."));
+
+	TAutoConsoleVariable<bool> CVarStrokeReplayUpdateHashes(
+		TEXT("modeling.Sculpting.Replay.UpdateHashes"),
+		false,
+		TEXT("Store the final mesh hashes of the MeshModeling.Sculpting.StrokeReplay test as the new expected values, instead of comparing with them."));
+
+	/** @return the file with the expected final mesh hashes for the recording at RecordingPath, or for the generated strokes if it is empty */
+	FString GetExpectedHashesPath(const FString& RecordingPath)
+	{
+		if (RecordingPath.Len() > 0)
+		{
+			return FPaths::GetPath(RecordingPath) / (FPaths::GetBaseFilename(RecordingPath) + TEXT("_Hashes.txt"));
+		}
+		return FPaths::ProjectPluginsDir() / TEXT("MeshModelingToolsetExp") / TEXT("Resources") / TEXT("SculptStrokeReplay") / TEXT("StrokeReplayHashes.txt");
+	}
+
+	// ticks run after each stroke, so that work the tool finishes on the next frames is included
+	constexpr int32 NumIdleTicksPerStroke = 2;
+	constexpr float ReplayDeltaTime = 1.0f / 60.0f;
+
+	// IDs that UMeshSurfacePointTool uses for its shift and ctrl modifier toggles
+	constexpr int32 ShiftModifierID = 1;
+	constexpr int32 CtrlModifierID = 2;
+
+
+	/** Minimal context for running a tool without an editor viewport. Nothing is selected, snapped, or transacted. */
+	class FReplayToolsContextQueries : public IToolsContextQueriesAPI
+	{
+	public:
+		UWorld* World = nullptr;
+		FViewCameraState CameraState;
+
+		virtual UWorld* GetCurrentEditingWorld() const override { return World; }
+		virtual void GetCurrentSelectionState(FToolBuilderState& StateOut) const override { StateOut.World = World; }
+		virtual void GetCurrentViewState(FViewCameraState& StateOut) const override { StateOut = CameraState; }
+		virtual EToolContextCoordinateSystem GetCurrentCoordinateSystem() const override { return EToolContextCoordinateSystem::World; }
+		virtual FToolContextSnappingConfiguration GetCurrentSnappingSettings() const override { return FToolContextSnappingConfiguration(); }
+		virtual bool ExecuteSceneSnapQuery(const FSceneSnapQueryRequest& Request, TArray<FSceneSnapQueryResult>& Results) const override { return false; }
+		virtual UMaterialInterface* GetStandardMaterial(EStandardToolContextMaterials MaterialType) const override { return UMaterial::GetDefaultMaterial(MD_Surface); }
+		virtual FViewport* GetHitProxyViewport() const override { return nullptr; }
+		virtual FViewport* GetFocusedViewport() const override { return nullptr; }
+	};
+
+	class FReplayToolsContextTransactions : public IToolsContextTransactionsAPI
+	{
+	public:
+		virtual void DisplayMessage(const FText& Message, EToolMessageLevel Level) override {}
+		virtual void PostInvalidation() override {}
+		virtual void BeginUndoTransaction(const FText& Description) override {}
+		virtual void EndUndoTransaction() override {}
+		virtual void AppendChange(UObject* TargetObject, TUniquePtr<FToolCommandChange> Change, const FText& Description) override {}
+		virtual bool RequestSelectionChange(const FSelectedObjectsChangeList& SelectionChange) override { return false; }
+	};
+
+
+	UE::Geometry::FDynamicMesh3 MakeSphereMesh(int32 TargetTriangleCount)
+	{
+		UE::Geometry::FSphereGenerator SphereGenerator;
+		SphereGenerator.Radius = 100.0;
+		// a UV sphere has about 2*NumPhi*NumTheta triangles
+		SphereGenerator.NumPhi = FMath::Max(8, (int32)FMath::Sqrt(TargetTriangleCount / 4.0));
+		SphereGenerator.NumTheta = 2 * SphereGenerator.NumPhi;
+		SphereGenerator.Generate();
+		return UE::Geometry::FDynamicMesh3(&SphereGenerator);
+	}
+
+	/**
+	 * Three strokes across the front of the target, seen from -Y: a plain stroke, an inverted (ctrl) stroke and a
+	 * smoothing (shift) stroke. Each is sampled once per tick, like mouse input at 60fps.
+	 */
+	void MakeDefaultRecording(const FString& ToolClass, FSculptStrokeRecording& RecordingOut)
+	{
+		constexpr int32 NumSamples = 120;
+		const FVector3d CameraPos(0, -2.0, 0);
+
+		RecordingOut.ToolClass = ToolClass;
+		for (int32 StrokeIndex = 0; StrokeIndex < 3; ++StrokeIndex)
+		{
+			FSculptStroke& Stroke = RecordingOut.Strokes.AddDefaulted_GetRef();
+			Stroke.bCtrlToggle = (StrokeIndex == 1);
+			Stroke.bShiftToggle = (StrokeIndex == 2);
+			Stroke.CameraState.Position = (FVector)CameraPos;
+			Stroke.CameraState.Orientation = FRotator(0, 90, 0).Quaternion();
+			Stroke.CameraState.HorizontalFOVDegrees = 90.0f;
+			Stroke.CameraState.AspectRatio = 1.0f;
+
+			const double Z0 = 0.15 * (StrokeIndex - 1);
+			for (int32 k = 0; k <= NumSamples; ++k)
+			{
+				double t = (double)k / (double)NumSamples;
+				FVector3d Target(FMathd::Lerp(-0.3, 0.3, t), 0, Z0 + 0.05 * FMathd::Sin(t * FMathd::TwoPi * 2.0));
+
+				FSculptStrokeEvent Event;
+				Event.Type = (k == 0) ? ESculptStrokeEventType::BeginDrag : ESculptStrokeEventType::UpdateDrag;
+				Event.Time = k * ReplayDeltaTime;
+				Event.RayOrigin = CameraPos;
+				Event.RayDirection = UE::Geometry::Normalized(Target - CameraPos);
+				Stroke.Events.Add(Event);
+
+				FSculptStrokeEvent TickEvent;
+				TickEvent.Type = ESculptStrokeEventType::Tick;
+				TickEvent.Time = Event.Time;
+				TickEvent.DeltaTime = ReplayDeltaTime;
+				Stroke.Events.Add(TickEvent);
+			}
+
+			FSculptStrokeEvent EndEvent = Stroke.Events[Stroke.Events.Num() - 2];
+			EndEvent.Type = ESculptStrokeEventType::EndDrag;
+			Stroke.Events.Add(EndEvent);
+		}
+	}
+
+	FViewCameraState ToWorldCameraState(const FViewCameraState& NormalizedCamera, const FTransformSRT3d& TargetTransform, const FAxisAlignedBox3d& LocalBounds)
+	{
+		FViewCameraState Camera = NormalizedCamera;
+		Camera.Position = (FVector)FSculptStrokeRecording::ToWorldPosition((FVector3d)NormalizedCamera.Position, TargetTransform, LocalBounds);
+		Camera.Orientation = (FQuat)TargetTransform.GetRotation() * NormalizedCamera.Orientation;
+		Camera.OrthoWorldCoordinateWidth = (float)(NormalizedCamera.OrthoWorldCoordinateWidth * LocalBounds.MaxDim());
+		return Camera;
+	}
+
+	/**
+	 * Compare Hash with the expected hash for Label in HashesPath. A missing hash is a warning, a different one fails the
+	 * test. If modeling.Sculpting.Replay.UpdateHashes is set, Hash is stored as the expected value instead.
+	 */
+	bool CheckMeshHash(FAutomationTestBase& Test, const FString& HashesPath, const FString& Label, uint64 Hash)
+	{
+		TArray<FString> Lines;
+		FFileHelper::LoadFileToStringArray(Lines, *HashesPath);
+
+		const FString HashString = FString::Printf(TEXT("%016llx"), Hash);
+		const FString Prefix = Label + TEXT(" ");
+		int32 LineIndex = Lines.IndexOfByPredicate([&Prefix](const FString& Line) { return Line.StartsWith(Prefix); });
+
+		if (CVarStrokeReplayUpdateHashes.GetValueOnGameThread())
+		{
+			if (LineIndex == INDEX_NONE)
+			{
+				Lines.Add(Prefix + HashString);
+			}
+			else
+			{
+				Lines[LineIndex] = Prefix + HashString;
+			}
+			if (FFileHelper::SaveStringArrayToFile(Lines, *HashesPath) == false)
+			{
+				Test.AddError(FString::Printf(TEXT("%s: could not write final mesh hash to %s"), *Label, *HashesPath));
+				return false;
+			}
+			Test.AddInfo(FString::Printf(TEXT("%s: stored final mesh hash %s in %s"), *Label, *HashString, *HashesPath));
+			return true;
+		}
+
+		if (LineIndex == INDEX_NONE)
+		{
+			Test.AddWarning(FString::Printf(TEXT("%s: no expected final mesh hash in %s, the hash of this run is %s. Rerun with modeling.Sculpting.Replay.UpdateHashes=1 to store it"),
+				*Label, *HashesPath, *HashString));
+			return true;
+		}
+
+		const FString Expected = Lines[LineIndex].RightChop(Prefix.Len()).TrimStartAndEnd();
+		if (Expected != HashString)
+		{
+			Test.AddError(FString::Printf(TEXT("%s: final mesh hash %s differs from %s expected in %s. If the change in behavior is expected, rerun with modeling.Sculpting.Replay.UpdateHashes=1"),
+				*Label, *HashString, *Expected, *HashesPath));
+			return false;
+		}
+		return true;
+	}
+}
+
+
+// Replay strokes into a sculpt tool, time each stamp, and check the final mesh
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(UMeshSculptStrokeReplayTest,
+	"MeshModeling.Sculpting.StrokeReplay",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+void UMeshSculptStrokeReplayTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	const TCHAR* Tools[] = { TEXT("VertexSculpt"), TEXT("DynamicSculpt") };
+	const int32 TriangleCounts[] = { 100000, 1000000, 5000000 };
+	for (const TCHAR* Tool : Tools)
+	{
+		for (int32 TriangleCount : TriangleCounts)
+		{
+			OutBeautifiedNames.Add(FString::Printf(TEXT("%s %dk"), Tool, TriangleCount / 1000));
+			OutTestCommands.Add(FString::Printf(TEXT("%s %d"), Tool, TriangleCount));
+		}
+	}
+}
+
+bool UMeshSculptStrokeReplayTest::RunTest(const FString& Parameters)
+{
+	using namespace SculptStrokeReplayTestsLocals;
+
+	TArray<FString> Args;
+	Parameters.ParseIntoArrayWS(Args);
+	UTEST_TRUE("Test parameters are tool and triangle count", Args.Num() == 2);
+	const bool bDynamicSculpt = (Args[0] == TEXT("DynamicSculpt"));
+	const int32 TargetTriangleCount = FCString::Atoi(*Args[1]);
+	const FString ToolClass = bDynamicSculpt ? UDynamicMeshSculptTool::StaticClass()->GetName() : UMeshVertexSculptTool::StaticClass()->GetName();
+
+	// ---- Setup
+	FSculptStrokeRecording Recording;
+	FString RecordingName = TEXT("Default");
+	const FString RecordingPath = CVarStrokeReplayRecording.GetValueOnGameThread();
+	if (RecordingPath.Len() > 0)
+	{
+		UTEST_TRUE("Stroke recording loaded", Recording.LoadFromFile(RecordingPath));
+		if (Recording.ToolClass != ToolClass)
+		{
+			AddInfo(FString::Printf(TEXT("Skipped, the stroke recording is for %s"), *Recording.ToolClass));
+			return true;
+		}
+		RecordingName = FPaths::GetBaseFilename(RecordingPath);
+	}
+	else
+	{
+		MakeDefaultRecording(ToolClass, Recording);
+	}
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Editor, false, TEXT("SculptStrokeReplay"));
+	FReplayToolsContextQueries QueriesAPI;
+	QueriesAPI.World = World;
+	FReplayToolsContextTransactions TransactionsAPI;
+	UInteractiveToolsContext* ToolsContext = NewObject<UInteractiveToolsContext>();
+	ToolsContext->Initialize(&QueriesAPI, &TransactionsAPI);
+
+	ADynamicMeshActor* MeshActor = World->SpawnActor<ADynamicMeshActor>();
+	// also runs when a UTEST_ check returns early, the world is rooted and would otherwise leak
+	ON_SCOPE_EXIT
+	{
+		ToolsContext->Shutdown();
+		MeshActor->Destroy();
+		World->DestroyWorld(false);
+		World->RemoveFromRoot();
+	};
+	UDynamicMeshComponent* MeshComponent = MeshActor->GetDynamicMeshComponent();
+	MeshComponent->SetMesh(MakeSphereMesh(TargetTriangleCount));
+	const int32 TriangleCount = MeshComponent->GetMesh()->TriangleCount();
+	const FTransformSRT3d TargetTransform(MeshActor->GetActorTransform());
+	const FAxisAlignedBox3d LocalBounds = MeshComponent->GetMesh()->GetBounds(true);
+
+	UToolTarget* Target = NewObject<UDynamicMeshComponentToolTargetFactory>()->BuildTarget(MeshComponent, FToolTargetTypeRequirements());
+	UTEST_NOT_NULL("Tool target created", Target);
+
+	UMeshSurfacePointTool* Tool = nullptr;
+	FSculptStrokeRecorder* Recorder = nullptr;
+	if (bDynamicSculpt)
+	{
+		UDynamicMeshSculptTool* SculptTool = NewObject<UDynamicMeshSculptTool>(ToolsContext->ToolManager);
+		SculptTool->SetEnableRemeshing(true);
+		SculptTool->SetWorld(World);
+		Recorder = &SculptTool->GetStrokeRecorder();
+		Tool = SculptTool;
+	}
+	else
+	{
+		UMeshVertexSculptTool* SculptTool = NewObject<UMeshVertexSculptTool>(ToolsContext->ToolManager);
+		SculptTool->SetWorld(World);
+		Recorder = &SculptTool->GetStrokeRecorder();
+		Tool = SculptTool;
+	}
+	Tool->SetTarget(Target);
+	// before Setup, so the replay itself is not recorded
+	Recorder->BeginReplay();
+	Tool->Setup();
+
+	// ---- Act
+	FSculptStampTimings Timings;
+	FSculptStampTimings::SetActive(&Timings);
+	const double StartTime = FPlatformTime::Seconds();
+	for (const FSculptStroke& Stroke : Recording.Strokes)
+	{
+		FSculptStrokeRecording::ApplyProperties(Stroke.Properties, Tool);
+		Tool->OnUpdateModifierState(ShiftModifierID, Stroke.bShiftToggle);
+		Tool->OnUpdateModifierState(CtrlModifierID, Stroke.bCtrlToggle);
+		const FViewCameraState CameraState = ToWorldCameraState(Stroke.CameraState, TargetTransform, LocalBounds);
+		QueriesAPI.CameraState = CameraState;
+		Recorder->SetReplayInput(1.0f, CameraState);
+
+		for (const FSculptStrokeEvent& Event : Stroke.Events)
+		{
+			const FRay WorldRay(
+				(FVector)FSculptStrokeRecording::ToWorldPosition(Event.RayOrigin, TargetTransform, LocalBounds),
+				(FVector)FSculptStrokeRecording::ToWorldDirection(Event.RayDirection, TargetTransform), true);
+			switch (Event.Type)
+			{
+				case ESculptStrokeEventType::BeginDrag:
+					Tool->OnBeginDrag(WorldRay);
+					break;
+				case ESculptStrokeEventType::UpdateDrag:
+					Tool->OnUpdateDrag(WorldRay);
+					break;
+				case ESculptStrokeEventType::EndDrag:
+					Tool->OnEndDrag(WorldRay);
+					break;
+				case ESculptStrokeEventType::Tick:
+					Recorder->SetReplayInput(Event.Pressure, CameraState);
+					Tool->Tick(Event.DeltaTime);
+					break;
+			}
+		}
+
+		for (int32 k = 0; k < NumIdleTicksPerStroke; ++k)
+		{
+			Tool->Tick(ReplayDeltaTime);
+		}
+	}
+	const double ReplaySeconds = FPlatformTime::Seconds() - StartTime;
+
+	Tool->Shutdown(EToolShutdownType::Accept);
+	Recorder->EndReplay();
+	Timings.EndStamp();
+	FSculptStampTimings::SetActive(nullptr);
+
+	// ---- Verify
+	const FString Label = FString::Printf(TEXT("%s_%d_%s"), *Args[0], TargetTriangleCount, *RecordingName);
+	const uint64 MeshHash = ComputeSculptMeshHash(*MeshComponent->GetMesh());
+
+	FString CSV = FSculptStampTimings::GetCSVHeader();
+	Timings.AppendCSV(Label, CSV);
+	const FString CSVPath = FPaths::ProjectSavedDir() / TEXT("Sculpting") / FString::Printf(TEXT("StrokeReplay_%s.csv"), *Label);
+	FFileHelper::SaveStringToFile(CSV, *CSVPath);
+
+	const int32 NumStamps = FMath::Max(Timings.GetNumStamps(), 1);
+	AddInfo(FString::Printf(TEXT("%s: %d triangles, %d stamps in %.2fs. Average per stamp: UpdateROI %.3fms, ApplyStamp %.3fms, Remesh %.3fms, OctreeReinsert %.3fms, Normals %.3fms, RenderUpdate %.3fms. Timings written to %s"),
+		*Label, TriangleCount, Timings.GetNumStamps(), ReplaySeconds,
+		Timings.GetTotalMs(ESculptStampStage::UpdateROI) / NumStamps, Timings.GetTotalMs(ESculptStampStage::ApplyStamp) / NumStamps,
+		Timings.GetTotalMs(ESculptStampStage::Remesh) / NumStamps, Timings.GetTotalMs(ESculptStampStage::OctreeReinsert) / NumStamps,
+		Timings.GetTotalMs(ESculptStampStage::Normals) / NumStamps, Timings.GetTotalMs(ESculptStampStage::RenderUpdate) / NumStamps, *CSVPath));
+
+	UTEST_TRUE("Strokes applied stamps", Timings.GetNumStamps() > 0);
+	return CheckMeshHash(*this, GetExpectedHashesPath(RecordingPath), Label, MeshHash);
+}
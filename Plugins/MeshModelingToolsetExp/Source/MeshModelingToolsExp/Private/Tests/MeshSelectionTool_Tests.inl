@@ -0,0 +1,287 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+//
+// This file is included in MeshSelectionTool.cpp
+//
+// Checks the selection topology queries of UE::MeshSelectionUtil against the serial implementations they replaced in
+// UMeshSelectionTool, and times both on large grid meshes. Intended to run headless, eg
+//   UnrealEditor-Cmd <Project> -nullrhi -unattended -ExecCmds="Automation RunTests MeshModeling.MeshSelection; Quit"
+//
+
+#include "Misc/AutomationTest.h"
+#include "Algo/AllOf.h"
+
+// Test helpers
+namespace MeshSelectionToolTestsLocals
+{
+	using namespace UE::Geometry;
+	using namespace UE::MeshSelectionUtil;
+
+	/** NumParts disconnected grids of 2*GridSize*GridSize triangles in the XY plane, with a polygroup per row of quads */
+	TUniquePtr<FDynamicMesh3> CreateGridMesh(int32 GridSize, int32 NumParts)
+	{
+		TUniquePtr<FDynamicMesh3> Mesh = MakeUnique<FDynamicMesh3>();
+		Mesh->EnableTriangleGroups();
+		for (int32 Part = 0; Part < NumParts; ++Part)
+		{
+			const int32 BaseVertexID = Mesh->MaxVertexID();
+			for (int32 y = 0; y <= GridSize; ++y)
+			{
+				for (int32 x = 0; x <= GridSize; ++x)
+				{
+					Mesh->AppendVertex(FVector3d(x + Part * (GridSize + 2), y, 0));
+				}
+			}
+			for (int32 y = 0; y < GridSize; ++y)
+			{
+				const int32 GroupID = Part * GridSize + y + 1;
+				for (int32 x = 0; x < GridSize; ++x)
+				{
+					const int32 a = BaseVertexID + y * (GridSize + 1) + x;
+					const int32 c = a + GridSize + 1;
+					Mesh->AppendTriangle(FIndex3i(a, a + 1, c + 1), GroupID);
+					Mesh->AppendTriangle(FIndex3i(a, c + 1, c), GroupID);
+				}
+			}
+		}
+		return Mesh;
+	}
+
+	/** Add the triangles with a centroid inside the disc to the selection */
+	void SelectDisc(const FDynamicMesh3& Mesh, const FVector3d& Center, double Radius, TArray<int32>& SelectedOut, TBitArray<>& IsSelectedOut)
+	{
+		IsSelectedOut.SetNum(Mesh.MaxTriangleID(), false);
+		for (int32 TriangleID : Mesh.TriangleIndicesItr())
+		{
+			if (IsSelectedOut[TriangleID] == false && DistanceSquared(Mesh.GetTriCentroid(TriangleID), Center) < Radius * Radius)
+			{
+				IsSelectedOut[TriangleID] = true;
+				SelectedOut.Add(TriangleID);
+			}
+		}
+	}
+
+	bool IsSameTriangles(const TArray<int32>& Triangles, const TSet<int32>& Expected)
+	{
+		return Triangles.Num() == Expected.Num() && TSet<int32>(Triangles).Num() == Triangles.Num()
+			&& Algo::AllOf(Triangles, [&Expected](int32 TriangleID) { return Expected.Contains(TriangleID); });
+	}
+
+	// The implementations that UMeshSelectionTool used before UE::MeshSelectionUtil
+
+	void ReferenceGrowShrink(const FDynamicMesh3& Mesh, const TArray<int32>& Selected, const TBitArray<>& IsSelected, bool bGrow, TSet<int32>& ChangeFacesOut)
+	{
+		TArray<int32> Vertices;
+		UE::Geometry::TriangleToVertexIDs(&Mesh, Selected, Vertices);
+		for (int32 vid : Vertices)
+		{
+			int32 OutCount = 0;
+			for (int32 tid : Mesh.VtxTrianglesItr(vid))
+			{
+				OutCount += IsSelected[tid] ? 0 : 1;
+			}
+			if (OutCount == 0)
+			{
+				continue;
+			}
+			for (int32 tid : Mesh.VtxTrianglesItr(vid))
+			{
+				if (IsSelected[tid] != bGrow)
+				{
+					ChangeFacesOut.Add(tid);
+				}
+			}
+		}
+	}
+
+	void ReferenceExpandToConnected(const FDynamicMesh3& Mesh, const TArray<int32>& Selected, const TBitArray<>& IsSelected, TSet<int32>& AddFacesOut)
+	{
+		TArray<int32> Queue(Selected);
+		while (Queue.Num() > 0)
+		{
+			int32 CurTri = Queue.Pop(false);
+			FIndex3i NbrTris = Mesh.GetTriNeighbourTris(CurTri);
+			for (int32 j = 0; j < 3; ++j)
+			{
+				int32 tid = NbrTris[j];
+				if (tid != FDynamicMesh3::InvalidID && IsSelected[tid] == false && AddFacesOut.Contains(tid) == false)
+				{
+					AddFacesOut.Add(tid);
+					Queue.Add(tid);
+				}
+			}
+		}
+	}
+
+	void ReferenceLargestComponent(const FDynamicMesh3& Mesh, const TArray<int32>& Selected, TSet<int32>& ComponentOut)
+	{
+		FMeshConnectedComponents Components(&Mesh);
+		Components.FindConnectedTriangles(Selected);
+		int32 LargestIndex = 0;
+		for (int32 k = 1; k < Components.Num(); ++k)
+		{
+			if (Components.GetComponent(k).Indices.Num() > Components.GetComponent(LargestIndex).Indices.Num())
+			{
+				LargestIndex = k;
+			}
+		}
+		ComponentOut.Append(Components.GetComponent(LargestIndex).Indices);
+	}
+}
+
+
+// Check the selection topology queries against the reference implementations
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(UMeshSelectionTopologyTest,
+	"MeshModeling.MeshSelection.Selection Topology",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+	bool UMeshSelectionTopologyTest::RunTest(const FString& Parameters)
+{
+	using namespace MeshSelectionToolTestsLocals;
+
+	// ---- Setup
+	constexpr int32 GridSize = 32;
+	TUniquePtr<FDynamicMesh3> Mesh = CreateGridMesh(GridSize, 2);
+	UTEST_TRUE("Grid mesh has the expected triangle count", Mesh->TriangleCount() == 2 * 2 * GridSize * GridSize);
+
+	// two separate discs of different size in the first grid
+	TArray<int32> Selected;
+	TBitArray<> IsSelected;
+	SelectDisc(*Mesh, FVector3d(8, 8, 0), 5.0, Selected, IsSelected);
+	SelectDisc(*Mesh, FVector3d(24, 24, 0), 3.0, Selected, IsSelected);
+
+	// ---- Act and Verify
+	TArray<int32> GrowTriangles;
+	FindGrowTriangles(*Mesh, Selected, IsSelected, GrowTriangles);
+	TSet<int32> ExpectedGrow;
+	ReferenceGrowShrink(*Mesh, Selected, IsSelected, true, ExpectedGrow);
+	UTEST_TRUE("Grow adds triangles", GrowTriangles.Num() > 0);
+	UTEST_TRUE("Grow matches the reference", IsSameTriangles(GrowTriangles, ExpectedGrow));
+
+	TArray<int32> ShrinkTriangles;
+	FindShrinkTriangles(*Mesh, Selected, IsSelected, ShrinkTriangles);
+	TSet<int32> ExpectedShrink;
+	ReferenceGrowShrink(*Mesh, Selected, IsSelected, false, ExpectedShrink);
+	UTEST_TRUE("Shrink removes triangles", ShrinkTriangles.Num() > 0);
+	UTEST_TRUE("Shrink matches the reference", IsSameTriangles(ShrinkTriangles, ExpectedShrink));
+
+	TArray<int32> ConnectedTriangles;
+	FindConnectedTriangles(*Mesh, Selected, IsSelected, ConnectedTriangles);
+	TSet<int32> ExpectedConnected;
+	ReferenceExpandToConnected(*Mesh, Selected, IsSelected, ExpectedConnected);
+	UTEST_TRUE("Expand fills the first grid only", ConnectedTriangles.Num() + Selected.Num() == Mesh->TriangleCount() / 2);
+	UTEST_TRUE("Expand matches the reference", IsSameTriangles(ConnectedTriangles, ExpectedConnected));
+
+	TArray<int32> LargestComponent;
+	FindLargestSelectedComponent(*Mesh, Selected, IsSelected, false, LargestComponent);
+	TSet<int32> ExpectedLargest;
+	ReferenceLargestComponent(*Mesh, Selected, ExpectedLargest);
+	UTEST_TRUE("Largest component is a strict subset of the selection", LargestComponent.Num() > 0 && LargestComponent.Num() < Selected.Num());
+	UTEST_TRUE("Largest component matches the reference", IsSameTriangles(LargestComponent, ExpectedLargest));
+
+	TArray<int32> LargestAreaComponent;
+	FindLargestSelectedComponent(*Mesh, Selected, IsSelected, true, LargestAreaComponent);
+	UTEST_TRUE("Largest component by area is the same on a uniform grid", IsSameTriangles(LargestAreaComponent, ExpectedLargest));
+
+	FPolygroupSet Groups(Mesh.Get());
+	FGroupTriangles GroupTriangles;
+	GroupTriangles.Initialize(*Mesh, Groups);
+	int32 NumGroupTriangles = 0;
+	bool bAllInGroup = true;
+	for (int32 GroupID = 1; GroupID <= 2 * GridSize; ++GroupID)
+	{
+		for (int32 TriangleID : GroupTriangles.GetTriangles(GroupID))
+		{
+			bAllInGroup = bAllInGroup && Groups.GetTriangleGroup(TriangleID) == GroupID;
+			NumGroupTriangles++;
+		}
+	}
+	UTEST_TRUE("Group triangles are in their group", bAllInGroup);
+	UTEST_TRUE("Each triangle is in one group", NumGroupTriangles == Mesh->TriangleCount());
+	UTEST_TRUE("Unknown group has no triangles", GroupTriangles.GetTriangles(-1).Num() == 0);
+
+	return true;
+}
+
+
+// Time the selection topology queries and the reference implementations on large meshes
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(UMeshSelectionTopologyTimingsTest,
+	"MeshModeling.MeshSelection.Selection Topology Timings",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+void UMeshSelectionTopologyTimingsTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	const int32 TriangleCounts[] = { 1000000, 4000000 };
+	for (int32 TriangleCount : TriangleCounts)
+	{
+		OutBeautifiedNames.Add(FString::Printf(TEXT("%dk"), TriangleCount / 1000));
+		OutTestCommands.Add(FString::Printf(TEXT("%d"), TriangleCount));
+	}
+}
+
+bool UMeshSelectionTopologyTimingsTest::RunTest(const FString& Parameters)
+{
+	using namespace MeshSelectionToolTestsLocals;
+
+	// ---- Setup
+	const int32 GridSize = FMath::CeilToInt(FMath::Sqrt(FCString::Atoi(*Parameters) / 2.0));
+	TUniquePtr<FDynamicMesh3> Mesh = CreateGridMesh(GridSize, 1);
+
+	// a large disc with a small one beside it, so there are components to choose from
+	TArray<int32> Selected;
+	TBitArray<> IsSelected;
+	SelectDisc(*Mesh, FVector3d(0.4 * GridSize, 0.5 * GridSize, 0), 0.3 * GridSize, Selected, IsSelected);
+	SelectDisc(*Mesh, FVector3d(0.85 * GridSize, 0.5 * GridSize, 0), 0.1 * GridSize, Selected, IsSelected);
+
+	double StartTime;
+	auto MsSince = [](double Start) { return (FPlatformTime::Seconds() - Start) * 1000.0; };
+
+	// ---- Act and Verify
+	TArray<int32> GrowTriangles;
+	StartTime = FPlatformTime::Seconds();
+	FindGrowTriangles(*Mesh, Selected, IsSelected, GrowTriangles);
+	const double GrowMs = MsSince(StartTime);
+	TSet<int32> ExpectedGrow;
+	StartTime = FPlatformTime::Seconds();
+	ReferenceGrowShrink(*Mesh, Selected, IsSelected, true, ExpectedGrow);
+	const double ReferenceGrowMs = MsSince(StartTime);
+	UTEST_TRUE("Grow matches the reference", IsSameTriangles(GrowTriangles, ExpectedGrow));
+
+	TArray<int32> ShrinkTriangles;
+	StartTime = FPlatformTime::Seconds();
+	FindShrinkTriangles(*Mesh, Selected, IsSelected, ShrinkTriangles);
+	const double ShrinkMs = MsSince(StartTime);
+	TSet<int32> ExpectedShrink;
+	StartTime = FPlatformTime::Seconds();
+	ReferenceGrowShrink(*Mesh, Selected, IsSelected, false, ExpectedShrink);
+	const double ReferenceShrinkMs = MsSince(StartTime);
+	UTEST_TRUE("Shrink matches the reference", IsSameTriangles(ShrinkTriangles, ExpectedShrink));
+
+	TArray<int32> ConnectedTriangles;
+	StartTime = FPlatformTime::Seconds();
+	FindConnectedTriangles(*Mesh, Selected, IsSelected, ConnectedTriangles);
+	const double ExpandMs = MsSince(StartTime);
+	TSet<int32> ExpectedConnected;
+	StartTime = FPlatformTime::Seconds();
+	ReferenceExpandToConnected(*Mesh, Selected, IsSelected, ExpectedConnected);
+	const double ReferenceExpandMs = MsSince(StartTime);
+	UTEST_TRUE("Expand matches the reference", IsSameTriangles(ConnectedTriangles, ExpectedConnected));
+
+	TArray<int32> LargestComponent;
+	StartTime = FPlatformTime::Seconds();
+	FindLargestSelectedComponent(*Mesh, Selected, IsSelected, false, LargestComponent);
+	const double LargestMs = MsSince(StartTime);
+	TSet<int32> ExpectedLargest;
+	StartTime = FPlatformTime::Seconds();
+	ReferenceLargestComponent(*Mesh, Selected, ExpectedLargest);
+	const double ReferenceLargestMs = MsSince(StartTime);
+	UTEST_TRUE("Largest component matches the reference", IsSameTriangles(LargestComponent, ExpectedLargest));
+
+	AddInfo(FString::Printf(TEXT("%d triangles, %d selected. Grow %.2fms (reference %.2fms), Shrink %.2fms (reference %.2fms), Expand %.2fms (reference %.2fms), Largest Component %.2fms (reference %.2fms)"),
+		Mesh->TriangleCount(), Selected.Num(), GrowMs, ReferenceGrowMs, ShrinkMs, ReferenceShrinkMs, ExpandMs, ReferenceExpandMs, LargestMs, ReferenceLargestMs));
+
+	return true;
+}
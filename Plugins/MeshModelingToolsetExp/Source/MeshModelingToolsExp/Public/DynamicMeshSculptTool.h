@@ -19,6 +19,8 @@
 #include "Properties/RemeshProperties.h"
 #include "TransformTypes.h"
 #include "Sculpting/MeshSculptToolBase.h"
+#include "Sculpting/MeshSculptUtil.h"
+#include "Sculpting/MeshSculptStrokeRecorder.h"
 #include "Async/Async.h"
 #include "Util/UniqueIndexSet.h"
 #include "DynamicMeshSculptTool.generated.h"
@@ -294,6 +296,9 @@ public:
 	// IInteractiveToolCameraFocusAPI override to focus on brush w/ 'F' 
 	virtual FBox GetWorldSpaceFocusBox() override;
 
+	/** Records stroke input, and supplies replayed input, see FSculptStrokeRecorder */
+	UE::SculptUtil::FSculptStrokeRecorder& GetStrokeRecorder() { return StrokeRecorder; }
+
 public:
 	/** Properties that control brush size/etc*/
 	UPROPERTY()
@@ -338,6 +343,8 @@ private:
 	UWorld* TargetWorld;		// required to spawn UPreviewMesh/etc
 	FViewCameraState CameraState;
 
+	UE::SculptUtil::FSculptStrokeRecorder StrokeRecorder;
+
 	UPROPERTY()
 	TObjectPtr<UBrushStampIndicator> BrushIndicator;
 
@@ -411,18 +418,22 @@ private:
 	int32 LastBrushTriangleID = -1;
 
 	TArray<int> UpdateROITriBuffer;
-	UE::Geometry::FUniqueIndexSet VertexROIBuilder;
+	UE::SculptUtil::FAtomicIndexFlags VertexROIFlags;
 	TArray<int> VertexROI;
-	UE::Geometry::FUniqueIndexSet TriangleROIBuilder;
+	UE::SculptUtil::FAtomicIndexFlags TriangleROIFlags;
+	TArray<int> TriangleROIArray;		// same triangles as TriangleROI
 	TSet<int> TriangleROI;
+	TArray<uint32> OctreeUpdateTempBuffer;
+	TArray<bool> OctreeUpdateTempFlagBuffer;
 	//TSet<int> TriangleROI;
+	TArray<int> UpdateROIStampTriBuffer;
 	void UpdateROI(const FVector3d& BrushPos);
+	void UpdateROI(TArrayView<const FVector3d> BrushPositions);
 
 	bool bRemeshPending;
 	bool bNormalUpdatePending;
 	
 	bool bTargetDirty;
-	TFuture<void> PendingTargetUpdate;
 
 	bool bSmoothing;
 	bool bInvert;
@@ -435,13 +446,59 @@ private:
 	int StampTimestamp = 0;
 	EDynamicMeshSculptBrushType LastStampType = EDynamicMeshSculptBrushType::LastValue;
 	EDynamicMeshSculptBrushType PendingStampType = LastStampType;
-	void ApplyStamp(const FRay& WorldRay);
+	bool ApplyStamp(TArrayView<const FRay> WorldRays);
+
+	// Stroke input is resampled into PendingStrokeSampleRays so fast strokes place stamps along the whole path.
+	// Each tick applies a batch of consecutive stamps close to each other with a single ROI, remesh, octree and normals update.
+	TArray<FRay> PendingStrokeSampleRays;
+	FRay LastStrokeInputRay;
+	TArray<FRay> StampRayBatch;
+	TArray<FVector3d> StampBatchPositions;
+	void AddStrokeInputRay(const FRay& WorldRay);
+	void CollectStampBatch();
+	void ApplyStampBatch();
+
+	// octree reinsert and normals for the last stamp run in the background until the next tick (or the next octree query).
+	// Only one stamp is ever in flight, the next stamp needs the updated octree to find its ROI.
+	TFuture<void> PendingStampWork;
+	bool bStampRenderUpdatePending = false;
+	void LaunchStampWork(double GameThreadSeconds, bool bMeshShapeModified);
+	void WaitForStampWork();
+
+	// stamp pacing, based on a running estimate of the game thread cost of a stamp
+	double StampLaunchGameThreadSeconds = 0;
+	double StampCostEstimate = 0;
+	int32 StampTicksToSkip = 0;
+
+	// The brush target is double-buffered. Queries read the front target while the back target is brought up to date
+	// in the background, and the two are swapped on the game thread once the update is done, so queries never wait.
+	struct FBrushTarget
+	{
+		FDynamicMesh3 Mesh;
+		UE::Geometry::FDynamicMeshAABBTree3 Spatial;
+		UE::Geometry::FMeshNormals Normals;
+
+		// sculpt mesh vertices moved since this target was last updated. If topology changed, a full copy is needed instead
+		UE::SculptUtil::FDirtyIndexSet DirtyVertices;
+		UE::SculptUtil::FDirtyIndexSet NormalsROI;
+		bool bNeedsFullUpdate = true;
+		uint32 SculptTopologyStamp = 0;
+	};
+	FBrushTarget BrushTargets[2];
+	int32 FrontBrushTarget = 0;
+	const FBrushTarget& GetBrushTarget() const { return BrushTargets[FrontBrushTarget]; }
+
+	// copy from the sculpt mesh into the back target, has to finish before the sculpt mesh is modified
+	TFuture<void> PendingTargetCopy;
+	void WaitForTargetCopy();
+	// full back target update, including the copy
+	TFuture<void> PendingTargetUpdate;
+	void SwapTargetIfReady();
+	void NotifyTargetVerticesModified(const TArray<int>& Vertices);
 
-	FDynamicMesh3 BrushTargetMesh;
-	UE::Geometry::FDynamicMeshAABBTree3 BrushTargetMeshSpatial;
-	UE::Geometry::FMeshNormals BrushTargetNormals;
 	bool bCachedFreezeTarget = false;
-	void UpdateTarget();
+	/** @return false if the update could not be started because one is still in flight */
+	bool UpdateTarget();
 	bool GetTargetMeshNearest(const FVector3d& Position, double SearchRadius, FVector3d& TargetPosOut, FVector3d& TargetNormalOut);
 
 	int FindHitSculptMeshTriangle(const FRay3d& LocalRay);
@@ -488,11 +545,14 @@ private:
 	bool bHaveNormalSeams;
 	TSet<int32> RemeshRemovedTriangles;
 	TSet<int32> RemeshFinalTriangleROI;
+	TArray<int> RemeshVertexBuffer;
 	void PrecomputeRemeshInfo();
 	void RemeshROIPass();
 
 	FMeshVertexChangeBuilder* ActiveVertexChange = nullptr;
+	// with remeshing, ActiveMeshChange only saves triangles that are modified, and moved vertices are saved in ActiveMeshChangePositions
 	UE::Geometry::FDynamicMeshChangeTracker* ActiveMeshChange = nullptr;
+	UE::SculptUtil::FVertexPositionDeltaStore ActiveMeshChangePositions;
 	void BeginChange(bool bIsVertexChange);
 	void EndChange();
 	void SaveActiveROI();
@@ -9,7 +9,10 @@
 #include "SelectionSet.h"
 #include "Changes/MeshSelectionChange.h"
 #include "DynamicMesh/DynamicMeshOctree3.h"
+#include "DynamicMesh/DynamicVerticesOctree3.h"
+#include "DynamicMesh/DynamicMeshAABBTree3.h"
 #include "Polygroups/PolygroupSet.h"
+#include "MeshSelectionUtil.h"
 #include "MeshSelectionTool.generated.h"
 
 class UMeshStatisticsProperties;
@@ -373,11 +376,30 @@ protected:
 
 	UWorld* TargetWorld;
 
-	// note: ideally this octree would be part of PreviewMesh!
+	// note: ideally these octrees would be part of PreviewMesh!
 	TUniquePtr<UE::Geometry::FDynamicMeshOctree3> Octree;
 	bool bOctreeValid = false;
 	TUniquePtr<UE::Geometry::FDynamicMeshOctree3>& GetOctree();
 
+	TUniquePtr<UE::Geometry::TDynamicVerticesOctree3<FDynamicMesh3>> VerticesOctree;
+	bool bVerticesOctreeValid = false;
+	TUniquePtr<UE::Geometry::TDynamicVerticesOctree3<FDynamicMesh3>>& GetVerticesOctree();
+
+	// set while the tool edits the mesh and updates the octrees itself, so that OnMeshChanged does not invalidate them
+	bool bInIncrementalSpatialEdit = false;
+	/** Update the octrees for Triangles and Vertices that were added, removed or moved by an edit, if the octrees have been built */
+	void UpdateSpatialForEdit(const TArray<int32>& Triangles, const TArray<int32>& Vertices);
+
+	// occlusion rays for the Visible selection mode. The tree is rebuilt only when the mesh changes, and as visibility
+	// of a triangle only depends on the eye position, results are cached until the camera or target moves.
+	UE::Geometry::FDynamicMeshAABBTree3 VisibilitySpatial;
+	bool bVisibilitySpatialValid = false;
+	bool bVisibilityCacheValid = false;
+	FVector3d VisibilityCacheEyePosition = FVector3d::Zero();
+	TBitArray<> VisibilityTested;
+	TBitArray<> VisibilityResult;
+	void ComputeVisibleTriangles(const FVector3d& LocalEyePosition, const TArray<int>& Triangles, TArray<int>& VisibleTrianglesOut);
+
 	EMeshSelectionElementType SelectionType = EMeshSelectionElementType::Face;
 
 	bool bInRemoveStroke = false;
@@ -397,10 +419,14 @@ protected:
 	TArray<int> PreviewBrushROI;
 	TBitArray<> SelectedVertices;
 	TBitArray<> SelectedTriangles;
+	// position of each selected triangle in Selection->Faces, so that triangles can be deselected in O(1)
+	TArray<int32> SelectedFaceIndices;
+	TArray<int32> ModifiedTrianglesBuffer;
+	void AddSelectedTriangle(int32 TriangleID);
+	void RemoveSelectedTriangle(int32 TriangleID);
 	void OnExternalSelectionChange();
 
 	void OnRegionHighlightUpdated(const TArray<int32>& Triangles);
-	void OnRegionHighlightUpdated(const TSet<int32>& Triangles);
 	void OnRegionHighlightUpdated();
 	void UpdateVisualization(bool bSelectionModified);
 	bool bFullMeshInvalidationPending = false;
@@ -440,6 +466,9 @@ protected:
 	void SmoothSelectionBoundary();
 
 	TSharedPtr<UE::Geometry::FPolygroupSet, ESPMode::ThreadSafe> ActiveGroupSet;
+	UE::MeshSelectionUtil::FGroupTriangles GroupTriangles;
+	bool bGroupTrianglesValid = false;
+	const UE::MeshSelectionUtil::FGroupTriangles& GetGroupTriangles();
 	void OnSelectedGroupLayerChanged();
 	void UpdateActiveGroupLayer();
 
@@ -0,0 +1,56 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DynamicMesh/DynamicMesh3.h"
+
+namespace UE { namespace Geometry { class FPolygroupSet; } }
+
+
+namespace UE
+{
+namespace MeshSelectionUtil
+{
+	using namespace UE::Geometry;
+
+	/**
+	 * The triangles of each polygroup, in CSR form, so that the triangles of a group can be found without scanning the mesh.
+	 */
+	class MESHMODELINGTOOLSEXP_API FGroupTriangles
+	{
+	public:
+		void Initialize(const FDynamicMesh3& Mesh, const FPolygroupSet& Groups);
+
+		TArrayView<const int32> GetTriangles(int32 GroupID) const;
+
+	protected:
+		TMap<int32, int32> GroupToIndex;
+		// the triangles of the group with index I are Triangles[Offsets[I] .. Offsets[I+1]-1]
+		TArray<int32> Offsets;
+		TArray<int32> Triangles;
+	};
+
+
+	/*
+	 * Topology queries on a triangle selection, which is passed both as the list of selected triangles and as a bit per
+	 * triangle ID. The selection is expanded one level at a time (a level-synchronous breadth first search) and each level
+	 * is processed in parallel, so the cost scales with the selection and its neighbourhood rather than with the mesh.
+	 * Where parallel tasks race to add a shared triangle, each level of results is sorted by triangle ID, so the output
+	 * does not depend on scheduling.
+	 */
+
+	/** Find the unselected triangles that share a vertex with a selected triangle */
+	MESHMODELINGTOOLSEXP_API void FindGrowTriangles(const FDynamicMesh3& Mesh, const TArray<int32>& SelectedTriangles, const TBitArray<>& IsSelected, TArray<int32>& TrianglesOut);
+
+	/** Find the selected triangles that share a vertex with an unselected triangle */
+	MESHMODELINGTOOLSEXP_API void FindShrinkTriangles(const FDynamicMesh3& Mesh, const TArray<int32>& SelectedTriangles, const TBitArray<>& IsSelected, TArray<int32>& TrianglesOut);
+
+	/** Find the unselected triangles that are connected to the selection by edges */
+	MESHMODELINGTOOLSEXP_API void FindConnectedTriangles(const FDynamicMesh3& Mesh, const TArray<int32>& SelectedTriangles, const TBitArray<>& IsSelected, TArray<int32>& TrianglesOut);
+
+	/** Find the edge-connected component of the selection with the most triangles, or the largest area if bWeightByArea */
+	MESHMODELINGTOOLSEXP_API void FindLargestSelectedComponent(const FDynamicMesh3& Mesh, const TArray<int32>& SelectedTriangles, const TBitArray<>& IsSelected, bool bWeightByArea, TArray<int32>& ComponentOut);
+
+}
+}
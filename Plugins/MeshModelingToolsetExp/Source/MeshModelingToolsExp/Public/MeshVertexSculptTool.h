@@ -14,6 +14,7 @@
 #include "TransformTypes.h"
 #include "Sculpting/MeshSculptToolBase.h"
 #include "Sculpting/MeshBrushOpBase.h"
+#include "Sculpting/MeshSculptUtil.h"
 #include "Image/ImageBuilder.h"
 #include "Util/UniqueIndexSet.h"
 #include "Polygroups/PolygroupSet.h"
@@ -168,6 +169,10 @@ public:
 	/** Bounds of random generation (positive and negative) for randomized stamps */
 	UPROPERTY(EditAnywhere, Category = Alpha, AdvancedDisplay, meta = (UIMin = "0.0", UIMax = "180.0"))
 	float RandomRange = 180.0;
+
+	/** Number of times the alpha repeats across the brush stamp. At 1 the alpha covers the stamp exactly once */
+	UPROPERTY(EditAnywhere, Category = Alpha, AdvancedDisplay, meta = (UIMin = "1.0", UIMax = "8.0", ClampMin = "1.0", ClampMax = "100.0"))
+	float Tiling = 1.0;
 };
 
 
@@ -252,6 +257,8 @@ protected:
 
 	virtual void OnBeginStroke(const FRay& WorldRay) override;
 	virtual void OnEndStroke() override;
+	virtual bool WantsStrokeResampling() const override { return true; }
+	virtual void FlushStrokeStamps() override;
 	// end UMeshSculptToolBase API
 
 protected:
@@ -273,7 +280,8 @@ protected:
 
 	int32 InitialStrokeTriangleID = -1;
 
-	TSet<int32> AccumulatedTriangleROI;
+	UE::SculptUtil::FDirtyIndexSet AccumulatedTriangleROI;
+	TArray<int32> AccumulatedTriangleROIArray;		// filled from AccumulatedTriangleROI when a list is needed
 	bool bUndoUpdatePending = false;
 	TFuture<bool> UndoNormalsFuture;
 	TFuture<bool> UndoUpdateOctreeFuture;
@@ -288,17 +296,25 @@ protected:
 	void WaitForPendingStampUpdate();
 
 	TArray<int> RangeQueryTriBuffer;
+	TArray<int> RangeQueryStampTriBuffer;
 	UE::Geometry::FUniqueIndexSet VertexROIBuilder;
 	UE::Geometry::FUniqueIndexSet TriangleROIBuilder;
 	TArray<UE::Geometry::FIndex3i> TriangleROIInBuf;
 	TArray<int> VertexROI;
 	TArray<int> TriangleROIArray;
 	void UpdateROI(const FVector3d& BrushPos);
+	void UpdateROI(TArrayView<const FVector3d> BrushPositions);
+
+	// stamps applied together in the current tick, see CollectStampBatch()
+	TArray<FSculptBrushStamp> StampBatch;
+	TArray<FVector3d> StampBatchPositions;
+	bool bHaveDeferredStamp = false;
+	FSculptBrushStamp DeferredStamp;
+	bool CollectStampBatch();
+	bool UpdateStroke();
 
-	UE::Geometry::FUniqueIndexSet NormalsROIBuilder;
-	TArray<std::atomic<bool>> NormalsFlags;		// set of per-vertex or per-element-id flags that indicate
-												// whether normal needs recompute. Fast to do it this way
-												// than to use a TSet or UniqueIndexSet...
+	UE::SculptUtil::FNormalsROICache NormalsROICache;
+	TArray<int32> NormalsROIIndices;		// overlay element IDs or vertex IDs, depending on NormalsROICache
 
 	bool bTargetDirty;
 
@@ -313,7 +329,7 @@ protected:
 	UE::Geometry::FDynamicMeshOctree3 BaseMeshSpatial;
 	TArray<int32> BaseMeshIndexBuffer;
 	bool bCachedFreezeTarget = false;
-	void UpdateBaseMesh(const TSet<int32>* TriangleROI = nullptr);
+	void UpdateBaseMesh(const TArray<int32>* TriangleROI = nullptr);
 	bool GetBaseMeshNearest(int32 VertexID, const FVector3d& Position, double SearchRadius, FVector3d& TargetPosOut, FVector3d& TargetNormalOut);
 	TFunction<bool(int32, const FVector3d&, double MaxDist, FVector3d&, FVector3d&)> BaseMeshQueryFunc;
 
@@ -324,9 +340,15 @@ protected:
 	double SculptMaxFixedHeight = -1.0;
 
 	bool bHaveBrushAlpha = false;
-	UE::Geometry::TImageBuilder<FVector4f> BrushAlphaValues;
-	UE::Geometry::FImageDimensions BrushAlphaDimensions;
+	UE::SculptUtil::FBrushAlphaMips BrushAlphaMips;
+	// alpha LOD and UV scale for the current stamp, set by UpdateStampAlpha
+	float StampAlphaLOD = 0.0f;
+	double StampAlphaTiling = 1.0;
+	TArray<FVector2f> ROIAlphaUVBuffer;
+	TArray<float> ROIAlphaBuffer;
+	FVector2d GetBrushAlphaUV(const FSculptBrushStamp& Stamp, const FVector3d& Position) const;
 	double SampleBrushAlpha(const FSculptBrushStamp& Stamp, const FVector3d& Position) const;
+	void UpdateStampAlpha(const FDynamicMesh3* Mesh);
 
 	TArray<FVector3d> ROIPositionBuffer;
 	TArray<FVector3d> ROIPrevPositionBuffer;
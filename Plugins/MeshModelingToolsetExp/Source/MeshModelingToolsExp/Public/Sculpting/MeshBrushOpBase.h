@@ -50,7 +50,15 @@ struct MESHMODELINGTOOLSEXP_API FSculptBrushStamp
 
 	// stamp alpha
 	TFunction<double(const FSculptBrushStamp& Stamp, const FVector3d& Position)> StampAlphaFunc;
-	bool HasAlpha() const { return !!StampAlphaFunc; }
+	// optional precomputed alpha for each vertex passed to the brush op, in the same order. Used instead of StampAlphaFunc if set.
+	TArrayView<const float> VertexAlphaValues;
+	bool HasAlpha() const { return !!StampAlphaFunc || VertexAlphaValues.Num() > 0; }
+
+	/** @return alpha for the k'th stamp vertex, located at Position */
+	double GetVertexAlpha(int32 k, const FVector3d& Position) const
+	{
+		return (VertexAlphaValues.Num() > 0) ? (double)VertexAlphaValues[k] : StampAlphaFunc(*this, Position);
+	}
 
 	FSculptBrushStamp()
 	{
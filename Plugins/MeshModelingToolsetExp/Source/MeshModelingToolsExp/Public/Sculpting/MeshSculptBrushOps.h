@@ -71,7 +71,7 @@ public:
 			}
 			else
 			{
-				double Alpha = (bHaveAlpha) ? Stamp.StampAlphaFunc(Stamp, OrigPos) : 1.0;
+				double Alpha = (bHaveAlpha) ? Stamp.GetVertexAlpha(k, OrigPos) : 1.0;
 
 				FVector3d MoveVec = UsePower * BaseNormal;
 				double Falloff = GetFalloff().Evaluate(Stamp, OrigPos) * Alpha;
@@ -156,7 +156,7 @@ public:
 			}
 			else
 			{
-				double Alpha = (bHaveAlpha) ? Stamp.StampAlphaFunc(Stamp, OrigPos) : 1.0;
+				double Alpha = (bHaveAlpha) ? Stamp.GetVertexAlpha(k, OrigPos) : 1.0;
 
 				FVector3d MoveVec = UsePower * StampNormal;
 				double Falloff = GetFalloff().Evaluate(Stamp, OrigPos) * Alpha;
@@ -249,7 +249,7 @@ public:
 			}
 			else
 			{
-				double Alpha = (bHaveAlpha) ? Stamp.StampAlphaFunc(Stamp, OrigPos) : 1.0;
+				double Alpha = (bHaveAlpha) ? Stamp.GetVertexAlpha(k, OrigPos) : 1.0;
 
 				FVector3d MoveVec = UsePower * BaseNormal;
 				double Falloff = GetFalloff().Evaluate(Stamp, OrigPos) * Alpha;
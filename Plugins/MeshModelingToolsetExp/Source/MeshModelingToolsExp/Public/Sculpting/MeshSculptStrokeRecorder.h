@@ -0,0 +1,216 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ToolContextInterfaces.h"
+#include "BoxTypes.h"
+#include "TransformTypes.h"
+
+#include <atomic>
+
+class UInteractiveTool;
+namespace UE { namespace Geometry { class FDynamicMesh3; } }
+
+
+namespace UE
+{
+namespace SculptUtil
+{
+	using namespace UE::Geometry;
+
+	enum class ESculptStrokeEventType : uint8
+	{
+		BeginDrag,
+		UpdateDrag,
+		EndDrag,
+		Tick
+	};
+
+	/**
+	 * One input event of a recorded stroke. Ray origins are stored relative to the local bounds of the sculpt target,
+	 * see FSculptStrokeRecording::ToNormalizedPosition(), so a recording can be replayed on a different mesh.
+	 */
+	struct FSculptStrokeEvent
+	{
+		ESculptStrokeEventType Type = ESculptStrokeEventType::Tick;
+		// seconds since the start of the stroke
+		double Time = 0;
+		// Tick events only
+		float DeltaTime = 0;
+		float Pressure = 1.0f;
+		// drag events only
+		FVector3d RayOrigin = FVector3d::Zero();
+		FVector3d RayDirection = FVector3d::UnitZ();
+	};
+
+	struct FSculptStroke
+	{
+		bool bShiftToggle = false;
+		bool bCtrlToggle = false;
+		// camera position is normalized like the ray origins
+		FViewCameraState CameraState;
+		// tool property values when the stroke began, as "PropertySetClass.PropertyName=ExportedValue"
+		TArray<FString> Properties;
+		TArray<FSculptStrokeEvent> Events;
+	};
+
+	/**
+	 * Input of a sequence of sculpt strokes, sufficient to replay them without a user and viewport,
+	 * eg to benchmark a sculpt tool (see Tests/MeshSculptStrokeReplay_Tests.inl).
+	 */
+	class MESHMODELINGTOOLSEXP_API FSculptStrokeRecording
+	{
+	public:
+		FString ToolClass;
+		TArray<FSculptStroke> Strokes;
+
+		bool SaveToFile(const FString& Path) const;
+		bool LoadFromFile(const FString& Path);
+
+		/** Map between world space and the normalized space of a recording, where the local bounds of the target are centered at the origin with unit size */
+		static FVector3d ToNormalizedPosition(const FVector3d& WorldPos, const FTransformSRT3d& TargetTransform, const FAxisAlignedBox3d& LocalBounds);
+		static FVector3d ToWorldPosition(const FVector3d& NormalizedPos, const FTransformSRT3d& TargetTransform, const FAxisAlignedBox3d& LocalBounds);
+		static FVector3d ToNormalizedDirection(const FVector3d& WorldDir, const FTransformSRT3d& TargetTransform);
+		static FVector3d ToWorldDirection(const FVector3d& NormalizedDir, const FTransformSRT3d& TargetTransform);
+
+		/** Export the editable properties of each of the PropertySets as text */
+		static void CaptureProperties(const TArray<UObject*>& PropertySets, TArray<FString>& PropertiesOut);
+		/** Import property values captured by CaptureProperties() into the matching PropertySets of Tool, and notify the Tool. Returns the number of values applied. */
+		static int32 ApplyProperties(const TArray<FString>& Properties, UInteractiveTool* Tool);
+	};
+
+
+	/**
+	 * Records sculpt tool input into a FSculptStrokeRecording when modeling.Sculpting.RecordStrokes is enabled, and supplies
+	 * the recorded pressure and camera to a tool while a recording is replayed into it. Tools own one of these, and forward
+	 * their input and ticks to it.
+	 */
+	class MESHMODELINGTOOLSEXP_API FSculptStrokeRecorder
+	{
+	public:
+		/** Start recording for Tool if recording is enabled. The recording is saved by EndRecording() */
+		void BeginRecording(const UInteractiveTool* Tool, const FTransformSRT3d& TargetTransform, const FAxisAlignedBox3d& LocalBounds);
+		/** Save the recording into the Saved/Sculpting directory, if any strokes were recorded */
+		void EndRecording();
+		bool IsRecording() const { return bRecording; }
+
+		void RecordBeginDrag(const FRay& WorldRay, const UInteractiveTool* Tool, const FViewCameraState& CameraState, bool bShiftToggle, bool bCtrlToggle);
+		void RecordUpdateDrag(const FRay& WorldRay);
+		void RecordEndDrag(const FRay& WorldRay);
+		void RecordTick(float DeltaTime, float Pressure);
+
+		/**
+		 * While replaying, tools should avoid work whose result depends on timing (eg frame pacing, or using an async
+		 * result only once it happens to be ready) so that replaying the same input always produces the same mesh.
+		 */
+		void BeginReplay() { bReplaying = true; }
+		void EndReplay() { bReplaying = false; }
+		bool IsReplaying() const { return bReplaying; }
+		void SetReplayInput(float Pressure, const FViewCameraState& CameraState);
+
+		/** @return the replayed pressure while replaying, otherwise DevicePressure */
+		float GetPressure(float DevicePressure) const { return bReplaying ? ReplayPressure : DevicePressure; }
+		/** Overwrite CameraStateInOut with the replayed camera while replaying */
+		void GetReplayCameraState(FViewCameraState& CameraStateInOut) const
+		{
+			if (bReplaying)
+			{
+				CameraStateInOut = ReplayCameraState;
+			}
+		}
+
+	protected:
+		bool bRecording = false;
+		bool bInStroke = false;
+		double StrokeStartTime = 0;
+		FTransformSRT3d TargetTransform;
+		FAxisAlignedBox3d LocalBounds;
+		FSculptStrokeRecording Recording;
+
+		bool bReplaying = false;
+		float ReplayPressure = 1.0f;
+		FViewCameraState ReplayCameraState;
+
+		void AddDragEvent(ESculptStrokeEventType Type, const FRay& WorldRay);
+	};
+
+
+
+	enum class ESculptStampStage : uint8
+	{
+		UpdateROI,
+		ApplyStamp,
+		Remesh,
+		OctreeReinsert,
+		Normals,
+		RenderUpdate,
+
+		Num
+	};
+
+	/**
+	 * Time spent in each stage of each sculpt stamp, collected only while an instance is set active. A stamp row is
+	 * open until EndStamp(), so work that a tool finishes on the next tick is still attributed to the stamp that
+	 * launched it. Stages that run on background tasks are summed, so they measure worker time, not wall time.
+	 */
+	class MESHMODELINGTOOLSEXP_API FSculptStampTimings
+	{
+	public:
+		FSculptStampTimings();
+
+		static FSculptStampTimings* GetActive() { return ActiveTimings; }
+		static void SetActive(FSculptStampTimings* Timings) { ActiveTimings = Timings; }
+
+		/** Add time to the open stamp row. Can be called from any thread. */
+		void AddStageTime(ESculptStampStage Stage, uint64 Cycles);
+		/** Close the open stamp row, if any stage time was added to it. Call on the game thread, with no stage work running. */
+		void EndStamp();
+
+		int32 GetNumStamps() const { return StampMs.Num(); }
+		double GetTotalMs(ESculptStampStage Stage) const;
+
+		static FString GetCSVHeader();
+		/** Append one CSV line per stamp, with Label in the first column */
+		void AppendCSV(const FString& Label, FString& CSVOut) const;
+
+	protected:
+		static FSculptStampTimings* ActiveTimings;
+
+		std::atomic<uint64> OpenStampCycles[(int32)ESculptStampStage::Num];
+		TArray<TStaticArray<double, (int32)ESculptStampStage::Num>> StampMs;
+	};
+
+	/** Add the time spent in this scope to a stage of the active FSculptStampTimings, if there is one */
+	class FScopedSculptStampTimer
+	{
+	public:
+		explicit FScopedSculptStampTimer(ESculptStampStage StageIn)
+			: Timings(FSculptStampTimings::GetActive()), Stage(StageIn)
+		{
+			if (Timings != nullptr)
+			{
+				StartCycles = FPlatformTime::Cycles64();
+			}
+		}
+
+		~FScopedSculptStampTimer()
+		{
+			if (Timings != nullptr)
+			{
+				Timings->AddStageTime(Stage, FPlatformTime::Cycles64() - StartCycles);
+			}
+		}
+
+	protected:
+		FSculptStampTimings* Timings;
+		ESculptStampStage Stage;
+		uint64 StartCycles = 0;
+	};
+
+
+	/** Hash of the vertex positions and triangles of Mesh, to detect if a replayed edit changed its result */
+	MESHMODELINGTOOLSEXP_API uint64 ComputeSculptMeshHash(const FDynamicMesh3& Mesh);
+
+}
+}
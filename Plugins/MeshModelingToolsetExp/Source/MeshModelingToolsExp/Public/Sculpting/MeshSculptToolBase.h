@@ -6,6 +6,7 @@
 #include "BaseTools/MeshSurfacePointTool.h"
 #include "BaseTools/BaseBrushTool.h"
 #include "Sculpting/MeshBrushOpBase.h"
+#include "Sculpting/MeshSculptStrokeRecorder.h"
 #include "BoxTypes.h"
 #include "Properties/MeshMaterialProperties.h"
 #include "Changes/ValueWatcher.h"
@@ -253,6 +254,9 @@ public:
 	virtual void OnEndDrag(const FRay& Ray) override;
 	// end UMeshSurfacePointTool API
 
+	/** Records stroke input, and supplies replayed input, see FSculptStrokeRecorder */
+	UE::SculptUtil::FSculptStrokeRecorder& GetStrokeRecorder() { return StrokeRecorder; }
+
 protected:
 	virtual void OnTick(float DeltaTime) override;
 
@@ -275,6 +279,8 @@ protected:
 	UWorld* TargetWorld;		// required to spawn UPreviewMesh/etc
 	FViewCameraState CameraState;
 
+	UE::SculptUtil::FSculptStrokeRecorder StrokeRecorder;
+
 	/** Initial transformation on target mesh */
 	UE::Geometry::FTransformSRT3d InitialTargetTransform;
 	/** Active transformation on target mesh, includes baked scale */
@@ -486,6 +492,17 @@ protected:
 	virtual bool IsStampPending() const { return bIsStampPending; }
 	virtual const FRay& GetPendingStampRayWorld() const { return PendingStampRay;  }
 
+	// Stroke resampling. For tools that opt in, the stroke input path is resampled into PendingStrokeSampleRays at
+	// GetStrokeSampleSpacing(), so fast strokes place stamps along the whole path and not only at the latest input ray.
+	// The tool is responsible for consuming the rays.
+	TArray<FRay> PendingStrokeSampleRays;
+	FRay LastStrokeInputRay;
+	virtual bool WantsStrokeResampling() const { return false; }
+	// apply the stroke samples the tool has not consumed yet, called at the end of a stroke before OnEndStroke()
+	virtual void FlushStrokeStamps() {}
+	virtual double GetStrokeSampleSpacing();
+	virtual void AddStrokeInputRay(const FRay& WorldRay);
+
 
 	//
 	// Stamp ROI Plane is a plane used by some brush ops
@@ -7,6 +7,11 @@
 #include "DynamicMesh/DynamicMeshOctree3.h"
 #include "DynamicMesh/MeshNormals.h"
 #include "Util/UniqueIndexSet.h"
+#include "Image/ImageBuilder.h"
+
+#include <atomic>
+
+class FMeshVertexChange;
 
 
 namespace UE 
@@ -15,6 +20,149 @@ namespace SculptUtil
 {
 	using namespace UE::Geometry;
 
+	/**
+	 * Bit flags over a mesh index space (vertex IDs, triangle IDs, etc) that can be set concurrently from multiple threads.
+	 * Intended to deduplicate indices during parallel ROI collection. Only the words containing indices that were set need to
+	 * be cleared again (see ClearIndices), so the flags can be kept across stamps without paying for a full-size clear.
+	 */
+	class FAtomicIndexFlags
+	{
+	public:
+		/** Grow the flags to cover [0, MaxIndex). Existing flags are preserved, new flags are cleared. */
+		void Grow(int32 MaxIndex)
+		{
+			int32 NumWords = (MaxIndex + 31) / 32;
+			int32 OldNumWords = Words.Num();
+			if (NumWords > OldNumWords)
+			{
+				Words.SetNum(NumWords);
+				for (int32 k = OldNumWords; k < NumWords; ++k)
+				{
+					Words[k].store(0, std::memory_order_relaxed);
+				}
+			}
+		}
+
+		/** Set the flag for Index. @return true if the flag was not set before, ie this call is the first to add Index */
+		bool TestAndSet(int32 Index)
+		{
+			const uint32 Mask = 1u << (Index & 31);
+			return (Words[Index >> 5].fetch_or(Mask, std::memory_order_relaxed) & Mask) == 0;
+		}
+
+		bool Contains(int32 Index) const
+		{
+			return (Words[Index >> 5].load(std::memory_order_relaxed) & (1u << (Index & 31))) != 0;
+		}
+
+		/** Clear the flags of the given Indices, which must be the full set of indices that were set (whole words are cleared) */
+		void ClearIndices(const TArray<int32>& Indices);
+
+	protected:
+		TArray<std::atomic<uint32>> Words;
+	};
+
+	/**
+	 * Set of indices stored as a dense bit array plus the list of non-zero words, for accumulating large regions
+	 * (eg all triangles modified during a stroke). Adding an index is a word OR, and both Reset() and GetIndices()
+	 * only visit the dirty words, so cost is proportional to the accumulated region rather than the index space.
+	 * Not thread-safe, each instance should only be modified from one thread at a time.
+	 */
+	class FDirtyIndexSet
+	{
+	public:
+		/** Grow the set to allow indices in [0, MaxIndex) */
+		void Grow(int32 MaxIndex)
+		{
+			int32 NumWords = (MaxIndex + 31) / 32;
+			if (NumWords > Words.Num())
+			{
+				Words.SetNumZeroed(NumWords);
+			}
+		}
+
+		void Add(int32 Index)
+		{
+			checkSlow((Index >> 5) < Words.Num());
+			uint32& Word = Words[Index >> 5];
+			if (Word == 0)
+			{
+				DirtyWords.Add(Index >> 5);
+			}
+			Word |= 1u << (Index & 31);
+		}
+
+		void Add(const TArray<int32>& Indices)
+		{
+			for (int32 Index : Indices)
+			{
+				Add(Index);
+			}
+		}
+
+		bool Contains(int32 Index) const
+		{
+			return (Index >> 5) < Words.Num() && (Words[Index >> 5] & (1u << (Index & 31))) != 0;
+		}
+
+		bool IsEmpty() const
+		{
+			return DirtyWords.Num() == 0;
+		}
+
+		/** Remove all indices. Only the dirty words are cleared. */
+		void Reset();
+
+		/** Collect all indices in the set into IndicesOut, in parallel over the dirty words. Indices are ascending within each word, words are in the order they became dirty. */
+		void GetIndices(TArray<int32>& IndicesOut) const;
+
+	protected:
+		TArray<uint32> Words;
+		TArray<int32> DirtyWords;
+	};
+
+	/**
+	 * Find the vertex ROI and triangle ROI of a batch of spherical brush stamps, in parallel.
+	 * VertexROIOut is the set of vertices of CandidateTriangles that are inside any of the brush spheres, and TriangleROIOut is the
+	 * set of all triangles in the one-rings of those vertices. Both are sorted, so the output does not depend on scheduling.
+	 * VertexFlags and TriangleFlags are used for deduplication, they are grown as necessary and returned cleared.
+	 * CandidateTriangles may contain duplicates.
+	 */
+	void CollectBrushROIParallel(
+		const FDynamicMesh3* Mesh,
+		const TArray<int32>& CandidateTriangles,
+		TArrayView<const FVector3d> BrushPositions, double BrushRadius,
+		FAtomicIndexFlags& VertexFlags, FAtomicIndexFlags& TriangleFlags,
+		TArray<int32>& VertexROIOut, TArray<int32>& TriangleROIOut);
+
+	/** Single-stamp version of CollectBrushROIParallel */
+	inline void CollectBrushROIParallel(
+		const FDynamicMesh3* Mesh,
+		const TArray<int32>& CandidateTriangles,
+		const FVector3d& BrushPos, double BrushRadius,
+		FAtomicIndexFlags& VertexFlags, FAtomicIndexFlags& TriangleFlags,
+		TArray<int32>& VertexROIOut, TArray<int32>& TriangleROIOut)
+	{
+		CollectBrushROIParallel(Mesh, CandidateTriangles, MakeArrayView(&BrushPos, 1), BrushRadius,
+			VertexFlags, TriangleFlags, VertexROIOut, TriangleROIOut);
+	}
+
+
+	/** @return spacing between stroke samples for strokes without an explicit stamp spacing, based on the modeling.Sculpting.StrokeSampleSpacing CVar */
+	double GetContinuousStrokeSampleSpacing(double BrushRadius);
+
+	/** @return maximum number of consecutive stroke stamps that are combined into one batch, from the modeling.Sculpting.MaxStampsPerBatch CVar */
+	int32 GetMaxStampsPerBatch();
+
+	/**
+	 * Resample the stroke input segment from StartRay to EndRay, so that fast strokes do not skip over the surface.
+	 * Rays are interpolated such that the points at BrushDepth along consecutive rays are at most SampleSpacing apart.
+	 * The rays are appended to RaysOut. StartRay is not emitted, EndRay is always emitted last.
+	 * At most MaxSamples rays are emitted, longer segments are spread evenly over them.
+	 */
+	void ResampleStrokeRays(const FRay& StartRay, const FRay& EndRay, double BrushDepth, double SampleSpacing, int32 MaxSamples, TArray<FRay>& RaysOut);
+
+
 	/** 
 	 * Recompute overlay normals for the overlay elements belonging to all the ModifiedTris. 
 	 * ElementSetBuffer and NormalsBuffer will be populated with all the normal overlay element IDs (you provide to allow for re-use of allocated memory)
@@ -86,4 +234,133 @@ namespace SculptUtil
 
 
 
+
+	/**
+	 * Cached adjacency from the normals of a mesh to the triangles that contribute to them. The normals are either the
+	 * elements of the primary normals overlay, or the mesh vertices if there is no overlay. Stored in CSR form
+	 * (per-index offsets into one packed triangle array) and only rebuilt when the mesh topology changes. The other
+	 * direction (triangle to normals) is just the overlay/mesh triangle array, so it is not duplicated here.
+	 *
+	 * Used to find the exact normals ROI of a triangle ROI without clearing full-size flag arrays, and to recompute
+	 * overlay normals without searching the parent vertex one-ring of each element for the triangles that use it.
+	 */
+	class FNormalsROICache
+	{
+	public:
+		/** Rebuild the cache if the topology of Mesh or its normals overlay has changed since the last build */
+		void UpdateForMesh(const FDynamicMesh3* Mesh, bool bForceVertex = false);
+
+		/** @return true if cached indices are overlay element IDs, false if they are vertex IDs */
+		bool IsOverlayElements() const { return bOverlayElements; }
+
+		/** Find the unique set of overlay elements (or vertices) used by the triangles in TriangleROI, in parallel */
+		void GatherNormalsROI(const FDynamicMesh3* Mesh, const TArray<int32>& TriangleROI, TArray<int32>& IndicesOut);
+
+		/** Recompute the normals of Indices, as returned by GatherNormalsROI */
+		void RecalculateNormals(FDynamicMesh3* Mesh, const TArray<int32>& Indices) const;
+
+	protected:
+		const FDynamicMesh3* CachedMesh = nullptr;
+		uint32 CachedTopologyStamp = 0;
+		int32 CachedMaxTriangleID = -1;
+		int32 CachedMaxIndex = -1;
+		bool bOverlayElements = false;
+
+		TArray<int32> IndexTriOffsets;		// triangles of index i are IndexTris[IndexTriOffsets[i]...IndexTriOffsets[i+1]-1]
+		TArray<int32> IndexTris;
+
+		FAtomicIndexFlags ROIFlags;
+	};
+
+
+
+	/**
+	 * Compact undo record of vertex positions, for edits whose topology changes are recorded by a FDynamicMeshChangeTracker.
+	 * The change tracker can only save vertices as part of saved triangles. Saving every triangle around every moved vertex
+	 * is expensive when most vertices only move. Instead, this store saves the initial position of each vertex the first time
+	 * SaveVertices() sees it. The change tracker then only has to save the triangles that are actually modified.
+	 *
+	 * Vertices must be saved before they are moved or removed. At the end, vertices that existed when recording began are
+	 * reverted to their initial positions, and vertices that exist at the end are applied with their final positions.
+	 * Both are expected to run after the topology change has been reverted or applied.
+	 */
+	class MESHMODELINGTOOLSEXP_API FVertexPositionDeltaStore
+	{
+	public:
+		/** Start recording edits to Mesh, discarding any previous record */
+		void Begin(const FDynamicMesh3* Mesh);
+
+		/** Save the current position of each of the Vertices that has not been saved yet */
+		void SaveVertices(const FDynamicMesh3* Mesh, TArrayView<const int32> Vertices);
+		/** Save the current position of each vertex of the Triangles that has not been saved yet */
+		void SaveTriangleVertices(const FDynamicMesh3* Mesh, const TSet<int32>& Triangles);
+
+		/** Build the position changes that revert and apply the recorded edit, based on the current state of Mesh */
+		void End(const FDynamicMesh3* Mesh, FMeshVertexChange& RevertChangeOut, FMeshVertexChange& ApplyChangeOut) const;
+
+		int32 GetNumSavedVertices() const { return SavedVertices.Num(); }
+
+	protected:
+		int32 InitialMaxVertexID = 0;
+		// only initialized if the mesh had free vertex IDs when recording began, otherwise every ID below InitialMaxVertexID was a vertex
+		bool bInitialVerticesCompact = true;
+		TBitArray<> InitialVertices;
+
+		FDirtyIndexSet SavedFlags;
+		TArray<int32> SavedVertices;
+		TArray<FVector3d> InitialPositions;
+
+		bool IsInitialVertex(int32 VertexID) const
+		{
+			return VertexID < InitialMaxVertexID && (bInitialVerticesCompact || InitialVertices[VertexID]);
+		}
+		void SaveVertex(const FDynamicMesh3* Mesh, int32 VertexID);
+	};
+
+
+
+	/**
+	 * Single-channel mip chain for a brush alpha mask. Level 0 holds the red channel of the source image and each
+	 * following level is a 2x2 box-filtered half-size copy, down to 1x1. Sampling picks a fractional LOD so that
+	 * brush stamps that are small relative to the alpha resolution do not alias.
+	 *
+	 * UVs are in the [0,1] square covering the stamp. Outside that range samples are 0, unless wrapping is enabled, in which case the alpha tiles.
+	 */
+	class MESHMODELINGTOOLSEXP_API FBrushAlphaMips
+	{
+	public:
+		/** Build the mip chain from the red channel of Image */
+		void Initialize(const TImageBuilder<FVector4f>& Image);
+
+		void Reset() { Levels.Reset(); }
+		bool IsEmpty() const { return Levels.Num() == 0; }
+		int32 GetNumLevels() const { return Levels.Num(); }
+
+		/**
+		 * @return LOD at which samples taken SampleSpacingUV apart (in UV units) are roughly one texel apart,
+		 *   clamped to the available levels
+		 */
+		float ComputeLOD(double SampleSpacingUV) const;
+
+		/** Trilinear sample at the given UV and LOD */
+		float Sample(float U, float V, float LOD, bool bWrap) const;
+
+		/** Trilinear sample at each UV, writes one value per UV to ValuesOut. Samples are blended four at a time using vector registers. */
+		void SampleBatch(TArrayView<const FVector2f> UVs, float LOD, bool bWrap, TArrayView<float> ValuesOut) const;
+
+	protected:
+		struct FLevel
+		{
+			int32 Width = 0;
+			int32 Height = 0;
+			TArray<float> Values;
+		};
+		TArray<FLevel> Levels;
+
+		// texel indices and weights for a bilinear sample at (U,V). Returns false if the sample is outside the alpha (and not wrapping)
+		static bool GetBilinearCorners(const FLevel& Level, float U, float V, bool bWrap, int32 IndicesOut[4], float& FracXOut, float& FracYOut);
+		static float SampleBilinear(const FLevel& Level, float U, float V, bool bWrap);
+	};
+
+
 /* end namespace UE::SculptUtil */  } }
\ No newline at end of file
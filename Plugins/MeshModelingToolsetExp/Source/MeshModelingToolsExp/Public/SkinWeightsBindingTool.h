@@ -4,11 +4,13 @@
 
 #include "CoreMinimal.h"
 
+#include "Async/Future.h"
 #include "BoneContainer.h"
 #include "InteractiveToolBuilder.h"
 #include "ModelingOperators.h"
 #include "BaseTools/MultiSelectionMeshEditingTool.h"
 #include "Interfaces/Interface_BoneReferenceSkeletonProvider.h"
+#include "SkinWeightsUtil.h"
 
 #include "SkinWeightsBindingTool.generated.h"
 
@@ -110,8 +112,17 @@ public:
 	TObjectPtr<UMeshOpPreviewWithBackgroundCompute> Preview = nullptr;
 
 protected:
-	TSharedPtr<FOccupancyGrid> Occupancy;
-	
+	using FOccupancyGridPtr = TSharedPtr<const FOccupancyGrid, ESPMode::ThreadSafe>;
+
+	// Occupancy grid of OriginalMesh for the geodesic voxel binding. It only depends on the mesh and the voxel
+	// resolution, so it is built once in the background for each of those and shared read-only with the operators.
+	TSharedFuture<FOccupancyGridPtr> Occupancy;
+	uint64 OccupancyMeshChangeStamp = 0;
+	int32 OccupancyVoxelResolution = 0;
+
+	/** @return the occupancy grid for the current mesh and VoxelResolution, starting a build if it is not cached */
+	TSharedFuture<FOccupancyGridPtr> GetOccupancyGrid();
+
 	TSharedPtr<UE::Geometry::FDynamicMesh3, ESPMode::ThreadSafe> OriginalMesh;
 	
 	FBoneContainer BoneContainer;
@@ -120,6 +131,14 @@ protected:
 
 	void GenerateAsset(const FDynamicMeshOpResult& Result);
 
-	static FVector4f WeightToColor(float Value);
+	// The vertices each bone of the preview result influences, with their weights, in CSR form: the vertices of bone B are
+	// BoneVertexWeights[BoneVertexOffsets[B] .. BoneVertexOffsets[B+1]-1]
+	TArray<int32> BoneVertexOffsets;
+	TArray<TPair<int32, float>> BoneVertexWeights;
+	UE::SkinWeightsUtil::FVertexColorElements VertexColorElements;
+	// The bone that the vertex colors show, if they are up to date for any bone
+	int32 VisualizedBoneIndex = INDEX_NONE;
+
+	void UpdateBoneVertexWeights();
 	void UpdateVisualization(bool bInForce = false);
 };
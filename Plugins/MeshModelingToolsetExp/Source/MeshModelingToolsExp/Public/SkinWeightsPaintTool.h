@@ -8,7 +8,9 @@
 #include "MeshDescription.h"
 #include "DynamicMesh/DynamicVerticesOctree3.h"
 #include "BoneContainer.h"
+#include "BoneWeights.h"
 #include "Interfaces/Interface_BoneReferenceSkeletonProvider.h"
+#include "SkinWeightsUtil.h"
 #include "Misc/Optional.h"
 #include "Containers/Map.h"
 #include "TargetInterfaces/MeshDescriptionCommitter.h"
@@ -22,13 +24,66 @@ class IMeshDescriptionCommitter;
 
 
 
+/**
+ * Bone weights of each vertex of a mesh, stored as at most MaxInfluences (bone, weight) pairs per vertex rather than
+ * a weight for every bone, with an index from each bone to the vertices it influences.
+ */
+class MESHMODELINGTOOLSEXP_API FSkinWeightsVertexInfluences
+{
+public:
+	static constexpr int32 MaxInfluences = UE::AnimationCore::MaxInlineBoneWeightCount;
+
+	struct FInfluence
+	{
+		FBoneIndexType BoneIndex;
+		float Weight;
+	};
+	using FVertexInfluences = TArray<FInfluence, TFixedAllocator<MaxInfluences>>;
+
+	void Initialize(int32 NumVertices, int32 NumBones);
+
+	int32 GetNumVertices() const { return NumInfluences.Num(); }
+	int32 GetNumBones() const { return BoneVertices.Num(); }
+
+	TArrayView<const FInfluence> GetInfluences(int32 VertexIndex) const
+	{
+		return TArrayView<const FInfluence>(&Influences[VertexIndex * MaxInfluences], NumInfluences[VertexIndex]);
+	}
+
+	/** @return the weight of BoneIndex on a vertex, zero if the bone does not influence it */
+	float GetWeight(int32 VertexIndex, FBoneIndexType BoneIndex) const;
+
+	/**
+	 * Set the weight of BoneIndex on a vertex. If the vertex is already influenced by MaxInfluences bones, the bone
+	 * replaces the one with the lowest weight, if that is lower than Weight. Edits that must be undoable should build
+	 * the full influences of the vertex and use SetInfluences instead, since this may change more than one bone.
+	 * @return false if the weight was dropped, in which case the vertex is unchanged
+	 */
+	bool SetWeight(int32 VertexIndex, FBoneIndexType BoneIndex, float Weight);
+
+	/** Replace all the bone weights of a vertex */
+	void SetInfluences(int32 VertexIndex, TArrayView<const FInfluence> NewInfluences);
+
+	/** @return the vertices influenced by BoneIndex, each once. This may include vertices where its weight was set to zero. */
+	const TArray<int32>& GetBoneVertices(FBoneIndexType BoneIndex) const { return BoneVertices[BoneIndex]; }
+
+private:
+	/** Swap-remove the entry at Position from the vertex list of BoneIndex, and fix up the position of the vertex moved into it */
+	void RemoveBoneVertex(FBoneIndexType BoneIndex, int32 Position);
+
+	// MaxInfluences entries per vertex, of which the first NumInfluences are used
+	TArray<FInfluence> Influences;
+	TArray<uint8> NumInfluences;
+	TArray<TArray<int32>> BoneVertices;
+	// for each entry of Influences, the position of the vertex in the BoneVertices list of that bone, so the vertex can be removed in O(1)
+	TArray<int32> BoneVertexPositions;
+};
+
+
 class MESHMODELINGTOOLSEXP_API FMeshSkinWeightsChange : public FToolCommandChange
 {
 public:
-	FMeshSkinWeightsChange(const FName& InBoneName) :
-		FToolCommandChange(),
-		BoneName(InBoneName)
-	{ }
+	using FVertexInfluences = FSkinWeightsVertexInfluences::FVertexInfluences;
 
 	virtual FString ToString() const override
 	{
@@ -39,12 +94,12 @@ public:
 
 	void Revert(UObject* Object) override;
 
-	void UpdateValues(const TArray<int32>& Indices, const TArray<float>& OldValues, const TArray<float>& NewValues);
+	void UpdateValues(const TArray<int32>& Indices, const TArray<FVertexInfluences>& OldValues, const TArray<FVertexInfluences>& NewValues);
 
 private:
-	FName BoneName;
-	TMap<int32, float> OldWeights;
-	TMap<int32, float> NewWeights;
+	// All the bone weights of each changed vertex, since painting one bone redistributes the weights of the others
+	TMap<int32, FVertexInfluences> OldWeights;
+	TMap<int32, FVertexInfluences> NewWeights;
 };
 
 
@@ -71,6 +126,10 @@ public:
 	UPROPERTY(VisibleAnywhere, Category = Skeleton)
 	FBoneReference CurrentBone;
 
+	/** Bones whose weights are kept when painting another bone redistributes the weights of a vertex */
+	UPROPERTY(EditAnywhere, Category = Skeleton)
+	TArray<FBoneReference> LockedBones;
+
 	// IBoneReferenceSkeletonProvider
 	USkeleton* GetSkeleton(bool& bInvalidSkeletonIsError, const IPropertyHandle* PropertyHandle) override;
 
@@ -131,16 +190,19 @@ protected:
 	UE::Geometry::TDynamicVerticesOctree3<FDynamicMesh3> VerticesOctree;
 	TArray<int> PreviewBrushROI;
 
-	using BoneInfluenceMapType = TMap<FName, TArray<float>>;
-	BoneInfluenceMapType SkinWeightsMap;
+	UE::SkinWeightsUtil::FVertexColorElements VertexColorElements;
+	void UpdateVertexColors(const TArray<int32>& VertexIds);
+
+	FSkinWeightsVertexInfluences SkinWeights;
 	FName CurrentBone = NAME_None;
+	int32 CurrentBoneIndex = INDEX_NONE;
 	TOptional<FName> PendingCurrentBone;
 
 
 	bool bVisibleWeightsValid = false;
+	// The bone that the vertex colors show, if they are up to date for any bone
+	int32 VisualizedBoneIndex = INDEX_NONE;
 
-	static FVector4f WeightToColor(float Value);
-	
 	void InitializeSkinWeights();
 	void UpdateBoneVisualization();
 	void UpdateCurrentBone(const FName &BoneName);
@@ -165,7 +227,7 @@ protected:
 	TUniquePtr<FMeshSkinWeightsChange> EndChange();
 
 	friend class FMeshSkinWeightsChange;
-	void ExternalUpdateValues(const FName &BoneName, const TMap<int32, float>& IndexValues);
+	void ExternalUpdateValues(const TMap<int32, FSkinWeightsVertexInfluences::FVertexInfluences>& IndexValues);
 
 	void UpdateEditedSkinWeightsMesh();
 };
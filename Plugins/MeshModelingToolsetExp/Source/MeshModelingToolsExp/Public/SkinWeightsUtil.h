@@ -0,0 +1,46 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DynamicMesh/DynamicMesh3.h"
+#include "DynamicMesh/DynamicMeshAttributeSet.h"
+
+
+namespace UE
+{
+namespace SkinWeightsUtil
+{
+	using namespace UE::Geometry;
+
+	/**
+	 * Color of a skin weight, a close approximation of the skeletal mesh editor's bone weight ramp. The ramp is
+	 * tabulated at 256 weights, the precision of skeletal mesh weights, so coloring a mesh needs no HSV conversions.
+	 */
+	MESHMODELINGTOOLSEXP_API const FVector4f& WeightToColor(float Weight);
+
+	/**
+	 * The elements of a color overlay that belong to each vertex, in CSR form. Vertices own disjoint sets of elements,
+	 * so the colors of a set of distinct vertices can be written from parallel tasks with SetColor().
+	 */
+	class MESHMODELINGTOOLSEXP_API FVertexColorElements
+	{
+	public:
+		void Initialize(const FDynamicMesh3& Mesh, const FDynamicMeshColorOverlay& ColorOverlay);
+
+		void SetColor(FDynamicMeshColorOverlay& ColorOverlay, int32 VertexID, const FVector4f& Color) const
+		{
+			for (int32 Offset = Offsets[VertexID]; Offset < Offsets[VertexID + 1]; ++Offset)
+			{
+				ColorOverlay.SetElement(Elements[Offset], Color);
+			}
+		}
+
+	protected:
+		// the elements of vertex V are Elements[Offsets[V] .. Offsets[V+1]-1]
+		TArray<int32> Offsets;
+		TArray<int32> Elements;
+	};
+
+}
+}